@@ -104,6 +104,9 @@ namespace FANN {
 		    The quickprop training algorithm is described by [Fahlman, 1988].
 		FANN_TRAIN_SARPROP - THE SARPROP ALGORITHM: A SIMULATED ANNEALING ENHANCEMENT TO RESILIENT BACK PROPAGATION
             http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.47.8197&rep=rep1&type=pdf
+	    TRAIN_MINIBATCH - Stochastic gradient descent where the weights are updated after every
+		    <neural_net::get_minibatch_size> patterns, optionally visited in a new random order every
+		    epoch. Uses the learning_rate and learning_momentum.
 
 
 	    See also:
@@ -114,7 +117,8 @@ namespace FANN {
         TRAIN_BATCH,
         TRAIN_RPROP,
         TRAIN_QUICKPROP,
-        TRAIN_SARPROP
+        TRAIN_SARPROP,
+        TRAIN_MINIBATCH
     };
 
     /* Enum: activation_function_enum
@@ -92,6 +92,9 @@ void fann_update_weights_irpropm(struct fann *ann, unsigned int first_weight,
 								 unsigned int past_end);
 void fann_update_weights_sarprop(struct fann *ann, unsigned int epoch, unsigned int first_weight,
 								unsigned int past_end);
+void fann_update_weights_minibatch(struct fann *ann, unsigned int num_data, unsigned int first_weight,
+								   unsigned int past_end);
+fann_type fann_update_MSE(struct fann *ann, struct fann_neuron* neuron, fann_type neuron_diff);
 
 void fann_clear_train_arrays(struct fann *ann);
 
@@ -121,6 +124,24 @@ void fann_set_shortcut_connections(struct fann *ann);
 
 int fann_allocate_scale(struct fann *ann);
 
+#ifndef FIXEDFANN
+fann_type *fann_run_simd(struct fann *ann);
+int fann_sigmoid_symmetric_simd(fann_type *values, unsigned int num_values);
+void fann_gemm_nn(unsigned int M, unsigned int N, unsigned int K, const fann_type *A, unsigned int lda,
+				  const fann_type *B, unsigned int ldb, fann_type *C, unsigned int ldc);
+void fann_gemm_tn(unsigned int M, unsigned int N, unsigned int K, const fann_type *A, unsigned int lda,
+				  const fann_type *B, unsigned int ldb, fann_type *C, unsigned int ldc);
+
+void fann_matrix_slopes(struct fann *ann, struct fann_train_data *data, const unsigned int *order,
+						unsigned int first, unsigned int num_data);
+int fann_matrix_test(struct fann *ann, struct fann_train_data *data);
+unsigned int *fann_minibatch_order(struct fann *ann, unsigned int num_data);
+float fann_train_epoch_minibatch(struct fann *ann, struct fann_train_data *data);
+
+void fann_unmap_binary(struct fann *ann);
+int fann_detach_binary(struct fann *ann);
+#endif
+
 FANN_EXTERNAL void FANN_API fann_scale_data_to_range(fann_type ** data, unsigned int num_data, unsigned int num_elem,
 					 fann_type old_min, fann_type old_max, fann_type new_min, fann_type new_max);
 
@@ -96,5 +96,45 @@ FANN_EXTERNAL int FANN_API fann_save(struct fann *ann, const char *configuration
    This function appears in FANN >= 1.0.0.
 */ 
 FANN_EXTERNAL int FANN_API fann_save_to_fixed(struct fann *ann, const char *configuration_file);
+
+#ifndef FIXEDFANN
+/* Function: fann_save_binary
+
+   Saves the entire network to a binary file, which <fann_create_from_binary> maps
+   into memory instead of parsing it.
+
+   The file holds the same information as <fann_save>, stored the way it is in memory:
+   a versioned header, then the layer sizes, the neurons, the connections and the weights
+   as raw arrays, each aligned to 64 bytes. It can only be read on a platform with the
+   same byte order and the same fann_type, use <fann_save> to move networks between platforms.
+
+   Return:
+   The function returns 0 on success and -1 on failure.
+
+   See also:
+    <fann_create_from_binary>, <fann_save>
+ */
+FANN_EXTERNAL int FANN_API fann_save_binary(struct fann *ann, const char *configuration_file);
+
+
+/* Function: fann_create_from_binary
+
+   Constructs a neural network from a file saved by <fann_save_binary>.
+
+   The file is mapped into memory and the network uses the weights where they lie in it,
+   so loading costs little more than building the neuron and connection arrays, and
+   pages of weights are only read when the network first touches them. The mapping is
+   copy-on-write: training the network changes its own copy of the pages, never the file.
+   The file must not be modified or replaced while a network created from it exists,
+   and it is unmapped by <fann_destroy>.
+
+   Returns NULL if the file can not be opened, or if it is not a binary network
+   saved with the same version, byte order and fann_type.
+
+   See also:
+    <fann_save_binary>, <fann_create_from_file>
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_create_from_binary(const char *configuration_file);
+#endif
 	
 #endif
@@ -0,0 +1,173 @@
+#include "ANNPopulation.h"
+
+#include "math.h"
+
+#include <cmath>
+#include <cassert>
+
+ANNPopulation::ANNPopulation(const ANNWrapper::ANNConfig& config, unsigned capacity) :
+	m_capacity(capacity),
+	m_numWeights(0)
+{
+	std::vector<unsigned> layerSizes = ANNWrapper::GetLayerSizes(config);
+
+	// same connection order as fann_create_standard_array: each neuron connects to
+	// every neuron of the previous layer followed by the previous layer's bias
+	unsigned numValues = 0;
+	for (size_t i = 0; i < layerSizes.size(); ++i)
+	{
+		Layer layer;
+		layer.m_numNeurons	= layerSizes[i];
+		layer.m_firstWeight	= m_numWeights;
+		layer.m_firstValue	= numValues;
+		m_layers.emplace_back(layer);
+
+		if (i > 0)
+		{
+			m_numWeights += (layerSizes[i - 1] + 1) * layerSizes[i];
+		}
+		numValues += layerSizes[i];
+	}
+
+	m_weights.resize(static_cast<size_t>(m_numWeights) * m_capacity, 0.f);
+	m_values.resize(static_cast<size_t>(numValues) * m_capacity, 0.f);
+}
+
+void ANNPopulation::SetWeights(unsigned agent, const std::vector<fann_type>& weights)
+{
+	assert(weights.size() == m_numWeights);
+	SetWeights(agent, weights.data());
+}
+
+void ANNPopulation::SetWeights(unsigned agent, const fann_type* weights)
+{
+	assert(agent < m_capacity);
+	for (unsigned i = 0; i < m_numWeights; ++i)
+	{
+		m_weights[static_cast<size_t>(i) * m_capacity + agent] = weights[i];
+	}
+}
+
+std::vector<fann_type> ANNPopulation::GetWeights(unsigned agent) const
+{
+	std::vector<fann_type> weights(m_numWeights);
+	GetWeights(agent, weights.data());
+	return weights;
+}
+
+void ANNPopulation::GetWeights(unsigned agent, fann_type* weights) const
+{
+	assert(agent < m_capacity);
+	for (unsigned i = 0; i < m_numWeights; ++i)
+	{
+		weights[i] = m_weights[static_cast<size_t>(i) * m_capacity + agent];
+	}
+}
+
+void ANNPopulation::CopyWeights(unsigned from, unsigned to)
+{
+	assert(from < m_capacity && to < m_capacity);
+	for (unsigned i = 0; i < m_numWeights; ++i)
+	{
+		fann_type* row = &m_weights[static_cast<size_t>(i) * m_capacity];
+		row[to] = row[from];
+	}
+}
+
+void ANNPopulation::SetInputs(unsigned agent, const fann_type* inputs)
+{
+	assert(agent < m_capacity);
+	for (unsigned i = 0; i < GetNumInputs(); ++i)
+	{
+		m_values[static_cast<size_t>(i) * m_capacity + agent] = inputs[i];
+	}
+}
+
+fann_type ANNPopulation::GetOutput(unsigned agent, unsigned output) const
+{
+	assert(agent < m_capacity && output < GetNumOutputs());
+	return m_values[static_cast<size_t>(m_layers.back().m_firstValue + output) * m_capacity + agent];
+}
+
+void ANNPopulation::Run(unsigned agentCount)
+{
+	assert(agentCount <= m_capacity);
+
+	for (size_t l = 1; l < m_layers.size(); ++l)
+	{
+		const Layer& prev = m_layers[l - 1];
+		const Layer& curr = m_layers[l];
+
+		const fann_type* prevValues	= &m_values[static_cast<size_t>(prev.m_firstValue) * m_capacity];
+		const fann_type* weights	= &m_weights[static_cast<size_t>(curr.m_firstWeight) * m_capacity];
+
+		for (unsigned n = 0; n < curr.m_numNeurons; ++n)
+		{
+			fann_type* sums = &m_values[static_cast<size_t>(curr.m_firstValue + n) * m_capacity];
+
+			// bias weight comes last for every neuron
+			const fann_type* bias = weights + static_cast<size_t>(prev.m_numNeurons) * m_capacity;
+			for (unsigned a = 0; a < agentCount; ++a)
+			{
+				sums[a] = bias[a];
+			}
+
+			for (unsigned i = 0; i < prev.m_numNeurons; ++i)
+			{
+				const fann_type* w = weights + static_cast<size_t>(i) * m_capacity;
+				const fann_type* v = prevValues + static_cast<size_t>(i) * m_capacity;
+				for (unsigned a = 0; a < agentCount; ++a)
+				{
+					sums[a] += w[a] * v[a];
+				}
+			}
+
+			RunActivation(sums, agentCount);
+			weights += static_cast<size_t>(prev.m_numNeurons + 1) * m_capacity;
+		}
+	}
+}
+
+void ANNPopulation::RunActivation(fann_type* values, unsigned agentCount) const
+{
+	// matches fann_run: scale by steepness, clamp, then activate
+	const fann_type steepness	= ANNWrapper::ACTIVATION_STEEPNESS;
+	const fann_type maxSum		= 150.f / steepness;
+
+	if (ANNWrapper::ACTIVATION_FUNCTION == FANN_SIGMOID_SYMMETRIC)
+	{
+		for (unsigned a = 0; a < agentCount; ++a)
+		{
+			fann_type sum = Clamp(values[a] * steepness, -maxSum, maxSum);
+			values[a] = 2.f / (1.f + expf(-2.f * sum)) - 1.f;
+		}
+	}
+	else
+	{
+		for (unsigned a = 0; a < agentCount; ++a)
+		{
+			fann_type sum = Clamp(values[a] * steepness, -maxSum, maxSum);
+			fann_activation_switch(ANNWrapper::ACTIVATION_FUNCTION, sum, values[a]);
+		}
+	}
+}
+
+unsigned ANNPopulation::GetCapacity() const
+{
+	return m_capacity;
+}
+
+unsigned ANNPopulation::GetNumInputs() const
+{
+	return m_layers.front().m_numNeurons;
+}
+
+unsigned ANNPopulation::GetNumOutputs() const
+{
+	return m_layers.back().m_numNeurons;
+}
+
+unsigned ANNPopulation::GetNumWeights() const
+{
+	return m_numWeights;
+}
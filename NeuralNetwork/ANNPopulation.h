@@ -0,0 +1,50 @@
+#pragma once
+
+#include "FANN/fann.h"
+
+#include <vector>
+
+#include "ANNWrapper.h"
+
+// evaluates a whole population of identically shaped networks in one call.
+// weights and activations are stored structure-of-arrays ([weight][agent]),
+// so every pass over the population walks contiguous memory.
+class ANNPopulation
+{
+public:
+	ANNPopulation(const ANNWrapper::ANNConfig& config, unsigned capacity);
+
+	void SetWeights(unsigned agent, const std::vector<fann_type>& weights);
+	void SetWeights(unsigned agent, const fann_type* weights);
+	std::vector<fann_type> GetWeights(unsigned agent) const;
+	void GetWeights(unsigned agent, fann_type* weights) const;
+	// copies the weights of one agent over the ones of another
+	void CopyWeights(unsigned from, unsigned to);
+
+	void SetInputs(unsigned agent, const fann_type* inputs);
+	fann_type GetOutput(unsigned agent, unsigned output) const;
+
+	// evaluates agents [0, agentCount)
+	void Run(unsigned agentCount);
+
+	unsigned GetCapacity() const;
+	unsigned GetNumInputs() const;
+	unsigned GetNumOutputs() const;
+	unsigned GetNumWeights() const;
+
+private:
+	struct Layer
+	{
+		unsigned	m_numNeurons;		// excluding bias
+		unsigned	m_firstWeight;		// first weight row of this layer
+		unsigned	m_firstValue;		// first value row of this layer
+	};
+
+	void RunActivation(fann_type* values, unsigned agentCount) const;
+
+	unsigned				m_capacity;
+	unsigned				m_numWeights;
+	std::vector<Layer>		m_layers;
+	std::vector<fann_type>	m_weights;	// [weight][agent]
+	std::vector<fann_type>	m_values;	// [neuron][agent], bias neurons excluded
+};
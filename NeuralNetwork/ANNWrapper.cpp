@@ -5,26 +5,22 @@
 #include <iostream>
 #include <algorithm>
 
+const fann_activationfunc_enum	ANNWrapper::ACTIVATION_FUNCTION		= FANN_SIGMOID_SYMMETRIC;
+const fann_type					ANNWrapper::ACTIVATION_STEEPNESS	= ACTIVATION_STEEPNESS_PERCENT * 0.01f;
+
 ANNWrapper::ANNWrapper(const ANNConfig& config) : 
 	m_config(config),
 	m_currEpoch(0),
-	m_mse(0.f),
-	m_randomizer(-1.f, 1.f)
+	m_mse(0.f)
 {
-	std::vector<unsigned> layers(m_config.m_numLayers, 0);
-	
-	layers.front()	= m_config.m_numInputs;
-	layers.back()	= m_config.m_numOutputs;
-
-	for (size_t i = 1; i < (layers.size() - 1); ++i)
-	{
-		layers[i] = m_config.m_numNeuronsInHidden;
-	}
+	std::vector<unsigned> layers = GetLayerSizes(m_config);
 
 	m_ann = fann_create_standard_array(m_config.m_numLayers, &layers[0]);
 
-	fann_set_activation_function_hidden(m_ann, FANN_SIGMOID_SYMMETRIC);
-	fann_set_activation_function_output(m_ann, FANN_SIGMOID_SYMMETRIC);
+	fann_set_activation_function_hidden(m_ann, ACTIVATION_FUNCTION);
+	fann_set_activation_function_output(m_ann, ACTIVATION_FUNCTION);
+	fann_set_activation_steepness_hidden(m_ann, ACTIVATION_STEEPNESS);
+	fann_set_activation_steepness_output(m_ann, ACTIVATION_STEEPNESS);
 
 	fann_set_user_data(m_ann, this);
 	fann_set_callback(m_ann, MyANNCallback);
@@ -35,12 +31,37 @@ ANNWrapper::~ANNWrapper()
 	fann_destroy(m_ann);
 }
 
-void ANNWrapper::RandomizeWeights()
+std::vector<unsigned> ANNWrapper::GetLayerSizes(const ANNConfig& config)
+{
+	std::vector<unsigned> layers(config.m_numLayers, 0);
+
+	layers.front()	= config.m_numInputs;
+	layers.back()	= config.m_numOutputs;
+
+	for (size_t i = 1; i < (layers.size() - 1); ++i)
+	{
+		layers[i] = config.m_numNeuronsInHidden;
+	}
+	return layers;
+}
+
+unsigned ANNWrapper::GetNumWeights(const ANNConfig& config)
+{
+	// fully connected, every neuron also has a bias weight
+	std::vector<unsigned> layers = GetLayerSizes(config);
+	unsigned numWeights = 0;
+	for (size_t i = 1; i < layers.size(); ++i)
+	{
+		numWeights += (layers[i - 1] + 1) * layers[i];
+	}
+	return numWeights;
+}
+
+void ANNWrapper::RandomizeWeights(Randomizer& randomizer)
 {
 	unsigned totalConnections = fann_get_total_connections(m_ann);
 	std::vector<fann_type> vWeights(totalConnections);
-	for (auto & w : vWeights)
-		w = m_randomizer.GetRandomFloat();
+	randomizer.FillUniform(&vWeights[0], vWeights.size());
 	fann_set_weights(m_ann, &vWeights[0]);
 }
 
@@ -77,14 +98,21 @@ std::vector<ANNWrapper::Connection> ANNWrapper::GetConnections()
 	return result;
 }
 
-std::vector<fann_type> ANNWrapper::Run(std::vector<fann_type> inputs)
+std::vector<fann_type> ANNWrapper::Run(const std::vector<fann_type>& inputs)
 {
 	assert(inputs.size() == m_config.m_numInputs);
-	fann_type * output = fann_run(m_ann, &inputs[0]);
-	std::vector<fann_type> result(output, output + m_config.m_numOutputs);
+	std::vector<fann_type> result(m_config.m_numOutputs);
+	Run(inputs.data(), result.data());
 	return result;
 }
 
+void ANNWrapper::Run(const fann_type* inputs, fann_type* outputs)
+{
+	// fann_run only reads the inputs, the outputs live in the network until the next run
+	fann_type * output = fann_run(m_ann, const_cast<fann_type*>(inputs));
+	std::copy(output, output + m_config.m_numOutputs, outputs);
+}
+
 unsigned ANNWrapper::GetCurrentEpoch() const
 {
 	return m_currEpoch;
@@ -2,6 +2,8 @@
 
 #include "FANN/fann.h"
 
+#include <array>
+#include <cassert>
 #include <vector>
 #include <memory>
 
@@ -38,17 +40,30 @@ public:
 		float			m_weight;
 	};
 
+	static const fann_activationfunc_enum	ACTIVATION_FUNCTION;
+	static const fann_type					ACTIVATION_STEEPNESS;
+	// ACTIVATION_STEEPNESS in hundredths, a compile time constant for the FixedANN activations
+	static const int						ACTIVATION_STEEPNESS_PERCENT = 50;
+
 	ANNWrapper(const ANNConfig& config);
 	~ANNWrapper();
 
-	void RandomizeWeights();
+	static std::vector<unsigned> GetLayerSizes(const ANNConfig& config);
+	static unsigned GetNumWeights(const ANNConfig& config);
+
+	// weights drawn from the range of the caller's randomizer
+	void RandomizeWeights(Randomizer& randomizer);
 	void SetWeights(const std::vector<fann_type> & weights);
 	std::vector<Connection> GetConnections();
 	std::vector<fann_type> GetWeights() const;
 
-	std::vector<fann_type> Run(std::vector<fann_type> inputs);
+	std::vector<fann_type> Run(const std::vector<fann_type>& inputs);
 	template<unsigned N> std::vector<fann_type> Run(const fann_type (&inputs)[N]);
 
+	// no allocation, inputs hold m_numInputs values and outputs receive m_numOutputs
+	void Run(const fann_type* inputs, fann_type* outputs);
+	template<size_t N, size_t M> void Run(const std::array<fann_type, N>& inputs, std::array<fann_type, M>& outputs);
+
 	template<typename F, typename C> void SetEpochCallback(F fnc, C* fncClass);
 
 	unsigned	GetCurrentEpoch() const;
@@ -86,13 +101,22 @@ private:
 	std::unique_ptr<Concept>	m_epochCallback;
 	float						m_mse;
 	unsigned					m_currEpoch;
-	Randomizer					m_randomizer;
 };
 
 template<unsigned N>
 std::vector<fann_type> ANNWrapper::Run(const fann_type(&inputs)[N])
 {
-	return Run(std::vector<fann_type>(inputs, inputs + N));
+	assert(N == m_config.m_numInputs);
+	std::vector<fann_type> result(m_config.m_numOutputs);
+	Run(inputs, result.data());
+	return result;
+}
+
+template<size_t N, size_t M>
+void ANNWrapper::Run(const std::array<fann_type, N>& inputs, std::array<fann_type, M>& outputs)
+{
+	assert(N == m_config.m_numInputs && M == m_config.m_numOutputs);
+	Run(inputs.data(), outputs.data());
 }
 
 template<typename F, typename C>
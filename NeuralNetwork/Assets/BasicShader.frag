@@ -1,11 +1,11 @@
 #version 330 core
 in vec2 TexCoords;
+in vec4 Tint;
 out vec4 color;
 
 uniform sampler2D tex;
-uniform vec4 textTint;
 
 void main()
 {
-  color = texture(tex, TexCoords) * textTint;
-}
\ No newline at end of file
+  color = texture(tex, TexCoords) * Tint;
+}
@@ -3,16 +3,23 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoords;
 
+// per sprite
+layout(location = 2) in vec4 aModelRow0;
+layout(location = 3) in vec4 aModelRow1;
+layout(location = 4) in vec4 aModelRow2;
+layout(location = 5) in vec4 aModelRow3;
+layout(location = 6) in vec4 aTint;
+layout(location = 7) in vec4 aFrame;	// texcoord offset, frame count
+
 out vec2 TexCoords;
+out vec4 Tint;
 
-uniform mat4 model;
 uniform mat4 projView;
 
-uniform vec2 texcoordoffset;
-uniform vec2 textframecount;
-
 void main()
 {
-  gl_Position = projView * model * vec4(aPos.xyz, 1);
-  TexCoords   = aTexCoords / textframecount + texcoordoffset;
+  vec4 pos    = vec4(aPos.xyz, 1);
+  gl_Position = projView * vec4(dot(aModelRow0, pos), dot(aModelRow1, pos), dot(aModelRow2, pos), dot(aModelRow3, pos));
+  TexCoords   = aTexCoords / aFrame.zw + aFrame.xy;
+  Tint        = aTint;
 }
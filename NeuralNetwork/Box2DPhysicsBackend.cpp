@@ -0,0 +1,238 @@
+#include "Box2DPhysicsBackend.h"
+
+#include "PhysicsManager.h"
+#include "PhysicsContactListener.h"
+
+namespace
+{
+	b2BodyType GetB2BodyType(PhysicsBackend::BodyType type)
+	{
+		switch (type)
+		{
+		case PhysicsBackend::BodyType::STATIC:		return b2_staticBody;
+		case PhysicsBackend::BodyType::KINEMATIC:	return b2_kinematicBody;
+		default:									return b2_dynamicBody;
+		}
+	}
+
+	ContactInfo GetContactInfo(b2Contact* contact, bool withManifold)
+	{
+		ContactInfo info;
+		info.m_bodyA = reinterpret_cast<PhysicsBody*>(contact->GetFixtureA()->GetBody()->GetUserData());
+		info.m_bodyB = reinterpret_cast<PhysicsBody*>(contact->GetFixtureB()->GetBody()->GetUserData());
+		info.m_isTouching = contact->IsTouching();
+
+		if (!withManifold)
+		{
+			info.m_contactWorldNormal		= math::vec2();
+			info.m_contactWorldPoints[0]	= math::vec2();
+			info.m_contactWorldPoints[1]	= math::vec2();
+			return info;
+		}
+
+		b2WorldManifold manifold;
+		contact->GetWorldManifold(&manifold);
+
+		info.m_contactWorldNormal = math::vec2(manifold.normal.x, manifold.normal.y);
+		info.m_contactWorldPoints[0] = math::vec2(manifold.points[0].x, manifold.points[0].y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+		info.m_contactWorldPoints[1] = math::vec2(manifold.points[1].x, manifold.points[1].y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+
+		return info;
+	}
+}
+
+Box2DPhysicsBackend::Box2DPhysicsBackend(const math::vec2& gravity, PhysicsContactListener& listener) :
+	PhysicsBackend(listener),
+	m_world(std::make_unique<b2World>(b2Vec2(gravity.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR, gravity.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR)))
+{
+	m_world->SetContactListener(this);
+}
+
+Box2DPhysicsBackend::~Box2DPhysicsBackend()
+{
+	m_world->SetContactListener(nullptr);
+}
+
+void Box2DPhysicsBackend::Step(float dt, int velocityIter, int positionIter)
+{
+	m_world->Step(dt, velocityIter, positionIter);
+}
+
+PhysicsBackend::BodyHandle Box2DPhysicsBackend::CreateBody(const BodyDef& def)
+{
+	b2BodyDef bodyDef;
+	bodyDef.position.Set(def.m_position.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR, def.m_position.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR);
+	bodyDef.angle			= DEG_TO_RAD(def.m_angle);
+	bodyDef.fixedRotation	= false;
+	bodyDef.userData		= def.m_owner;
+	bodyDef.type			= GetB2BodyType(def.m_bodyType);
+
+	b2Body* body = m_world->CreateBody(&bodyDef);
+
+	b2CircleShape circle;
+	b2PolygonShape box;
+
+	b2FixtureDef fixtureDef;
+	fixtureDef.density		= 1.f;	// since its area with respect to density
+	fixtureDef.friction		= 1.f;
+	fixtureDef.restitution	= 0.f;
+	if (def.m_shapeType == ShapeType::CIRCLE)
+	{
+		circle.m_radius		= def.m_size.x * 0.5f * PhysicsManager::INV_BOX2D_SCALE_FACTOR;
+		fixtureDef.shape	= &circle;
+	}
+	else
+	{
+		box.SetAsBox(def.m_size.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR * 0.5f, def.m_size.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR * 0.5f);
+		fixtureDef.shape	= &box;
+	}
+	body->CreateFixture(&fixtureDef);
+
+	BodyHandle handle;
+	if (m_freeHandles.empty())
+	{
+		handle = static_cast<BodyHandle>(m_bodies.size());
+		m_bodies.emplace_back(body);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_bodies[handle] = body;
+	}
+	return handle;
+}
+
+void Box2DPhysicsBackend::DestroyBody(BodyHandle body)
+{
+	m_world->DestroyBody(m_bodies[body]);
+	m_bodies[body] = nullptr;
+	m_freeHandles.emplace_back(body);
+}
+
+void Box2DPhysicsBackend::DisableBody(BodyHandle body)
+{
+	// leaves the broadphase, the fixtures and their memory stay with the body
+	m_bodies[body]->SetActive(false);
+}
+
+void Box2DPhysicsBackend::ResetBody(BodyHandle body, const BodyDef& def)
+{
+	// same state as CreateBody, the fixture already has the shape of def
+	b2Body* b2body = m_bodies[body];
+	b2body->SetType(GetB2BodyType(def.m_bodyType));
+	b2body->SetUserData(def.m_owner);
+	b2body->SetTransform(b2Vec2(def.m_position.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR, def.m_position.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR), DEG_TO_RAD(def.m_angle));
+	b2body->SetLinearVelocity(b2Vec2(0.f, 0.f));
+	b2body->SetAngularVelocity(0.f);
+	b2body->SetGravityScale(1.f);
+
+	b2Filter filter;
+	for (b2Fixture * fixture = b2body->GetFixtureList(); fixture; fixture = fixture->GetNext())
+	{
+		fixture->SetDensity(1.f);
+		fixture->SetFriction(1.f);
+		fixture->SetRestitution(0.f);
+		fixture->SetSensor(false);
+		fixture->SetFilterData(filter);
+	}
+	b2body->ResetMassData();
+
+	b2body->SetActive(true);
+	b2body->SetAwake(true);
+}
+
+math::vec2 Box2DPhysicsBackend::GetPosition(BodyHandle body) const
+{
+	b2Vec2 pos = m_bodies[body]->GetPosition();
+	return math::vec2(pos.x, pos.y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+}
+
+float Box2DPhysicsBackend::GetAngle(BodyHandle body) const
+{
+	return RAD_TO_DEG(m_bodies[body]->GetAngle());
+}
+
+math::vec2 Box2DPhysicsBackend::GetVelocity(BodyHandle body) const
+{
+	b2Vec2 spd = m_bodies[body]->GetLinearVelocity();
+	return math::vec2(spd.x, spd.y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+}
+
+float Box2DPhysicsBackend::GetGravityScale(BodyHandle body) const
+{
+	return m_bodies[body]->GetGravityScale();
+}
+
+float Box2DPhysicsBackend::GetFriction(BodyHandle body) const
+{
+	b2Fixture * fixtures = m_bodies[body]->GetFixtureList();
+	return fixtures ? fixtures->GetFriction() : 0.f;
+}
+
+void Box2DPhysicsBackend::SetVelocity(BodyHandle body, const math::vec2& velocity)
+{
+	m_bodies[body]->SetLinearVelocity(b2Vec2(velocity.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR, velocity.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR));
+}
+
+void Box2DPhysicsBackend::SetGravityScale(BodyHandle body, float scale)
+{
+	m_bodies[body]->SetGravityScale(scale);
+}
+
+void Box2DPhysicsBackend::SetFriction(BodyHandle body, float friction)
+{
+	for (b2Fixture * fixture = m_bodies[body]->GetFixtureList(); fixture; fixture = fixture->GetNext())
+	{
+		fixture->SetFriction(friction);
+	}
+}
+
+void Box2DPhysicsBackend::SetDensity(BodyHandle body, float density)
+{
+	for (b2Fixture * fixture = m_bodies[body]->GetFixtureList(); fixture; fixture = fixture->GetNext())
+	{
+		fixture->SetDensity(density);
+	}
+	m_bodies[body]->ResetMassData();
+}
+
+void Box2DPhysicsBackend::SetSensor(BodyHandle body, bool set)
+{
+	for (b2Fixture * fixture = m_bodies[body]->GetFixtureList(); fixture; fixture = fixture->GetNext())
+	{
+		fixture->SetSensor(set);
+	}
+}
+
+void Box2DPhysicsBackend::SetFilter(BodyHandle body, uint16_t categoryBits, uint16_t maskBits)
+{
+	for (b2Fixture * fixture = m_bodies[body]->GetFixtureList(); fixture; fixture = fixture->GetNext())
+	{
+		b2Filter filter;
+		filter.groupIndex	= 0;
+		filter.categoryBits = categoryBits;
+		filter.maskBits		= maskBits;
+		fixture->SetFilterData(filter);
+	}
+}
+
+void Box2DPhysicsBackend::ApplyForceToCenter(BodyHandle body, const math::vec2& force)
+{
+	m_bodies[body]->ApplyForceToCenter(b2Vec2(force.x, force.y), true);
+}
+
+void Box2DPhysicsBackend::AddAngularVelocity(BodyHandle body, float radians)
+{
+	m_bodies[body]->ApplyAngularImpulse(radians * m_bodies[body]->GetInertia(), true);
+}
+
+void Box2DPhysicsBackend::BeginContact(b2Contact* contact)
+{
+	m_listener.BeginContact(GetContactInfo(contact, m_listener.AreManifoldsRequired()));
+}
+
+void Box2DPhysicsBackend::EndContact(b2Contact* contact)
+{
+	m_listener.EndContact(GetContactInfo(contact, m_listener.AreManifoldsRequired()));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "PhysicsBackend.h"
+#include "Box2D/box2d.h"
+
+#include <vector>
+#include <memory>
+
+// general rigid body simulation on a b2World
+class Box2DPhysicsBackend : public PhysicsBackend, private b2ContactListener
+{
+public:
+	// gravity in world units
+	Box2DPhysicsBackend(const math::vec2& gravity, PhysicsContactListener& listener);
+	~Box2DPhysicsBackend();
+
+	void Step(float dt, int velocityIter, int positionIter) override;
+
+	BodyHandle CreateBody(const BodyDef& def) override;
+	void DestroyBody(BodyHandle body) override;
+	void DisableBody(BodyHandle body) override;
+	void ResetBody(BodyHandle body, const BodyDef& def) override;
+
+	math::vec2 GetPosition(BodyHandle body) const override;
+	float GetAngle(BodyHandle body) const override;
+	math::vec2 GetVelocity(BodyHandle body) const override;
+	float GetGravityScale(BodyHandle body) const override;
+	float GetFriction(BodyHandle body) const override;
+
+	void SetVelocity(BodyHandle body, const math::vec2& velocity) override;
+	void SetGravityScale(BodyHandle body, float scale) override;
+	void SetFriction(BodyHandle body, float friction) override;
+	void SetDensity(BodyHandle body, float density) override;
+	void SetSensor(BodyHandle body, bool set) override;
+	void SetFilter(BodyHandle body, uint16_t categoryBits, uint16_t maskBits) override;
+
+	void ApplyForceToCenter(BodyHandle body, const math::vec2& force) override;
+	void AddAngularVelocity(BodyHandle body, float radians) override;
+
+private:
+	// b2ContactListener
+	void BeginContact(b2Contact* contact) override;
+	void EndContact(b2Contact* contact) override;
+
+	std::unique_ptr<b2World>	m_world;
+	std::vector<b2Body*>		m_bodies;		// indexed by handle, null when free
+	std::vector<BodyHandle>		m_freeHandles;
+};
@@ -1,6 +1,7 @@
 #include <GL/glew.h>
 
 #include "Camera.h"
+#include "Profiler.h"
 #include "DebugDrawer.h"
 #include "GraphicsManager.h"
 
@@ -103,6 +104,8 @@ DebugDrawer::~DebugDrawer()
 
 void DebugDrawer::RenderDebugShapes()
 {
+	PROFILE_SCOPE("DebugDrawer::RenderDebugShapes");
+
 	m_graphicsMgr.EnableAlphaBlend();
 		
 	// render...
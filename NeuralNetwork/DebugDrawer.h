@@ -3,14 +3,10 @@
 #include <vector>
 
 #include "GraphicsBuffers.h"
+#include "DebugColors.h"
 #include "GLShader.h"
 #include "math.h"
 
-static const math::vec4 DEBUG_RED		= math::vec4(1.00f, 0.41f, 0.38f, 1.0f);
-static const math::vec4 DEBUG_GREEN		= math::vec4(0.47f, 0.87f, 0.47f, 1.0f);
-static const math::vec4 DEBUG_BLUE		= math::vec4(0.68f, 0.78f, 0.90f, 1.0f);
-static const math::vec4 DEBUG_YELLOW	= math::vec4(0.99f, 0.99f, 0.59f, 1.0f);
-
 class GraphicsManager;
 class DebugDrawer
 {
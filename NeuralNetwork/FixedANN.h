@@ -0,0 +1,141 @@
+#pragma once
+
+#include "FANN/fann.h"
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cassert>
+
+#include "math.h"
+
+// activation policies of FixedANN, scale and clamp the sum the same way fann_run does
+template<int STEEPNESS_PERCENT>
+struct FixedANNSigmoidSymmetric
+{
+	static fann_type Activate(fann_type sum)
+	{
+		const fann_type steepness	= STEEPNESS_PERCENT * 0.01f;
+		const fann_type maxSum		= 150.f / steepness;
+		sum = Clamp(sum * steepness, -maxSum, maxSum);
+		return 2.f / (1.f + expf(-2.f * sum)) - 1.f;
+	}
+};
+
+template<int STEEPNESS_PERCENT>
+struct FixedANNSigmoid
+{
+	static fann_type Activate(fann_type sum)
+	{
+		const fann_type steepness	= STEEPNESS_PERCENT * 0.01f;
+		const fann_type maxSum		= 150.f / steepness;
+		sum = Clamp(sum * steepness, -maxSum, maxSum);
+		return 1.f / (1.f + expf(-2.f * sum));
+	}
+};
+
+namespace FixedANNDetail
+{
+	// forward pass of layers IN -> OUT -> REST..., loop bounds are constants so every
+	// layer is unrolled into straight multiply-adds
+	template<typename ACTIVATION, unsigned IN, unsigned OUT, unsigned ... REST>
+	struct Layers
+	{
+		static const unsigned NUM_WEIGHTS	= (IN + 1) * OUT + Layers<ACTIVATION, OUT, REST...>::NUM_WEIGHTS;
+		static const unsigned NUM_OUTPUTS	= Layers<ACTIVATION, OUT, REST...>::NUM_OUTPUTS;
+
+		static void Run(const fann_type* weights, const fann_type* inputs, fann_type* outputs)
+		{
+			fann_type values[OUT];
+			Layers<ACTIVATION, IN, OUT>::Run(weights, inputs, values);
+			Layers<ACTIVATION, OUT, REST...>::Run(weights + (IN + 1) * OUT, values, outputs);
+		}
+	};
+
+	template<typename ACTIVATION, unsigned IN, unsigned OUT>
+	struct Layers<ACTIVATION, IN, OUT>
+	{
+		static const unsigned NUM_WEIGHTS	= (IN + 1) * OUT;
+		static const unsigned NUM_OUTPUTS	= OUT;
+
+		// same connection order as fann_create_standard_array: every neuron reads the
+		// previous layer followed by its bias
+		static void Run(const fann_type* weights, const fann_type* inputs, fann_type* outputs)
+		{
+			for (unsigned n = 0; n < OUT; ++n)
+			{
+				const fann_type* w = weights + n * (IN + 1);
+				fann_type sum = w[IN];
+				for (unsigned i = 0; i < IN; ++i)
+				{
+					sum += w[i] * inputs[i];
+				}
+				outputs[n] = ACTIVATION::Activate(sum);
+			}
+		}
+	};
+
+	template<unsigned FIRST, unsigned ... REST>
+	struct First
+	{
+		static const unsigned VALUE = FIRST;
+	};
+}
+
+// fully connected network with the topology fixed at compile time, e.g.
+// FixedANN<FixedANNSigmoidSymmetric<50>, 3, 4, 1> is 3 inputs, 4 hidden, 1 output.
+// weights are laid out like a FANN network of the same shape, so genomes move freely
+// between ANNWrapper, ANNPopulation and FixedANN
+template<typename ACTIVATION, unsigned ... LAYERS>
+class FixedANN
+{
+	static_assert(sizeof...(LAYERS) >= 2, "FixedANN needs an input and an output layer");
+
+	using Network = FixedANNDetail::Layers<ACTIVATION, LAYERS...>;
+
+public:
+	static const unsigned NUM_INPUTS	= FixedANNDetail::First<LAYERS...>::VALUE;
+	static const unsigned NUM_OUTPUTS	= Network::NUM_OUTPUTS;
+	static const unsigned NUM_WEIGHTS	= Network::NUM_WEIGHTS;
+
+	using Inputs	= std::array<fann_type, NUM_INPUTS>;
+	using Outputs	= std::array<fann_type, NUM_OUTPUTS>;
+	using Weights	= std::array<fann_type, NUM_WEIGHTS>;
+
+	static std::vector<unsigned> GetLayerSizes()
+	{
+		return std::vector<unsigned>{ LAYERS... };
+	}
+
+	void SetWeights(const fann_type* weights)
+	{
+		std::copy(weights, weights + NUM_WEIGHTS, m_weights.begin());
+	}
+
+	void SetWeights(const std::vector<fann_type>& weights)
+	{
+		assert(weights.size() == NUM_WEIGHTS);
+		SetWeights(weights.data());
+	}
+
+	const Weights& GetWeights() const
+	{
+		return m_weights;
+	}
+
+	void Run(const fann_type* inputs, fann_type* outputs) const
+	{
+		Network::Run(m_weights.data(), inputs, outputs);
+	}
+
+	Outputs Run(const Inputs& inputs) const
+	{
+		Outputs outputs;
+		Network::Run(m_weights.data(), inputs.data(), outputs.data());
+		return outputs;
+	}
+
+private:
+	Weights m_weights;
+};
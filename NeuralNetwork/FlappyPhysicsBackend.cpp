@@ -0,0 +1,404 @@
+#include "FlappyPhysicsBackend.h"
+
+#include "PhysicsManager.h"
+#include "PhysicsContactListener.h"
+
+#include <cmath>
+#include <iterator>
+#include <algorithm>
+
+FlappyPhysicsBackend::FlappyPhysicsBackend(const math::vec2& gravity, PhysicsContactListener& listener) :
+	PhysicsBackend(listener),
+	m_gravity(gravity),
+	m_categoryWidth()
+{
+}
+
+void FlappyPhysicsBackend::Step(float dt, int, int)
+{
+	Integrate(dt);
+	UpdateBounds();
+	FindContacts();
+	ReportContacts();
+}
+
+PhysicsBackend::BodyHandle FlappyPhysicsBackend::CreateBody(const BodyDef& def)
+{
+	BodyHandle handle;
+	if (m_freeHandles.empty())
+	{
+		handle = static_cast<BodyHandle>(m_owner.size());
+		size_t count = m_owner.size() + 1;
+		m_posX.resize(count);			m_posY.resize(count);
+		m_velX.resize(count);			m_velY.resize(count);
+		m_forceX.resize(count);			m_forceY.resize(count);
+		m_halfX.resize(count);			m_halfY.resize(count);
+		m_sizeX.resize(count);			m_sizeY.resize(count);
+		m_angle.resize(count);			m_angularVel.resize(count);
+		m_gravityScale.resize(count);	m_invMass.resize(count);
+		m_density.resize(count);		m_friction.resize(count);
+		m_categoryBits.resize(count);	m_maskBits.resize(count);
+		m_bodyType.resize(count);		m_shapeType.resize(count);
+		m_owner.resize(count);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+
+	ResetBody(handle, def);
+	return handle;
+}
+
+void FlappyPhysicsBackend::ResetBody(BodyHandle handle, const BodyDef& def)
+{
+	m_posX[handle]			= def.m_position.x;
+	m_posY[handle]			= def.m_position.y;
+	m_velX[handle]			= 0.f;
+	m_velY[handle]			= 0.f;
+	m_forceX[handle]		= 0.f;
+	m_forceY[handle]		= 0.f;
+	m_sizeX[handle]			= def.m_size.x;
+	m_sizeY[handle]			= def.m_size.y;
+	m_halfX[handle]			= def.m_size.x * 0.5f;
+	m_halfY[handle]			= def.m_size.y * 0.5f;
+	m_angle[handle]			= DEG_TO_RAD(def.m_angle);
+	m_angularVel[handle]	= 0.f;
+	m_gravityScale[handle]	= 1.f;
+	m_friction[handle]		= 1.f;
+	m_categoryBits[handle]	= 0x0001;
+	m_maskBits[handle]		= 0xFFFF;
+	m_bodyType[handle]		= def.m_bodyType;
+	m_shapeType[handle]		= def.m_shapeType;
+	m_owner[handle]			= def.m_owner;
+	SetDensity(handle, 1.f);
+}
+
+void FlappyPhysicsBackend::DestroyBody(BodyHandle body)
+{
+	DisableBody(body);
+	m_freeHandles.emplace_back(body);
+}
+
+void FlappyPhysicsBackend::DisableBody(BodyHandle body)
+{
+	// end the contacts of the body, without an owner it is skipped by the contact search
+	auto it = std::remove_if(m_contacts.begin(), m_contacts.end(), [body](unsigned long long pair)
+	{
+		return static_cast<BodyHandle>(pair >> 32) == body || static_cast<BodyHandle>(pair) == body;
+	});
+	std::vector<unsigned long long> ended(it, m_contacts.end());
+	m_contacts.erase(it, m_contacts.end());
+
+	for (unsigned long long pair : ended)
+	{
+		ReportContact(pair, false);
+	}
+
+	m_owner[body] = nullptr;
+}
+
+math::vec2 FlappyPhysicsBackend::GetPosition(BodyHandle body) const
+{
+	return math::vec2(m_posX[body], m_posY[body]);
+}
+
+float FlappyPhysicsBackend::GetAngle(BodyHandle body) const
+{
+	return RAD_TO_DEG(m_angle[body]);
+}
+
+math::vec2 FlappyPhysicsBackend::GetVelocity(BodyHandle body) const
+{
+	return math::vec2(m_velX[body], m_velY[body]);
+}
+
+float FlappyPhysicsBackend::GetGravityScale(BodyHandle body) const
+{
+	return m_gravityScale[body];
+}
+
+float FlappyPhysicsBackend::GetFriction(BodyHandle body) const
+{
+	return m_friction[body];
+}
+
+void FlappyPhysicsBackend::SetVelocity(BodyHandle body, const math::vec2& velocity)
+{
+	// same as Box2D, static bodies never move
+	if (m_bodyType[body] == BodyType::STATIC)
+		return;
+
+	m_velX[body] = velocity.x;
+	m_velY[body] = velocity.y;
+}
+
+void FlappyPhysicsBackend::SetGravityScale(BodyHandle body, float scale)
+{
+	m_gravityScale[body] = scale;
+}
+
+void FlappyPhysicsBackend::SetFriction(BodyHandle body, float friction)
+{
+	m_friction[body] = friction;
+}
+
+void FlappyPhysicsBackend::SetDensity(BodyHandle body, float density)
+{
+	m_density[body] = density;
+
+	if (m_bodyType[body] != BodyType::DYNAMIC)
+	{
+		m_invMass[body] = 0.f;
+		return;
+	}
+
+	// mass in physics units, Box2D falls back to a unit mass for massless dynamic bodies
+	float scale = PhysicsManager::INV_BOX2D_SCALE_FACTOR * PhysicsManager::INV_BOX2D_SCALE_FACTOR;
+	float area = m_shapeType[body] == ShapeType::CIRCLE ?
+		PIf * m_sizeX[body] * m_sizeX[body] * 0.25f * scale :
+		m_sizeX[body] * m_sizeY[body] * scale;
+	float mass = density * area;
+	m_invMass[body] = mass > 0.f ? 1.f / mass : 1.f;
+}
+
+void FlappyPhysicsBackend::SetSensor(BodyHandle, bool)
+{
+	// every body is a sensor already
+}
+
+void FlappyPhysicsBackend::SetFilter(BodyHandle body, uint16_t categoryBits, uint16_t maskBits)
+{
+	m_categoryBits[body]	= categoryBits;
+	m_maskBits[body]		= maskBits;
+}
+
+void FlappyPhysicsBackend::ApplyForceToCenter(BodyHandle body, const math::vec2& force)
+{
+	m_forceX[body] += force.x;
+	m_forceY[body] += force.y;
+}
+
+void FlappyPhysicsBackend::AddAngularVelocity(BodyHandle body, float radians)
+{
+	if (m_bodyType[body] == BodyType::DYNAMIC)
+		m_angularVel[body] += radians;
+}
+
+void FlappyPhysicsBackend::Integrate(float dt)
+{
+	// semi implicit euler, same order as Box2D: velocity first, then position
+	float forceScale = PhysicsManager::BOX2D_SCALE_FACTOR;
+	size_t count = m_owner.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (m_bodyType[i] == BodyType::DYNAMIC)
+		{
+			m_velX[i] += dt * (m_gravityScale[i] * m_gravity.x + forceScale * m_invMass[i] * m_forceX[i]);
+			m_velY[i] += dt * (m_gravityScale[i] * m_gravity.y + forceScale * m_invMass[i] * m_forceY[i]);
+		}
+		m_forceX[i] = 0.f;
+		m_forceY[i] = 0.f;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		m_posX[i]	+= dt * m_velX[i];
+		m_posY[i]	+= dt * m_velY[i];
+		m_angle[i]	+= dt * m_angularVel[i];
+	}
+}
+
+void FlappyPhysicsBackend::UpdateBounds()
+{
+	for (auto & category : m_categories)
+	{
+		category.clear();
+	}
+
+	size_t count = m_owner.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!m_owner[i])
+			continue;
+
+		if (m_shapeType[i] == ShapeType::BOX)
+		{
+			// world aligned extents of the rotated box
+			float c = fabs(cosf(m_angle[i]));
+			float s = fabs(sinf(m_angle[i]));
+			m_halfX[i] = 0.5f * (c * m_sizeX[i] + s * m_sizeY[i]);
+			m_halfY[i] = 0.5f * (s * m_sizeX[i] + c * m_sizeY[i]);
+		}
+
+		for (unsigned bit = 0; bit < CATEGORY_COUNT; ++bit)
+		{
+			if (m_categoryBits[i] & (1u << bit))
+				m_categories[bit].emplace_back(static_cast<BodyHandle>(i));
+		}
+	}
+
+	// sort each category by left edge for the sweep in FindContacts
+	auto minX = [this](BodyHandle body) { return m_posX[body] - m_halfX[body]; };
+	for (unsigned bit = 0; bit < CATEGORY_COUNT; ++bit)
+	{
+		std::vector<BodyHandle> & category = m_categories[bit];
+		std::sort(category.begin(), category.end(), [&minX](BodyHandle a, BodyHandle b)
+		{
+			float ax = minX(a), bx = minX(b);
+			return ax < bx || (ax == bx && a < b);
+		});
+
+		m_categoryMinX[bit].resize(category.size());
+		m_categoryWidth[bit] = 0.f;
+		for (size_t j = 0; j < category.size(); ++j)
+		{
+			m_categoryMinX[bit][j] = minX(category[j]);
+			m_categoryWidth[bit] = (std::max)(m_categoryWidth[bit], 2.f * m_halfX[category[j]]);
+		}
+	}
+}
+
+void FlappyPhysicsBackend::FindContacts()
+{
+	m_newContacts.clear();
+
+	// only pairs with a dynamic body can touch, so those drive the search
+	size_t count = m_owner.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!m_owner[i] || m_bodyType[i] != BodyType::DYNAMIC)
+			continue;
+
+		BodyHandle a = static_cast<BodyHandle>(i);
+		float minA = m_posX[a] - m_halfX[a];
+		float maxA = m_posX[a] + m_halfX[a];
+		for (unsigned bit = 0; bit < CATEGORY_COUNT; ++bit)
+		{
+			if (!(m_maskBits[a] & (1u << bit)))
+				continue;
+
+			// no body of the category starts further left than its widest body's width
+			// before a, and the sweep stops at the first body starting right of a
+			const std::vector<float> & categoryMinX = m_categoryMinX[bit];
+			size_t first = std::lower_bound(categoryMinX.begin(), categoryMinX.end(), minA - m_categoryWidth[bit]) - categoryMinX.begin();
+			for (size_t j = first; j < categoryMinX.size() && categoryMinX[j] <= maxA; ++j)
+			{
+				BodyHandle b = m_categories[bit][j];
+				if (m_posX[b] + m_halfX[b] < minA)
+					continue;
+
+				// a dynamic pair is found from both bodies, keep the one from the lower handle
+				if (b == a || (m_bodyType[b] == BodyType::DYNAMIC && b < a))
+					continue;
+
+				// a body in several categories is found once per shared bit, keep the lowest
+				unsigned shared = m_maskBits[a] & m_categoryBits[b];
+				if ((shared & (0u - shared)) != (1u << bit))
+					continue;
+
+				if (!(m_categoryBits[a] & m_maskBits[b]))
+					continue;
+
+				if (TestOverlap(a, b))
+					m_newContacts.emplace_back(MakePair(a, b));
+			}
+		}
+	}
+
+	std::sort(m_newContacts.begin(), m_newContacts.end());
+}
+
+void FlappyPhysicsBackend::ReportContacts()
+{
+	std::vector<unsigned long long> ended, begun;
+	std::set_difference(m_contacts.begin(), m_contacts.end(), m_newContacts.begin(), m_newContacts.end(), std::back_inserter(ended));
+	std::set_difference(m_newContacts.begin(), m_newContacts.end(), m_contacts.begin(), m_contacts.end(), std::back_inserter(begun));
+
+	// the callbacks may destroy bodies, so the contact set is updated before reporting
+	m_contacts.swap(m_newContacts);
+
+	for (unsigned long long pair : ended)
+	{
+		ReportContact(pair, false);
+	}
+
+	for (unsigned long long pair : begun)
+	{
+		ReportContact(pair, true);
+	}
+}
+
+bool FlappyPhysicsBackend::TestOverlap(BodyHandle a, BodyHandle b) const
+{
+	float dx = m_posX[b] - m_posX[a];
+	float dy = m_posY[b] - m_posY[a];
+
+	bool circleA = m_shapeType[a] == ShapeType::CIRCLE;
+	bool circleB = m_shapeType[b] == ShapeType::CIRCLE;
+
+	if (circleA && circleB)
+	{
+		float r = m_halfX[a] + m_halfX[b];
+		return dx * dx + dy * dy < r * r;
+	}
+
+	if (circleA || circleB)
+	{
+		BodyHandle circle	= circleA ? a : b;
+		BodyHandle box		= circleA ? b : a;
+
+		// closest point of the box to the circle center
+		float cx = m_posX[circle] - m_posX[box];
+		float cy = m_posY[circle] - m_posY[box];
+		float px = cx - Clamp(cx, -m_halfX[box], m_halfX[box]);
+		float py = cy - Clamp(cy, -m_halfY[box], m_halfY[box]);
+		return px * px + py * py < m_halfX[circle] * m_halfX[circle];
+	}
+
+	return	fabs(dx) < m_halfX[a] + m_halfX[b] &&
+			fabs(dy) < m_halfY[a] + m_halfY[b];
+}
+
+void FlappyPhysicsBackend::ReportContact(unsigned long long pair, bool begin) const
+{
+	BodyHandle a = static_cast<BodyHandle>(pair >> 32);
+	BodyHandle b = static_cast<BodyHandle>(pair);
+
+	// a body destroyed by an earlier callback of this step
+	if (!m_owner[a] || !m_owner[b])
+		return;
+
+	ContactInfo info;
+	info.m_bodyA		= m_owner[a];
+	info.m_bodyB		= m_owner[b];
+	info.m_isTouching	= begin;
+
+	if (!m_listener.AreManifoldsRequired())
+	{
+		info.m_contactWorldNormal		= math::vec2();
+		info.m_contactWorldPoints[0]	= math::vec2();
+		info.m_contactWorldPoints[1]	= math::vec2();
+	}
+	else
+	{
+		math::vec2 delta(m_posX[b] - m_posX[a], m_posY[b] - m_posY[a]);
+		float length = sqrtf(delta.x * delta.x + delta.y * delta.y);
+		info.m_contactWorldNormal		= length > 0.f ? delta * (1.f / length) : math::vec2(0.f, 1.f);
+		info.m_contactWorldPoints[0]	= math::vec2(m_posX[a], m_posY[a]) + delta * 0.5f;
+		info.m_contactWorldPoints[1]	= info.m_contactWorldPoints[0];
+	}
+
+	if (begin)
+		m_listener.BeginContact(info);
+	else
+		m_listener.EndContact(info);
+}
+
+unsigned long long FlappyPhysicsBackend::MakePair(BodyHandle a, BodyHandle b)
+{
+	if (b < a)
+		std::swap(a, b);
+	return (static_cast<unsigned long long>(a) << 32) | b;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "PhysicsBackend.h"
+
+#include <vector>
+
+// purpose built backend for the flappy scene: explicit euler integration of
+// gravity and velocity, overlap tests between circles and axis aligned boxes.
+// there is no collision response, every body behaves like a Box2D sensor.
+// bodies are stored structure-of-arrays so the integration is one linear pass.
+// the contact search sweeps each category sorted by the left edge of the bodies,
+// so it only tests pairs whose x extents overlap.
+class FlappyPhysicsBackend : public PhysicsBackend
+{
+public:
+	// gravity in world units
+	FlappyPhysicsBackend(const math::vec2& gravity, PhysicsContactListener& listener);
+
+	void Step(float dt, int velocityIter, int positionIter) override;
+
+	BodyHandle CreateBody(const BodyDef& def) override;
+	void DestroyBody(BodyHandle body) override;
+	void DisableBody(BodyHandle body) override;
+	void ResetBody(BodyHandle body, const BodyDef& def) override;
+
+	math::vec2 GetPosition(BodyHandle body) const override;
+	float GetAngle(BodyHandle body) const override;
+	math::vec2 GetVelocity(BodyHandle body) const override;
+	float GetGravityScale(BodyHandle body) const override;
+	float GetFriction(BodyHandle body) const override;
+
+	void SetVelocity(BodyHandle body, const math::vec2& velocity) override;
+	void SetGravityScale(BodyHandle body, float scale) override;
+	void SetFriction(BodyHandle body, float friction) override;
+	void SetDensity(BodyHandle body, float density) override;
+	void SetSensor(BodyHandle body, bool set) override;
+	void SetFilter(BodyHandle body, uint16_t categoryBits, uint16_t maskBits) override;
+
+	void ApplyForceToCenter(BodyHandle body, const math::vec2& force) override;
+	void AddAngularVelocity(BodyHandle body, float radians) override;
+
+private:
+	static const unsigned CATEGORY_COUNT = 16;
+
+	void Integrate(float dt);
+	void UpdateBounds();
+	void FindContacts();
+	void ReportContacts();
+	bool TestOverlap(BodyHandle a, BodyHandle b) const;
+	void ReportContact(unsigned long long pair, bool begin) const;
+
+	static unsigned long long MakePair(BodyHandle a, BodyHandle b);
+
+	math::vec2				m_gravity;
+
+	// per body, indexed by handle
+	std::vector<float>			m_posX, m_posY;
+	std::vector<float>			m_velX, m_velY;
+	std::vector<float>			m_forceX, m_forceY;
+	std::vector<float>			m_halfX, m_halfY;		// world aligned half extents, radius for circles
+	std::vector<float>			m_sizeX, m_sizeY;
+	std::vector<float>			m_angle, m_angularVel;
+	std::vector<float>			m_gravityScale;
+	std::vector<float>			m_invMass;
+	std::vector<float>			m_density, m_friction;
+	std::vector<uint16_t>		m_categoryBits, m_maskBits;
+	std::vector<BodyType>		m_bodyType;
+	std::vector<ShapeType>		m_shapeType;
+	std::vector<PhysicsBody*>	m_owner;			// null when the handle is free
+	std::vector<BodyHandle>		m_freeHandles;
+
+	// bodies grouped by category bit, so each body only tests the categories in its mask.
+	// sorted by left edge every step, with the left edges and the widest body for the sweep
+	std::vector<BodyHandle>		m_categories[CATEGORY_COUNT];
+	std::vector<float>			m_categoryMinX[CATEGORY_COUNT];
+	float						m_categoryWidth[CATEGORY_COUNT];
+
+	// sorted pair keys of the overlapping bodies, last step and this step
+	std::vector<unsigned long long>	m_contacts;
+	std::vector<unsigned long long>	m_newContacts;
+};
@@ -0,0 +1,133 @@
+#include "GLInstanceBuffer.h"
+
+#include <algorithm>
+
+const unsigned GLInstanceBuffer::REGION_COUNT;
+
+GLInstanceBuffer::GLInstanceBuffer(GLsizeiptr stride, unsigned capacity) :
+	m_stride(stride),
+	m_persistent(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage),
+	m_buffer(0),
+	m_capacity(0),
+	m_region(0),
+	m_mappedCount(0),
+	m_mapped(nullptr),
+	m_fences()
+{
+	Allocate((std::max)(1u, capacity));
+}
+
+GLInstanceBuffer::~GLInstanceBuffer()
+{
+	Release();
+}
+
+void* GLInstanceBuffer::Map(unsigned count)
+{
+	if (count > m_capacity)
+	{
+		unsigned capacity = m_capacity;
+		while (capacity < count)
+			capacity <<= 1;
+		Release();
+		Allocate(capacity);
+	}
+
+	m_mappedCount = count;
+	if (!m_persistent)
+	{
+		return m_staging.data();
+	}
+
+	// the gpu may still read what this region held REGION_COUNT frames ago
+	WaitRegion(m_region);
+	return m_mapped + m_stride * m_capacity * m_region;
+}
+
+void GLInstanceBuffer::Unmap()
+{
+	if (m_persistent || m_mappedCount == 0)
+	{
+		return;
+	}
+
+	// orphan the storage the previous draws read, the driver hands out a fresh one
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	glBufferData(GL_ARRAY_BUFFER, m_stride * m_capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_stride * m_mappedCount, m_staging.data());
+}
+
+void GLInstanceBuffer::Fence()
+{
+	if (m_persistent)
+	{
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region = (m_region + 1) % REGION_COUNT;
+	}
+	m_mappedCount = 0;
+}
+
+GLuint GLInstanceBuffer::GetBaseInstance() const
+{
+	return m_persistent ? m_capacity * m_region : 0;
+}
+
+GLuint GLInstanceBuffer::GetBuffer() const
+{
+	return m_buffer;
+}
+
+void GLInstanceBuffer::Allocate(unsigned capacity)
+{
+	m_capacity	= capacity;
+	m_region	= 0;
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	if (m_persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, m_stride * m_capacity * REGION_COUNT, nullptr, flags);
+		m_mapped = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, m_stride * m_capacity * REGION_COUNT, flags));
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, m_stride * m_capacity, nullptr, GL_STREAM_DRAW);
+		m_staging.resize(static_cast<size_t>(m_stride * m_capacity));
+	}
+}
+
+void GLInstanceBuffer::Release()
+{
+	for (unsigned i = 0; i < REGION_COUNT; ++i)
+	{
+		WaitRegion(i);
+	}
+
+	if (m_mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		m_mapped = nullptr;
+	}
+	glDeleteBuffers(1, &m_buffer);
+	m_buffer = 0;
+}
+
+void GLInstanceBuffer::WaitRegion(unsigned region)
+{
+	GLsync& fence = m_fences[region];
+	if (!fence)
+	{
+		return;
+	}
+
+	// the first wait flushes, otherwise the fence may never be submitted
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (glClientWaitSync(fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED)
+	{
+		flags = 0;
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
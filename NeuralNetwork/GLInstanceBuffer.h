@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+// per instance vertex data written by the cpu every frame. with GL_ARB_buffer_storage the
+// buffer stays mapped and holds one region per frame in flight, each guarded by a fence;
+// without it the data is staged and the buffer orphaned on upload
+class GLInstanceBuffer
+{
+public:
+	static const unsigned REGION_COUNT = 3;
+
+	GLInstanceBuffer(GLsizeiptr stride, unsigned capacity = 1024);
+	~GLInstanceBuffer();
+
+	GLInstanceBuffer(const GLInstanceBuffer&) = delete;
+	GLInstanceBuffer& operator=(const GLInstanceBuffer&) = delete;
+
+	// room for count instances, written until Unmap. may reallocate the buffer
+	void* Map(unsigned count);
+	void Unmap();
+	// after the draws that read the mapped instances were issued
+	void Fence();
+
+	// instance index of the mapped data, for the glDraw*BaseInstance calls
+	GLuint GetBaseInstance() const;
+	// changes when the buffer grows, vertex attributes have to be pointed at it again
+	GLuint GetBuffer() const;
+
+private:
+	void Allocate(unsigned capacity);
+	void Release();
+	void WaitRegion(unsigned region);
+
+	const GLsizeiptr	m_stride;
+	const bool			m_persistent;
+	GLuint				m_buffer;
+	unsigned			m_capacity;		// instances per region
+	unsigned			m_region;		// region of the current frame
+	unsigned			m_mappedCount;
+	char*				m_mapped;		// persistent mapping of every region
+	std::vector<char>	m_staging;		// without buffer storage
+	GLsync				m_fences[REGION_COUNT];
+};
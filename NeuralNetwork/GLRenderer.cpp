@@ -1,16 +1,22 @@
 #include "GLRenderer.h"
 
 #include "Camera.h"
+#include "Profiler.h"
 #include "GLImage2D.h"
 #include "GraphicsManager.h"
 
+#include <cstddef>
+
 GLRenderer::GLRenderer(GraphicsManager& graphicsMgr) : 
-		m_graphicsMgr(graphicsMgr)
+		m_graphicsMgr(graphicsMgr),
+		m_instanceBuffer(sizeof(SpriteInstance)),
+		m_instanceAttribBuffer(0)
 {
 	m_renderShader.AddShader("Assets/BasicShader.frag", GL_FRAGMENT_SHADER);
 	m_renderShader.AddShader("Assets/BasicShader.vert", GL_VERTEX_SHADER);
 	m_renderShader.GenShaderProgram();
 	m_quadBuffer.SetupVAOs(gQuadVertices, gQuadIndices);
+	SetupInstanceAttributes();
 }
 
 GLRenderer::~GLRenderer()
@@ -45,31 +51,80 @@ void GLRenderer::AddTextureToScene(const TextureInfo & textureName, const math::
 
 void GLRenderer::RenderTextures()
 {
+	PROFILE_SCOPE("GLRenderer::RenderTextures");
+
 	m_graphicsMgr.EnableAlphaBlend();
 
 	// render...
 	m_renderShader.UseProgram();
 	m_renderShader.SetMat44("projView", m_graphicsMgr.GetMainCamera().Get2DProjection());
 
-	for (auto& image : m_models)
+	unsigned count = static_cast<unsigned>(m_models.size());
+	if (count > 0)
 	{
-		
-		float currCol = fmodf(image.m_currFrame, image.m_cols) / image.m_cols;
-		float currRow = floorf(image.m_currFrame / image.m_cols) / static_cast<float>(image.m_rows);
-
-		m_renderShader.SetMat44("model", image.m_model);
-		m_renderShader.SetVec4("textTint", image.m_tint);
-		m_renderShader.SetVec2("texcoordoffset", math::vec2(currCol, currRow));
-		m_renderShader.SetVec2("textframecount", math::vec2(image.m_cols, image.m_rows));
+		// every sprite of the frame goes to the instance buffer
+		SpriteInstance* instances = static_cast<SpriteInstance*>(m_instanceBuffer.Map(count));
+		for (unsigned i = 0; i < count; ++i)
+		{
+			const RenderModel& image = m_models[i];
+			float currCol = fmodf(image.m_currFrame, image.m_cols) / image.m_cols;
+			float currRow = floorf(image.m_currFrame / image.m_cols) / static_cast<float>(image.m_rows);
 
-		image.m_image.Bind();
+			instances[i].m_model	= image.m_model;
+			instances[i].m_tint		= image.m_tint;
+			instances[i].m_frame	= math::vec4(currCol, currRow, image.m_cols, image.m_rows);
+		}
+		m_instanceBuffer.Unmap();
 
+		if (m_instanceAttribBuffer != m_instanceBuffer.GetBuffer())
+		{
+			SetupInstanceAttributes();
+		}
 		glBindVertexArray(m_quadBuffer.m_VAO);
 
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		// sprites of a texture are submitted together, keeping the order keeps the blending right
+		GLuint baseInstance = m_instanceBuffer.GetBaseInstance();
+		for (unsigned first = 0; first < count;)
+		{
+			unsigned last = first + 1;
+			while (last < count && &m_models[last].m_image == &m_models[first].m_image)
+			{
+				++last;
+			}
+
+			m_models[first].m_image.Bind();
+			glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, last - first, baseInstance + first);
+			first = last;
+		}
+		m_instanceBuffer.Fence();
 	}
 
 	unsigned size = static_cast<unsigned>(m_models.size());
 	m_models.clear();
 	m_models.reserve(size);
 }
+
+void GLRenderer::SetupInstanceAttributes()
+{
+	glBindVertexArray(m_quadBuffer.m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.GetBuffer());
+
+	const GLsizei stride = sizeof(SpriteInstance);
+	for (GLuint row = 0; row < 4; ++row)
+	{
+		glEnableVertexAttribArray(2 + row);
+		glVertexAttribPointer(2 + row, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offsetof(SpriteInstance, m_model) + row * 4 * sizeof(float)));	// model rows
+		glVertexAttribDivisor(2 + row, 1);
+	}
+
+	glEnableVertexAttribArray(6);
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, m_tint));	// tint
+	glVertexAttribDivisor(6, 1);
+
+	glEnableVertexAttribArray(7);
+	glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, m_frame));	// texcoord offset, frame count
+	glVertexAttribDivisor(7, 1);
+
+	glBindVertexArray(0);
+	m_instanceAttribBuffer = m_instanceBuffer.GetBuffer();
+}
@@ -4,6 +4,7 @@
 #include <unordered_map>
 
 #include "GraphicsBuffers.h"
+#include "GLInstanceBuffer.h"
 #include "GLShader.h"
 #include "math.h"
 
@@ -22,6 +23,14 @@ class GLRenderer
 		math::mat4	m_model;
 	};
 
+	// vertex attributes 2 to 7 of the sprite shader, one per sprite
+	struct SpriteInstance
+	{
+		math::mat4	m_model;	// row major, one attribute per row
+		math::vec4	m_tint;
+		math::vec4	m_frame;	// texcoord offset, frame count
+	};
+
 public:
 	struct TextureInfo
 	{
@@ -35,6 +44,7 @@ public:
 	GLRenderer(GraphicsManager& graphicsMgr);
 	~GLRenderer();
 
+	// draws every sprite added this frame in submission order, one instanced draw per run of a texture
 	void RenderTextures();
 
 	// utils
@@ -42,11 +52,15 @@ public:
 	void AddTextureToScene(const TextureInfo & textureInfo, const math::vec3 & position, const math::vec3& scale, float degrees);
 
 private:
+	void SetupInstanceAttributes();
+
 	using TextureCache = std::unordered_map<std::string, std::unique_ptr<GLImage2D>>;	
 	
 	TextureCache				m_textureCache;
 	std::vector<RenderModel>	m_models;
 	GraphicsBuffers				m_quadBuffer;
+	GLInstanceBuffer			m_instanceBuffer;
+	GLuint						m_instanceAttribBuffer;	// instance buffer the quad attributes point at
 	GLShader					m_renderShader;
 	GraphicsManager&			m_graphicsMgr;
 };
\ No newline at end of file
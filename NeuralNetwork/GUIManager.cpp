@@ -12,11 +12,38 @@
 #include "ImGui/imgui_impl_glfw.h"
 #include "ImGui/imgui_impl_opengl3.h"
 
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	const char* TRACE_FILE = "profile_trace.json";
+
+	// a scope keeps its color from frame to frame
+	ImU32 GetScopeColor(const char* name)
+	{
+		unsigned hash = 2166136261u;
+		for (; *name; ++name)
+			hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+		return ImColor::HSV((hash % 360) / 360.f, 0.45f, 0.85f);
+	}
+}
+
 GUIManager::GUIManager(SceneManager & sceneMgr, AppWindow & appWin) :
 	m_sceneMgr(sceneMgr),
 	m_appWin(appWin),
-	m_isConfigSet(false)
+	m_isConfigSet(false),
+	m_showProfiler(false),
+	m_profilerPaused(false)
 {
+	// cheap enough to always record, the panel and the trace then cover the frames before they were opened
+	Profiler::SetEnabled(true);
+
+	// a new run per launch, the seed can be edited to replay one
+	m_scenConfig.m_seed = static_cast<uint64_t>(time(NULL)) & 0x7fffffff;
+
 	// imgui stuff here
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -63,6 +90,8 @@ void GUIManager::EndFrame()
 
 void GUIManager::Render()
 {
+	PROFILE_SCOPE("GUIManager::Render");
+
 	BegFrame();
 
 	if (!m_isConfigSet)
@@ -70,6 +99,9 @@ void GUIManager::Render()
 	else
 		RenderGameInfo();
 
+	if (m_isConfigSet && m_showProfiler)
+		RenderProfiler();
+
 	EndFrame();
 }
 
@@ -140,10 +172,22 @@ void GUIManager::RenderGameInfo()
 	ImGui::Text("Generation: %d",		m_sceneMgr.GetTrainingScene()->GetCurrentGeneration());
 	ImGui::Text("Birds Alive: %d/%d",	m_sceneMgr.GetTrainingScene()->GetLiveBirdCount(), m_scenConfig.m_agentCount);
 
+	if (m_scenConfig.m_islandCount > 1)
+	{
+		unsigned bestScore = 0;
+		for (auto & island : m_sceneMgr.GetIslands())
+			bestScore = max(bestScore, island->GetMaxScore());
+		ImGui::Text("Best Island Score: %d (%d islands)", bestScore, m_scenConfig.m_islandCount);
+	}
+
 	bool debugRender = m_sceneMgr.GetDebugRender();
 	ImGui::Checkbox("Debug Render", &debugRender);
 	m_sceneMgr.SetDebugRender(debugRender);
 
+	ImGui::SameLine();
+	ImGui::Checkbox("Profiler", &m_showProfiler);
+	RenderToolTip("Time spent per frame in every instrumented scope");
+
 	ImGui::End();
 }
 
@@ -156,6 +200,31 @@ void GUIManager::RenderGameConfig()
 	if (ImGui::InputInt("Agents Count", &sample, 1, 100))
 		m_scenConfig.m_agentCount = static_cast<unsigned>(max(1, sample));
 
+	int islands = static_cast<int>(m_scenConfig.m_islandCount);
+	if (ImGui::InputInt("Islands", &islands, 1, 4))
+		m_scenConfig.m_islandCount = static_cast<unsigned>(max(1, islands));
+	RenderToolTip("Independent populations trained in parallel, only the first one is rendered");
+
+	int shards = static_cast<int>(m_scenConfig.m_shardCount);
+	if (ImGui::InputInt("Shards", &shards, 1, 4))
+		m_scenConfig.m_shardCount = static_cast<unsigned>(max(1, shards));
+	RenderToolTip("Splits every generation over worker threads");
+
+	int physics = static_cast<int>(m_scenConfig.m_physicsBackend);
+	if (ImGui::Combo("Physics", &physics, "Box2D\0Flappy\0"))
+		m_scenConfig.m_physicsBackend = static_cast<PhysicsManager::BackendType>(physics);
+	RenderToolTip("Flappy only integrates and tests overlaps, every body is a sensor");
+
+	int brain = static_cast<int>(m_scenConfig.m_brainType);
+	if (ImGui::Combo("Brain", &brain, "Population\0Fixed\0"))
+		m_scenConfig.m_brainType = static_cast<TrainingShard::BrainType>(brain);
+	RenderToolTip("Fixed evaluates every bird with a network unrolled at compile time");
+
+	int seed = static_cast<int>(m_scenConfig.m_seed);
+	if (ImGui::InputInt("Seed", &seed, 1, 100))
+		m_scenConfig.m_seed = static_cast<uint64_t>(max(0, seed));
+	RenderToolTip("Runs with the same configuration and seed train the same generations");
+
 	if (ImGui::Button("Start Training"))
 	{
 		m_scenConfig.m_discreteDT = static_cast<float>(DISCRETE_DT);
@@ -163,4 +232,161 @@ void GUIManager::RenderGameConfig()
 		m_isConfigSet = true;
 	}
 	ImGui::End();
-}
\ No newline at end of file
+}
+
+void GUIManager::RenderProfiler()
+{
+	const unsigned AVERAGE_FRAMES = 30;
+
+	ImGui::SetNextWindowSize(ImVec2(640.f, 480.f), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Profiler", &m_showProfiler))
+	{
+		ImGui::End();
+		return;
+	}
+
+	bool recording = Profiler::IsEnabled();
+	if (ImGui::Checkbox("Record", &recording))
+		Profiler::SetEnabled(recording);
+
+	ImGui::SameLine();
+	ImGui::Checkbox("Pause", &m_profilerPaused);
+	RenderToolTip("Keeps the frames shown, recording goes on");
+
+	ImGui::SameLine();
+	if (ImGui::Button("Save Chrome Trace"))
+		m_traceStatus = (Profiler::Get().WriteChromeTrace(TRACE_FILE) ? "Saved " : "Could not write ") + std::string(TRACE_FILE);
+	RenderToolTip("Writes every event still recorded, open it in chrome://tracing or ui.perfetto.dev");
+
+	if (!m_traceStatus.empty())
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(m_traceStatus.c_str());
+	}
+
+	// the newest mark opened the frame in progress, only complete frames are shown
+	if (!m_profilerPaused)
+	{
+		m_profileFrames = Profiler::Get().GetFrameMarks(AVERAGE_FRAMES + 1);
+		m_profileEvents.clear();
+		if (m_profileFrames.size() >= 2)
+			m_profileEvents = Profiler::Get().Collect(m_profileFrames.front(), m_profileFrames.back());
+	}
+
+	if (m_profileFrames.size() < 2)
+	{
+		ImGui::Text("No frames recorded");
+		ImGui::End();
+		return;
+	}
+
+	unsigned frameCount	= static_cast<unsigned>(m_profileFrames.size() - 1);
+	double frameMs		= (m_profileFrames.back() - m_profileFrames.front()) * 1e-6 / frameCount;
+	ImGui::Text("Frame: %.2f ms (%.0f fps), average of %u frames", frameMs, frameMs > 0.0 ? 1000.0 / frameMs : 0.0, frameCount);
+
+	if (ImGui::CollapsingHeader("Scopes", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		struct ScopeStats
+		{
+			const char*	m_name;
+			double		m_ms;
+			unsigned	m_calls;
+		};
+
+		// summed over every thread, literals of different files may not share an address
+		std::unordered_map<const char*, ScopeStats> byAddress;
+		for (auto & thread : m_profileEvents)
+		{
+			for (auto & event : thread.m_events)
+			{
+				if (event.m_start < m_profileFrames.front())
+					continue;
+				ScopeStats& stats = byAddress.emplace(event.m_name, ScopeStats{ event.m_name, 0.0, 0 }).first->second;
+				stats.m_ms += (event.m_end - event.m_start) * 1e-6;
+				++stats.m_calls;
+			}
+		}
+
+		std::vector<ScopeStats> scopes;
+		for (auto & entry : byAddress)
+		{
+			auto it = std::find_if(scopes.begin(), scopes.end(), [&](const ScopeStats& scope) { return !strcmp(scope.m_name, entry.second.m_name); });
+			if (it == scopes.end())
+			{
+				scopes.emplace_back(entry.second);
+			}
+			else
+			{
+				it->m_ms	+= entry.second.m_ms;
+				it->m_calls	+= entry.second.m_calls;
+			}
+		}
+		std::sort(scopes.begin(), scopes.end(), [](const ScopeStats& lhs, const ScopeStats& rhs) { return lhs.m_ms > rhs.m_ms; });
+
+		// time per frame, scopes running on several threads can exceed the frame
+		for (auto & scope : scopes)
+		{
+			double ms = scope.m_ms / frameCount;
+			ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImGui::GetColorU32(GetScopeColor(scope.m_name)));
+			ImGui::ProgressBar(static_cast<float>((std::min)(1.0, ms / frameMs)), ImVec2(120.f, 0.f), "");
+			ImGui::PopStyleColor();
+			ImGui::SameLine();
+			ImGui::Text("%8.3f ms %8.1f calls  %s", ms, static_cast<double>(scope.m_calls) / frameCount, scope.m_name);
+		}
+	}
+
+	if (ImGui::CollapsingHeader("Last Frame", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		int64_t frameStart	= m_profileFrames[m_profileFrames.size() - 2];
+		int64_t frameEnd	= m_profileFrames.back();
+		ImGui::Text("%.3f ms", (frameEnd - frameStart) * 1e-6);
+		for (auto & thread : m_profileEvents)
+		{
+			RenderFlameGraph(thread, frameStart, frameEnd);
+		}
+	}
+
+	ImGui::End();
+}
+
+void GUIManager::RenderFlameGraph(const Profiler::ThreadEvents& thread, int64_t frameStart, int64_t frameEnd) const
+{
+	const float ROW_HEIGHT = ImGui::GetTextLineHeight() + 4.f;
+
+	// events are sorted by start, the ones of the frame are at the back
+	auto first = std::find_if(thread.m_events.begin(), thread.m_events.end(), [frameStart](const Profiler::Event& event) { return event.m_start >= frameStart; });
+	if (first == thread.m_events.end())
+	{
+		return;
+	}
+
+	unsigned maxDepth = 0;
+	for (auto it = first; it != thread.m_events.end(); ++it)
+	{
+		maxDepth = (std::max)(maxDepth, it->m_depth);
+	}
+
+	ImGui::TextUnformatted(thread.m_threadName.c_str());
+
+	// one row per depth, time runs from left to right over the whole frame
+	ImDrawList* drawList	= ImGui::GetWindowDrawList();
+	ImVec2 origin			= ImGui::GetCursorScreenPos();
+	float width				= (std::max)(ImGui::GetContentRegionAvail().x, 1.f);
+	double scale			= width / static_cast<double>((std::max)(frameEnd - frameStart, int64_t(1)));
+	for (auto it = first; it != thread.m_events.end(); ++it)
+	{
+		const Profiler::Event& event = *it;
+		ImVec2 topLeft(origin.x + static_cast<float>((event.m_start - frameStart) * scale), origin.y + event.m_depth * ROW_HEIGHT);
+		ImVec2 bottomRight((std::max)(origin.x + static_cast<float>((event.m_end - frameStart) * scale), topLeft.x + 1.f), topLeft.y + ROW_HEIGHT - 1.f);
+		drawList->AddRectFilled(topLeft, bottomRight, GetScopeColor(event.m_name));
+
+		// names only where they fit
+		if (bottomRight.x - topLeft.x > 24.f && ImGui::CalcTextSize(event.m_name).x + 4.f < bottomRight.x - topLeft.x)
+			drawList->AddText(ImVec2(topLeft.x + 2.f, topLeft.y + 2.f), IM_COL32(0, 0, 0, 255), event.m_name);
+
+		if (ImGui::IsMouseHoveringRect(topLeft, bottomRight))
+			ImGui::SetTooltip("%s\n%.3f ms", event.m_name, (event.m_end - event.m_start) * 1e-6);
+	}
+
+	ImGui::Dummy(ImVec2(width, (maxDepth + 1) * ROW_HEIGHT));
+}
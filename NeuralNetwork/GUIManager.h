@@ -1,7 +1,11 @@
 #pragma once
 
+#include "Profiler.h"
 #include "SceneManager.h"
 
+#include <string>
+#include <vector>
+
 class AppWindow;
 
 class GUIManager
@@ -20,9 +24,18 @@ private:
 	void RenderToolTip( const char* message )const;
 	void RenderGameInfo();
 	void RenderGameConfig();
+	void RenderProfiler();
+	void RenderFlameGraph(const Profiler::ThreadEvents& thread, int64_t frameStart, int64_t frameEnd) const;
 
 	SceneManager::ScenesConfig m_scenConfig;
 	bool			m_isConfigSet;
+
+	// profiler panel, frames kept while paused
+	bool			m_showProfiler;
+	bool			m_profilerPaused;
+	std::vector<int64_t>				m_profileFrames;
+	std::vector<Profiler::ThreadEvents>	m_profileEvents;
+	std::string		m_traceStatus;
 	AppWindow &		m_appWin;
 	SceneManager &	m_sceneMgr;
 };
\ No newline at end of file
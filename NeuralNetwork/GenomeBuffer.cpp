@@ -0,0 +1,53 @@
+#include "GenomeBuffer.h"
+
+#include <cassert>
+
+GenomeBuffer::GenomeBuffer(unsigned rowCount, unsigned genomeSize) :
+	m_rowCount(rowCount),
+	m_genomeSize(genomeSize),
+	m_front(0)
+{
+	for (auto & buffer : m_buffers)
+	{
+		buffer.resize(static_cast<size_t>(rowCount) * genomeSize, 0.f);
+	}
+}
+
+fann_type* GenomeBuffer::GetFront(unsigned row)
+{
+	assert(row < m_rowCount);
+	return &m_buffers[m_front][static_cast<size_t>(row) * m_genomeSize];
+}
+
+const fann_type* GenomeBuffer::GetFront(unsigned row) const
+{
+	assert(row < m_rowCount);
+	return &m_buffers[m_front][static_cast<size_t>(row) * m_genomeSize];
+}
+
+fann_type* GenomeBuffer::GetBack(unsigned row)
+{
+	assert(row < m_rowCount);
+	return &m_buffers[m_front ^ 1][static_cast<size_t>(row) * m_genomeSize];
+}
+
+const fann_type* GenomeBuffer::GetBack(unsigned row) const
+{
+	assert(row < m_rowCount);
+	return &m_buffers[m_front ^ 1][static_cast<size_t>(row) * m_genomeSize];
+}
+
+void GenomeBuffer::Swap()
+{
+	m_front ^= 1;
+}
+
+unsigned GenomeBuffer::GetRowCount() const
+{
+	return m_rowCount;
+}
+
+unsigned GenomeBuffer::GetGenomeSize() const
+{
+	return m_genomeSize;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "FANN/fann.h"
+
+#include <vector>
+
+// two genome matrices with one contiguous row per agent. the front holds the genomes
+// of the running generation, the next generation is bred into the back, then Swap.
+// after a swap the back holds the previous generation until the next breeding
+class GenomeBuffer
+{
+public:
+	GenomeBuffer(unsigned rowCount, unsigned genomeSize);
+
+	fann_type* GetFront(unsigned row);
+	const fann_type* GetFront(unsigned row) const;
+	fann_type* GetBack(unsigned row);
+	const fann_type* GetBack(unsigned row) const;
+
+	void Swap();
+
+	unsigned GetRowCount() const;
+	unsigned GetGenomeSize() const;
+
+private:
+	unsigned				m_rowCount;
+	unsigned				m_genomeSize;
+	unsigned				m_front;
+	std::vector<fann_type>	m_buffers[2];
+};
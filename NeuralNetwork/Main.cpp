@@ -1,5 +1,6 @@
 #include "Camera.h"
 #include "AppWindow.h"
+#include "Profiler.h"
 #include "GUIManager.h"
 #include "GLRenderer.h"
 #include "DebugDrawer.h"
@@ -20,8 +21,6 @@
 
 int main()
 {
-	srand(static_cast<unsigned>(time(NULL)));
-
 	AppWindow mainWin;
 
 	const unsigned	winWidth = 1280, winHeight = 720;
@@ -38,14 +37,17 @@ int main()
 	graphicsMgr.SetBackgroundColor(math::vec4(0.15f, 0.15f, 0.15f, 1.f));
 
 	// scene manager
-	SceneManager sceneMgr{ graphicsMgr };
+	SceneManager sceneMgr;
 
 	// gui creation
 	GUIManager guiMgr{ sceneMgr, mainWin };
 
+	Profiler::Get().SetThreadName("Main");
+
 	while (!mainWin.ShouldClose())
 	{
 		auto time_start = std::chrono::high_resolution_clock::now();
+		Profiler::Get().MarkFrame();
 
 		// fps measuring 
 		mainWin.BeginFrame();
@@ -59,17 +61,27 @@ int main()
 		graphicsMgr.SetViewport(0, 0, winWd, winHt);
 
 		// updating here
-		float fdt = static_cast<float>(DISCRETE_DT);
-		mainWin.Update();
-		sceneMgr.Update(fdt);
-		guiMgr.Update(fdt);
+		{
+			PROFILE_SCOPE("Update");
+			float fdt = static_cast<float>(DISCRETE_DT);
+			mainWin.Update();
+			sceneMgr.Update(fdt);
+			guiMgr.Update(fdt);
+		}
 
 		// rendering here
-		graphicsMgr.Render();
-		guiMgr.Render();
+		{
+			PROFILE_SCOPE("Render");
+			sceneMgr.Render(graphicsMgr);
+			graphicsMgr.Render();
+			guiMgr.Render();
+		}
 
 		mainWin.PollEvent();
-		mainWin.SwapBuffers();
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			mainWin.SwapBuffers();
+		}
 
 		graphicsMgr.EndFrame();
 
@@ -0,0 +1,81 @@
+#include "ObstacleQueue.h"
+
+#include "PhysicsBody.h"
+
+float ObstacleQueue::Obstacle::GetHoleY() const
+{
+	return 0.5f * (m_lower->GetPosition().y + m_upper->GetPosition().y);
+}
+
+float ObstacleQueue::Obstacle::GetX() const
+{
+	return (m_lower ? m_lower : m_upper)->GetPosition().x;
+}
+
+float ObstacleQueue::Obstacle::GetFrontX() const
+{
+	const PhysicsBody& body = *(m_lower ? m_lower : m_upper);
+	return body.GetPosition().x + body.GetSize().x * 0.5f;
+}
+
+ObstacleQueue::ObstacleQueue() :
+	m_cursor(0)
+{
+}
+
+void ObstacleQueue::Push(std::shared_ptr<PhysicsBody> lower, std::shared_ptr<PhysicsBody> upper)
+{
+	Obstacle obstacle;
+	obstacle.m_lower = std::move(lower);
+	obstacle.m_upper = std::move(upper);
+	m_obstacles.emplace_back(std::move(obstacle));
+}
+
+bool ObstacleQueue::Remove(const PhysicsBody* body)
+{
+	// poles leave from the left, the match is almost always the front pair
+	for (auto it = m_obstacles.begin(); it != m_obstacles.end(); ++it)
+	{
+		if (it->m_lower.get() == body)
+			it->m_lower.reset();
+		else if (it->m_upper.get() == body)
+			it->m_upper.reset();
+		else
+			continue;
+
+		if (!it->m_lower && !it->m_upper)
+		{
+			size_t index = it - m_obstacles.begin();
+			m_obstacles.erase(it);
+			if (index < m_cursor)
+				--m_cursor;
+		}
+		return true;
+	}
+	return false;
+}
+
+void ObstacleQueue::Clear()
+{
+	m_obstacles.clear();
+	m_cursor = 0;
+}
+
+void ObstacleQueue::Advance(float x)
+{
+	while (m_cursor < m_obstacles.size() && m_obstacles[m_cursor].GetFrontX() <= x)
+	{
+		++m_cursor;
+	}
+}
+
+const ObstacleQueue::Obstacle* ObstacleQueue::GetNearest(unsigned k) const
+{
+	size_t index = m_cursor + k;
+	return index < m_obstacles.size() ? &m_obstacles[index] : nullptr;
+}
+
+const std::deque<ObstacleQueue::Obstacle>& ObstacleQueue::GetAll() const
+{
+	return m_obstacles;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+
+class PhysicsBody;
+
+// obstacles of a shard ordered by x. obstacles spawn on the right and all move left at
+// the same speed, so spawn order is x order: pairs are pushed at the back and leave from
+// the front. the first pair still ahead of the birds is tracked by a cursor that only
+// moves forward, so nearest queries are O(1) instead of a scan over every body
+class ObstacleQueue
+{
+public:
+	struct Obstacle
+	{
+		std::shared_ptr<PhysicsBody>	m_lower;	// null once destroyed
+		std::shared_ptr<PhysicsBody>	m_upper;
+
+		// centre of the hole between the two poles
+		float GetHoleY() const;
+		// x of the pair, both poles share it
+		float GetX() const;
+		float GetFrontX() const;
+	};
+
+	ObstacleQueue();
+
+	void Push(std::shared_ptr<PhysicsBody> lower, std::shared_ptr<PhysicsBody> upper);
+	// forgets one pole, the pair leaves the queue once both are gone.
+	// returns false when the body is not an obstacle of this queue
+	bool Remove(const PhysicsBody* body);
+	void Clear();
+
+	// moves the cursor past the pairs whose front edge is behind x
+	void Advance(float x);
+	// k-th pair ahead of the last Advance, null when there is none
+	const Obstacle* GetNearest(unsigned k) const;
+
+	const std::deque<Obstacle>& GetAll() const;
+
+private:
+	std::deque<Obstacle>	m_obstacles;
+	size_t					m_cursor;	// first pair ahead of the birds
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "math.h"
+
+#include <cstdint>
+
+class PhysicsBody;
+class PhysicsContactListener;
+
+// storage and simulation of the bodies owned by a PhysicsManager.
+// positions, sizes and velocities are in world units (pixels), angles in degrees.
+// contacts are reported to the listener with the owners given at creation.
+class PhysicsBackend
+{
+public:
+	using BodyHandle = unsigned;
+
+	enum class BodyType
+	{
+		STATIC,
+		KINEMATIC,
+		DYNAMIC
+	};
+
+	enum class ShapeType
+	{
+		CIRCLE,
+		BOX
+	};
+
+	struct BodyDef
+	{
+		math::vec2		m_position;
+		math::vec2		m_size;			// box extents, circle diameter
+		float			m_angle;
+		BodyType		m_bodyType;
+		ShapeType		m_shapeType;
+		PhysicsBody*	m_owner;
+	};
+
+	virtual ~PhysicsBackend() {}
+
+	virtual void Step(float dt, int velocityIter, int positionIter) = 0;
+
+	virtual BodyHandle CreateBody(const BodyDef& def) = 0;
+	// contacts the body still has are reported as ended
+	virtual void DestroyBody(BodyHandle body) = 0;
+	// takes the body out of the simulation but keeps it and its shape for ResetBody,
+	// contacts the body still has are reported as ended
+	virtual void DisableBody(BodyHandle body) = 0;
+	// puts a disabled body back in the state CreateBody gives it, def has the size it was created with
+	virtual void ResetBody(BodyHandle body, const BodyDef& def) = 0;
+
+	virtual math::vec2 GetPosition(BodyHandle body) const = 0;
+	virtual float GetAngle(BodyHandle body) const = 0;
+	virtual math::vec2 GetVelocity(BodyHandle body) const = 0;
+	virtual float GetGravityScale(BodyHandle body) const = 0;
+	virtual float GetFriction(BodyHandle body) const = 0;
+
+	virtual void SetVelocity(BodyHandle body, const math::vec2& velocity) = 0;
+	virtual void SetGravityScale(BodyHandle body, float scale) = 0;
+	virtual void SetFriction(BodyHandle body, float friction) = 0;
+	virtual void SetDensity(BodyHandle body, float density) = 0;
+	virtual void SetSensor(BodyHandle body, bool set) = 0;
+	virtual void SetFilter(BodyHandle body, uint16_t categoryBits, uint16_t maskBits) = 0;
+
+	// force in physics units (kg m/s^2), same as Box2D
+	virtual void ApplyForceToCenter(BodyHandle body, const math::vec2& force) = 0;
+	virtual void AddAngularVelocity(BodyHandle body, float radians) = 0;
+
+protected:
+	PhysicsBackend(PhysicsContactListener& listener) : m_listener(listener) {}
+
+	PhysicsContactListener& m_listener;
+};
@@ -1,10 +1,19 @@
 #include "PhysicsBody.h"
+#include "DebugColors.h"
+#include "PhysicsContactListener.h"
 #include "PhysicsManager.h"
-#include "DebugDrawer.h"
 
-PhysicsBody::PhysicsBody(b2Body * body) :
-	m_body(body),
-	m_name("Default"),
+#include <cassert>
+
+PhysicsBody::PhysicsBody(PhysicsBackend& backend, PhysicsBackend::ShapeType shape) :
+	m_manager(nullptr),
+	m_id{ 0, 0 },
+	m_backend(&backend),
+	m_handle(0),
+	m_shapeType(shape),
+	m_bodyType(PhysicsBackend::BodyType::STATIC),
+	m_typeId(0),
+	m_owner(0),
 	m_destroyed(false),
 	m_categoryBits(0x0001),
 	m_maskBits(0xFFFF),
@@ -16,78 +25,58 @@ PhysicsBody::PhysicsBody(b2Body * body) :
 
 void PhysicsBody::AddForceToCenter(const math::vec2 & force)
 {
-	m_body->ApplyForceToCenter(b2Vec2(force.x, force.y), true);
+	m_backend->ApplyForceToCenter(m_handle, force);
 }
 
 void PhysicsBody::AddAngularImpulse(float degree)
 {
-	m_body->ApplyAngularImpulse(DEG_TO_RAD(-degree) * m_body->GetInertia(), true);
+	m_backend->AddAngularVelocity(m_handle, DEG_TO_RAD(-degree));
 }
 
-void PhysicsBody::SetName(const std::string& name)
+void PhysicsBody::SetTypeId(uint8_t typeId)
 {
-	m_name = name;
+	assert(typeId < PhysicsContactListener::MAX_BODY_TYPES);
+	m_typeId = typeId;
+}
+
+void PhysicsBody::SetOwner(uint32_t owner)
+{
+	m_owner = owner;
 }
 
 void PhysicsBody::SetFriction(float friction)
 {
-	b2Fixture * fixtures = m_body->GetFixtureList();
-	while (fixtures)
-	{
-		fixtures->SetFriction(friction);
-		fixtures = fixtures->GetNext();
-	}
+	m_backend->SetFriction(m_handle, friction);
 }
 
 void PhysicsBody::SetGravityScale(float set)
 {
-	m_body->SetGravityScale(set);
+	m_backend->SetGravityScale(m_handle, set);
 }
 
 void PhysicsBody::SetDensity(float set)
 {
-	b2Fixture * fixtures = m_body->GetFixtureList();
-	while (fixtures)
-	{
-		fixtures->SetDensity(set);
-		fixtures = fixtures->GetNext();
-	}
-	m_body->ResetMassData();
+	m_backend->SetDensity(m_handle, set);
 }
 
-void PhysicsBody::SetCategoryBits(uint16 bits)
+void PhysicsBody::SetCategoryBits(uint16_t bits)
 {
 	SetFilterBits(bits, m_maskBits);
 }
 
-void PhysicsBody::SetMaskBits(uint16 bits)
+void PhysicsBody::SetMaskBits(uint16_t bits)
 {
 	SetFilterBits(m_categoryBits, bits);
 }
 
 void PhysicsBody::SetIsSensor(bool set)
 {
-	b2Fixture * fixtures = m_body->GetFixtureList();
-	while (fixtures)
-	{
-		fixtures->SetSensor(set);
-		fixtures = fixtures->GetNext();
-	}
+	m_backend->SetSensor(m_handle, set);
 }
 
-void PhysicsBody::SetFilterBits(uint16 categoryBits, uint16 maskBits)
+void PhysicsBody::SetFilterBits(uint16_t categoryBits, uint16_t maskBits)
 {
-	b2Fixture * fixture = m_body->GetFixtureList();
-	while (fixture)
-	{
-		b2Filter filter;
-		filter.groupIndex	= 0;
-		filter.categoryBits = categoryBits;
-		filter.maskBits		= maskBits;
-
-		fixture->SetFilterData(filter);
-		fixture = fixture->GetNext();
-	}
+	m_backend->SetFilter(m_handle, categoryBits, maskBits);
 
 	m_maskBits		= maskBits;
 	m_categoryBits	= categoryBits;
@@ -95,7 +84,7 @@ void PhysicsBody::SetFilterBits(uint16 categoryBits, uint16 maskBits)
 
 void PhysicsBody::SetVelocity(const math::vec2& velocity)
 {
-	m_body->SetLinearVelocity(b2Vec2(velocity.x * PhysicsManager::INV_BOX2D_SCALE_FACTOR, velocity.y * PhysicsManager::INV_BOX2D_SCALE_FACTOR));
+	m_backend->SetVelocity(m_handle, velocity);
 }
 
 void PhysicsBody::SetUserData(void * data)
@@ -115,38 +104,47 @@ void PhysicsBody::SetDebugColor(const math::vec4& color)
 
 void PhysicsBody::Destroy()
 {
+	// a body already removed from its manager has nothing left to destroy
+	bool queue = !m_destroyed && m_backend;
 	m_destroyed = true;
+	if (queue)
+		m_manager->MarkDestroyed(m_id);
 }
 
 // gettors
-const std::string & PhysicsBody::GetName() const 
+uint8_t PhysicsBody::GetTypeId() const
+{
+	return m_typeId;
+}
+
+uint32_t PhysicsBody::GetOwner() const
 {
-	return m_name;
+	return m_owner;
+}
+
+SlotMapHandle PhysicsBody::GetId() const
+{
+	return m_id;
 }
 
 float PhysicsBody::GetFriction() const
 {
-	b2Fixture * fixtures = m_body->GetFixtureList();
-	if (fixtures)
-		return fixtures->GetDensity();
-	else
-		return 0.f;
+	return m_backend->GetFriction(m_handle);
 }
 
 float PhysicsBody::GetGravityScale() const
 {
-	return m_body->GetGravityScale();
+	return m_backend->GetGravityScale(m_handle);
 }
 
 float PhysicsBody::GetAngle() const
 {
-	return RAD_TO_DEG(m_body->GetAngle());
+	return m_backend->GetAngle(m_handle);
 }
 
 math::vec2 PhysicsBody::GetPosition() const
 {
-	b2Vec2 pos = m_body->GetPosition();
-	return math::vec2(pos.x, pos.y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+	return m_backend->GetPosition(m_handle);
 }
 
 math::vec2 PhysicsBody::GetSize() const
@@ -156,8 +154,12 @@ math::vec2 PhysicsBody::GetSize() const
 
 math::vec2 PhysicsBody::GetVelocity() const
 {
-	b2Vec2 spd = m_body->GetLinearVelocity();
-	return math::vec2(spd.x, spd.y) * PhysicsManager::BOX2D_SCALE_FACTOR;
+	return m_backend->GetVelocity(m_handle);
+}
+
+PhysicsBackend::ShapeType PhysicsBody::GetShapeType() const
+{
+	return m_shapeType;
 }
 
 void* PhysicsBody::GetUserData() const
@@ -1,28 +1,32 @@
 #pragma once
 
-#include "Box2D/box2d.h"
+#include "PhysicsBackend.h"
+#include "SlotMap.h"
 #include "math.h"
 
-#include <string>
+#include <cstdint>
+
+class PhysicsManager;
 
 class PhysicsBody
 {
 public:
-	PhysicsBody(b2Body * body);
+	PhysicsBody(PhysicsBackend& backend, PhysicsBackend::ShapeType shape);
 
 	// manipulators
 	void AddForceToCenter(const math::vec2 & force);
 	void AddAngularImpulse(float degree);
 
 	// settors
-	void SetName(const std::string& name);
+	void SetTypeId(uint8_t typeId);
+	void SetOwner(uint32_t owner);
 	void SetFriction(float friction);
 	void SetGravityScale(float set);
 	void SetDensity(float set);
-	void SetCategoryBits(uint16 bits);
-	void SetMaskBits(uint16 bits);
+	void SetCategoryBits(uint16_t bits);
+	void SetMaskBits(uint16_t bits);
 	void SetIsSensor(bool set);
-	void SetFilterBits(uint16 categoryBits, uint16 maskBits);
+	void SetFilterBits(uint16_t categoryBits, uint16_t maskBits);
 	void SetVelocity(const math::vec2& velocity);
 	void SetUserData(void * data);
 	void SetDebugFill(bool set);
@@ -30,13 +34,16 @@ public:
 	void Destroy();
 
 	// gettors
-	const std::string & GetName() const;
+	uint8_t GetTypeId() const;
+	uint32_t GetOwner() const;
+	SlotMapHandle GetId() const;
 	float GetFriction() const;
 	float GetGravityScale() const;
 	float GetAngle() const;
 	math::vec2 GetPosition() const;
 	math::vec2 GetSize() const;
 	math::vec2 GetVelocity() const;
+	PhysicsBackend::ShapeType GetShapeType() const;
 	void* GetUserData() const;
 	bool IsDestroyed() const;
 	bool GetDebugFill() const;
@@ -44,13 +51,19 @@ public:
 private:
 	friend class PhysicsManager;
 
-	uint16		m_categoryBits;
-	uint16		m_maskBits;
+	uint16_t	m_categoryBits;
+	uint16_t	m_maskBits;
 
-	bool		m_destroyed;
-	b2Body *	m_body;
-	std::string	m_name;
-	math::vec2	m_scale;
+	bool						m_destroyed;
+	PhysicsManager *			m_manager;
+	SlotMapHandle				m_id;		// in the body map of m_manager
+	PhysicsBackend *			m_backend;	// nullptr once removed from the world
+	PhysicsBackend::BodyHandle	m_handle;
+	PhysicsBackend::ShapeType	m_shapeType;
+	PhysicsBackend::BodyType	m_bodyType;
+	uint8_t						m_typeId;	// picks the contact handlers, see PhysicsContactListener
+	uint32_t					m_owner;	// index of the body in the structure of its user
+	math::vec2					m_scale;
 
 	void*		m_userData;
 	bool		m_debugFill;
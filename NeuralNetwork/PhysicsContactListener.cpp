@@ -1,40 +1,173 @@
 #include "PhysicsContactListener.h"
 #include "PhysicsBody.h"
-PhysicsContactListener::PhysicsContactListener()
+#include "Profiler.h"
+
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+PhysicsContactListener::PhysicsContactListener() :
+	m_deferred(false),
+	m_manifoldsRequired(true)
 {
 
 }
 
-void PhysicsContactListener::BeginContact(b2Contact* contact)
+void PhysicsContactListener::BeginContact(const ContactInfo& info)
 {
-	if(m_begContactFnc)
-		(*m_begContactFnc)(GetContactInfo(contact));
+	if (m_deferred)
+		Queue(m_begHandlers, info, true);
+	else
+		Dispatch(m_begHandlers, m_begContactFnc, info);
 }
 
-void PhysicsContactListener::EndContact(b2Contact* contact)
+void PhysicsContactListener::EndContact(const ContactInfo& info)
 {
-	if(m_endContactFnc)
-		(*m_endContactFnc)(GetContactInfo(contact));
+	if (m_deferred)
+		Queue(m_endHandlers, info, false);
+	else
+		Dispatch(m_endHandlers, m_endContactFnc, info);
 }
 
 void PhysicsContactListener::ClearListenerFunctions()
 {
 	m_begContactFnc.reset();
 	m_endContactFnc.reset();
+	m_begHandlers.fill(Handler());
+	m_endHandlers.fill(Handler());
+	m_events.clear();
+}
+
+void PhysicsContactListener::SetDeferred(bool set)
+{
+	// nothing queued may be lost when switching back
+	Flush();
+	m_deferred = set;
+}
+
+bool PhysicsContactListener::IsDeferred() const
+{
+	return m_deferred;
+}
+
+void PhysicsContactListener::Reserve(unsigned contactCount)
+{
+	m_events.reserve(contactCount);
+	m_batch.reserve(contactCount);
 }
 
-ContactInfo PhysicsContactListener::GetContactInfo(b2Contact* contact)
+void PhysicsContactListener::Flush()
 {
-	b2WorldManifold manifold;
-	contact->GetWorldManifold(&manifold);
+	if (m_events.empty())
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("PhysicsContactListener::Flush");
+
+	// contacts of a pair become one run, ordered by owners so that every backend hands
+	// them over the same way and repeated contacts of a body are next to each other
+	std::sort(m_events.begin(), m_events.end(), [](const Event& lhs, const Event& rhs)
+	{
+		if (lhs.m_key != rhs.m_key)
+			return lhs.m_key < rhs.m_key;
+		if (lhs.m_info.m_bodyA->GetOwner() != rhs.m_info.m_bodyA->GetOwner())
+			return lhs.m_info.m_bodyA->GetOwner() < rhs.m_info.m_bodyA->GetOwner();
+		if (lhs.m_info.m_bodyB->GetOwner() != rhs.m_info.m_bodyB->GetOwner())
+			return lhs.m_info.m_bodyB->GetOwner() < rhs.m_info.m_bodyB->GetOwner();
+		return lhs.m_sequence < rhs.m_sequence;
+	});
+
+	const unsigned tableSize = MAX_BODY_TYPES * MAX_BODY_TYPES;
+	for (size_t first = 0; first < m_events.size();)
+	{
+		unsigned key = m_events[first].m_key;
+
+		m_batch.clear();
+		size_t last = first;
+		for (; last < m_events.size() && m_events[last].m_key == key; ++last)
+		{
+			m_batch.emplace_back(m_events[last].m_info);
+		}
 
-	ContactInfo info;
-	info.m_bodyA = reinterpret_cast<PhysicsBody*>(contact->GetFixtureA()->GetBody()->GetUserData());
-	info.m_bodyB = reinterpret_cast<PhysicsBody*>(contact->GetFixtureB()->GetBody()->GetUserData());
-	info.m_isTouching = contact->IsTouching();
-	info.m_contactWorldNormal = math::vec2(manifold.normal.x, manifold.normal.y);
-	info.m_contactWorldPoints[0] = math::vec2(manifold.points[0].x, manifold.points[0].y);
-	info.m_contactWorldPoints[1] = math::vec2(manifold.points[1].x, manifold.points[1].y);
+		bool begin = key >= tableSize;
+		const Handler& handler = (begin ? m_begHandlers : m_endHandlers)[key % tableSize];
+		const std::unique_ptr<Concept>& fallback = begin ? m_begContactFnc : m_endContactFnc;
+		if (handler.m_function)
+			(*handler.m_function)(m_batch.data(), static_cast<unsigned>(m_batch.size()));
+		else if (fallback)
+			(*fallback)(m_batch.data(), static_cast<unsigned>(m_batch.size()));
 
-	return info;
-}
\ No newline at end of file
+		first = last;
+	}
+
+	m_events.clear();
+}
+
+void PhysicsContactListener::SetManifoldsRequired(bool set)
+{
+	m_manifoldsRequired = set;
+}
+
+bool PhysicsContactListener::AreManifoldsRequired() const
+{
+	return m_manifoldsRequired;
+}
+
+void PhysicsContactListener::SetHandler(HandlerTable& table, uint8_t typeA, uint8_t typeB, std::shared_ptr<Concept> fnc)
+{
+	assert(typeA < MAX_BODY_TYPES && typeB < MAX_BODY_TYPES);
+
+	Handler& mirror		= table[typeB * MAX_BODY_TYPES + typeA];
+	mirror.m_function	= fnc;
+	mirror.m_swapBodies	= typeA != typeB;
+
+	Handler& handler	= table[typeA * MAX_BODY_TYPES + typeB];
+	handler.m_function	= std::move(fnc);
+	handler.m_swapBodies	= false;
+}
+
+void PhysicsContactListener::Queue(const HandlerTable& table, const ContactInfo& info, bool begin)
+{
+	unsigned index = info.m_bodyA->GetTypeId() * MAX_BODY_TYPES + info.m_bodyB->GetTypeId();
+
+	Event event;
+	event.m_info		= info;
+	event.m_sequence	= static_cast<unsigned>(m_events.size());
+
+	// stored the way the handler expects the bodies, so a run can be handed over as is
+	if (table[index].m_function && table[index].m_swapBodies)
+	{
+		event.m_info.m_bodyA				= info.m_bodyB;
+		event.m_info.m_bodyB				= info.m_bodyA;
+		event.m_info.m_contactWorldNormal	= -info.m_contactWorldNormal;
+		index = info.m_bodyB->GetTypeId() * MAX_BODY_TYPES + info.m_bodyA->GetTypeId();
+	}
+	event.m_key = begin ? index + MAX_BODY_TYPES * MAX_BODY_TYPES : index;
+
+	m_events.emplace_back(event);
+}
+
+void PhysicsContactListener::Dispatch(const HandlerTable& table, const std::unique_ptr<Concept>& fallback, const ContactInfo& info)
+{
+	const Handler& handler = table[info.m_bodyA->GetTypeId() * MAX_BODY_TYPES + info.m_bodyB->GetTypeId()];
+	if (!handler.m_function)
+	{
+		if (fallback)
+			(*fallback)(info);
+		return;
+	}
+
+	if (!handler.m_swapBodies)
+	{
+		(*handler.m_function)(info);
+		return;
+	}
+
+	// present the bodies in the order the handler was registered with
+	ContactInfo swapped			= info;
+	swapped.m_bodyA				= info.m_bodyB;
+	swapped.m_bodyB				= info.m_bodyA;
+	swapped.m_contactWorldNormal	= -info.m_contactWorldNormal;
+	(*handler.m_function)(swapped);
+}
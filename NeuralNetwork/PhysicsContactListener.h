@@ -1,8 +1,12 @@
 #pragma once
 
-#include "Box2D/box2d.h"
 #include "math.h"
 
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
 class PhysicsBody;
 
 struct ContactInfo
@@ -14,11 +18,19 @@ struct ContactInfo
 	bool			m_isTouching;
 };
 
-class PhysicsContactListener : public b2ContactListener
+class PhysicsContactListener
 {
 	struct Concept
 	{
+		virtual ~Concept() {}
 		virtual void operator()(const ContactInfo& info) = 0;
+
+		// contacts of the same type pair, queued during one step
+		virtual void operator()(const ContactInfo* infos, unsigned count)
+		{
+			for (unsigned i = 0; i < count; ++i)
+				(*this)(infos[i]);
+		}
 	};
 
 	template<typename ... Args>
@@ -37,27 +49,122 @@ class PhysicsContactListener : public b2ContactListener
 		}
 	};
 
+	template<typename F, typename C>
+	struct BatchModel : Concept
+	{
+		BatchModel(F f, C c) : m_function(f), m_fncClass(c) {}
+
+		F m_function;
+		C m_fncClass;
+		void operator()(const ContactInfo& info)
+		{
+			(m_fncClass->*m_function)(&info, 1);
+		}
+		void operator()(const ContactInfo* infos, unsigned count)
+		{
+			(m_fncClass->*m_function)(infos, count);
+		}
+	};
+
+	// entry of the dispatch table, the pair (a, b) and its mirror (b, a) share the function
+	struct Handler
+	{
+		std::shared_ptr<Concept>	m_function;
+		bool						m_swapBodies;
+	};
+
 public:
+	// body type ids are below this, see PhysicsBody::SetTypeId
+	static const unsigned MAX_BODY_TYPES = 16;
+
 	PhysicsContactListener();
 
+	// handlers of contacts between bodies of typeA and typeB, bodyA of the info is always the
+	// one of typeA. a contact with a handler skips the callback functions below
+	template<typename F, typename C> void SetBeginContactHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass);
+	template<typename F, typename C> void SetEndContactHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass);
+
+	// same, fnc(const ContactInfo* infos, unsigned count) receives all contacts of the pair
+	// queued in a step at once when deferred, one at a time otherwise
+	template<typename F, typename C> void SetBeginContactBatchHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass);
+	template<typename F, typename C> void SetEndContactBatchHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass);
+
 	template<typename F, typename C> void SetBeginContactCallbackFunction(F fnc, C fncClass);
 	template<typename F, typename C> void SetEndContactCallbackFunction(F fnc, C fncClass);
 	template<typename F> void SetBeginContactCallbackFunction(F fnc);
 	template<typename F> void SetEndContactCallbackFunction(F fnc);
 	void ClearListenerFunctions();
 
-	// Called when two fixtures begin to touch
-	virtual void BeginContact(b2Contact* contact);
+	// deferred contacts are queued during the step and handled by Flush, sorted by type pair
+	// and owners, so the handlers never run inside the backend. bodies destroyed in the same
+	// update only have their type id and owner valid in the end contacts of their removal
+	void SetDeferred(bool set);
+	bool IsDeferred() const;
+	// preallocates the queue, its size is the most contacts expected in one step
+	void Reserve(unsigned contactCount);
+	// handles the queued contacts, called by PhysicsManager after each step
+	void Flush();
+
+	// without manifolds the backends leave the normal and points of the contacts zero
+	void SetManifoldsRequired(bool set);
+	bool AreManifoldsRequired() const;
+
+	// Called by the physics backend when two bodies begin to touch
+	void BeginContact(const ContactInfo& info);
 
-	// Called when two fixtures cease to touch
-	virtual void EndContact(b2Contact* contact);
+	// Called by the physics backend when two bodies cease to touch
+	void EndContact(const ContactInfo& info);
 
 private:
-	ContactInfo GetContactInfo(b2Contact* contact);
-	std::unique_ptr<Concept> m_begContactFnc;
-	std::unique_ptr<Concept> m_endContactFnc;
+	using HandlerTable = std::array<Handler, MAX_BODY_TYPES * MAX_BODY_TYPES>;
+
+	static void SetHandler(HandlerTable& table, uint8_t typeA, uint8_t typeB, std::shared_ptr<Concept> fnc);
+	static void Dispatch(const HandlerTable& table, const std::unique_ptr<Concept>& fallback, const ContactInfo& info);
+
+	struct Event
+	{
+		ContactInfo		m_info;			// bodies in the order of the handler
+		unsigned		m_key;			// table index, ends sort before begins
+		unsigned		m_sequence;
+	};
+
+	void Queue(const HandlerTable& table, const ContactInfo& info, bool begin);
+
+	HandlerTable				m_begHandlers;	// [typeA * MAX_BODY_TYPES + typeB]
+	HandlerTable				m_endHandlers;
+	std::unique_ptr<Concept>	m_begContactFnc;
+	std::unique_ptr<Concept>	m_endContactFnc;
+
+	bool						m_deferred;
+	bool						m_manifoldsRequired;
+	std::vector<Event>			m_events;
+	std::vector<ContactInfo>	m_batch;
 };
 
+template<typename F, typename C>
+void PhysicsContactListener::SetBeginContactHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass)
+{
+	SetHandler(m_begHandlers, typeA, typeB, std::make_shared<Model<F, C>>(fnc, fncClass));
+}
+
+template<typename F, typename C>
+void PhysicsContactListener::SetEndContactHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass)
+{
+	SetHandler(m_endHandlers, typeA, typeB, std::make_shared<Model<F, C>>(fnc, fncClass));
+}
+
+template<typename F, typename C>
+void PhysicsContactListener::SetBeginContactBatchHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass)
+{
+	SetHandler(m_begHandlers, typeA, typeB, std::make_shared<BatchModel<F, C>>(fnc, fncClass));
+}
+
+template<typename F, typename C>
+void PhysicsContactListener::SetEndContactBatchHandler(uint8_t typeA, uint8_t typeB, F fnc, C fncClass)
+{
+	SetHandler(m_endHandlers, typeA, typeB, std::make_shared<BatchModel<F, C>>(fnc, fncClass));
+}
+
 template<typename F, typename C>
 void PhysicsContactListener::SetBeginContactCallbackFunction(F fnc, C fncClass)
 {
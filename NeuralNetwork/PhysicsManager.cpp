@@ -1,23 +1,31 @@
 #include "PhysicsManager.h"
 
 #include "PhysicsContactListener.h"
-#include "DebugDrawer.h"
 #include "PhysicsBody.h"
+#include "Profiler.h"
+#include "Box2DPhysicsBackend.h"
+#include "FlappyPhysicsBackend.h"
+
+#ifndef NN_HEADLESS
+#include "DebugDrawer.h"
+#endif
 
 const float PhysicsManager::BOX2D_SCALE_FACTOR = 50.f;
 const float PhysicsManager::INV_BOX2D_SCALE_FACTOR = 1.f / PhysicsManager::BOX2D_SCALE_FACTOR;
 
-b2Vec2 operator*(const b2Vec2 & rhs, float scalar)
-{
-	return b2Vec2(rhs.x * scalar, rhs.y * scalar);
-}
-
-PhysicsManager::PhysicsManager(const math::vec2 & gravity, DebugDrawer& debugDrawer) :
-		m_world(std::make_unique<b2World>(b2Vec2(gravity.x, gravity.y))),
-		m_debugDrawer(debugDrawer),
+PhysicsManager::PhysicsManager(const math::vec2 & gravity, BackendType backendType) :
+		m_backendType(backendType),
 		m_listener(std::make_unique<PhysicsContactListener>())
 {
-	m_world->SetContactListener(&(*m_listener));
+	switch (backendType)
+	{
+	case BackendType::BOX2D:
+		m_backend = std::make_unique<Box2DPhysicsBackend>(gravity * BOX2D_SCALE_FACTOR, *m_listener);
+		break;
+	case BackendType::FLAPPY:
+		m_backend = std::make_unique<FlappyPhysicsBackend>(gravity * BOX2D_SCALE_FACTOR, *m_listener);
+		break;
+	}
 }
 
 PhysicsManager::~PhysicsManager()
@@ -26,126 +34,145 @@ PhysicsManager::~PhysicsManager()
 
 void PhysicsManager::Update(float dt, int velocityIter, int positionIter)
 {
-	m_world->Step(dt, velocityIter, positionIter);
+	PROFILE_SCOPE("PhysicsManager::Update");
+
+	m_backend->Step(dt, velocityIter, positionIter);
+	// deferred contacts are handled here, outside of the step
+	m_listener->Flush();
 	ClearDestroyedShapes();
 }
 
-void PhysicsManager::RenderDebugShapes() const
+#ifndef NN_HEADLESS
+void PhysicsManager::RenderDebugShapes(DebugDrawer& debugDrawer) const
 {
 	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
-	for (auto const& physicBody : m_physicsBodies)
+	for (auto const& physicBody : m_physicsBodies.GetValues())
 	{
-		b2Fixture * pFixture = physicBody->m_body->GetFixtureList();
+		math::vec2 pos	= physicBody->GetPosition();
+		float degree	= physicBody->GetAngle();
+		math::vec2 size	= physicBody->GetSize();
 
-		while (pFixture)
+		switch (physicBody->GetShapeType())
 		{
-			b2Vec2 pos		= physicBody->m_body->GetPosition() * BOX2D_SCALE_FACTOR;
-			float radians	= RAD_TO_DEG(physicBody->m_body->GetAngle());
-
-			switch (pFixture->GetType())
-			{
-			case b2Shape::e_circle:
-			{
-				float radius = static_cast<b2CircleShape*>(pFixture->GetShape())->m_radius * BOX2D_SCALE_FACTOR;
-				math::mat4 transform =	math::mat4::Translate(math::vec3(pos.x, pos.y, 0.f)) *
-										math::mat4::Rotate2D(radians) *
-										math::mat4::Scale(radius);
-				if(physicBody->GetDebugFill())
-					m_debugDrawer.AddDebugFilledCircle(transform, physicBody->m_debugColor);
-				else
-					m_debugDrawer.AddDebugCircle(transform, physicBody->m_debugColor);
-			}
-			case b2Shape::e_polygon:
-			{
-				b2Vec2 dim =	(static_cast<b2PolygonShape*>(pFixture->GetShape())->m_vertices[0] -
-								static_cast<b2PolygonShape*>(pFixture->GetShape())->m_centroid) * BOX2D_SCALE_FACTOR * 2.f;
-				math::mat4 transform =	math::mat4::Translate(math::vec3(pos.x, pos.y, 0.f)) *
-										math::mat4::Rotate2D(radians) *
-										math::mat4::Scale(math::vec3(fabs(dim.x), fabs(dim.y), 0.f));
-
-				if (physicBody->GetDebugFill())
-					m_debugDrawer.AddFilledDebugBox(transform, physicBody->m_debugColor);
-				else
-					m_debugDrawer.AddDebugBox(transform, physicBody->m_debugColor);
-			}
-			case b2Shape::e_chain:
-			case b2Shape::e_edge:
-				break;
-			}
+		case PhysicsBackend::ShapeType::CIRCLE:
+		{
+			math::mat4 transform =	math::mat4::Translate(math::vec3(pos.x, pos.y, 0.f)) *
+									math::mat4::Rotate2D(degree) *
+									math::mat4::Scale(size.x * 0.5f);
+			if(physicBody->GetDebugFill())
+				debugDrawer.AddDebugFilledCircle(transform, physicBody->m_debugColor);
+			else
+				debugDrawer.AddDebugCircle(transform, physicBody->m_debugColor);
+			break;
+		}
+		case PhysicsBackend::ShapeType::BOX:
+		{
+			math::mat4 transform =	math::mat4::Translate(math::vec3(pos.x, pos.y, 0.f)) *
+									math::mat4::Rotate2D(degree) *
+									math::mat4::Scale(math::vec3(size.x, size.y, 0.f));
 
-			pFixture = pFixture->GetNext();
+			if (physicBody->GetDebugFill())
+				debugDrawer.AddFilledDebugBox(transform, physicBody->m_debugColor);
+			else
+				debugDrawer.AddDebugBox(transform, physicBody->m_debugColor);
+			break;
+		}
 		}
 	}
 }
+#endif
 
-void PhysicsManager::ClearDestroyedShapes()
+void PhysicsManager::MarkDestroyed(SlotMapHandle id)
 {
 	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
-	for (auto it = m_physicsBodies.begin(); it != m_physicsBodies.end();)
+	m_destroyedBodies.emplace_back(id);
+}
+
+void PhysicsManager::ClearDestroyedShapes()
+{
+	// only the bodies on the dirty list are touched, handlers of the end contacts may
+	// destroy more bodies, which are removed in the next round
+	for (;;)
 	{
-		PhysicsBody & obj = **it;
-		if (obj.IsDestroyed() && obj.m_body)
 		{
-			m_world->DestroyBody(obj.m_body);
-			obj.m_body = nullptr;
-			it = m_physicsBodies.erase(it);
+			std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+			if (m_destroyedBodies.empty())
+				return;
+
+			m_removedBodies.swap(m_destroyedBodies);
+			for (SlotMapHandle id : m_removedBodies)
+			{
+				RetireBody(*m_physicsBodies.Get(id));
+			}
 		}
-		else
+
+		// the deferred end contacts of the removed bodies still point at them
+		m_listener->Flush();
+
+		std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+		for (SlotMapHandle id : m_removedBodies)
 		{
-			++it;
+			PoolBody(*m_physicsBodies.Get(id));
+			m_physicsBodies.Erase(id);
 		}
+		m_removedBodies.clear();
 	}
-	
 }
 
-b2Body* PhysicsManager::CreateBody(const math::vec2 & pos, float radians, b2BodyType type) const
+PhysicBodyPtr PhysicsManager::CreatePhysicsBody(const math::vec2 & pos, const math::vec2 & size, float angle, BodyType bodyType, PhysicsBackend::ShapeType shape)
 {
-	b2BodyDef bodyDef;
-	bodyDef.position.Set(pos.x * INV_BOX2D_SCALE_FACTOR, pos.y * INV_BOX2D_SCALE_FACTOR);
-	bodyDef.angle	= radians;
-	bodyDef.type	= type;
-	bodyDef.fixedRotation = false;
+	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
 
-	return m_world->CreateBody(&bodyDef);
-}
+	// a retired body of the same shape is put back instead of creating a new one
+	PhysicBodyPtr bodyPtr;
+	auto pool = m_bodyPool.find(PoolKey{ shape, bodyType, size.x, size.y });
+	if (pool != m_bodyPool.end() && !pool->second.empty())
+	{
+		bodyPtr = std::move(pool->second.back());
+		pool->second.pop_back();
+	}
 
-b2Fixture* PhysicsManager::CreateFixture(b2Body* body, const b2Shape& shape) const
-{
-	b2FixtureDef fixtureDef;
-	fixtureDef.shape		= &shape;
-	fixtureDef.density		= 1.f;	// since its area with respect to density
-	fixtureDef.friction		= 1.f;
-	fixtureDef.restitution	= 0.f;
-	return body->CreateFixture(&fixtureDef);
-}
+	bool recycled = bodyPtr != nullptr;
+	PhysicsBackend::BodyHandle handle = recycled ? bodyPtr->m_handle : 0;
+	if (recycled)
+		*bodyPtr = PhysicsBody(*m_backend, shape);
+	else
+		bodyPtr = std::make_shared<PhysicsBody>(*m_backend, shape);
 
-void PhysicsManager::CreatePhysicsBody(b2Body* body)
-{
-	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
-	m_physicsBodies.emplace_back(std::make_shared<PhysicsBody>(body));
-	body->SetUserData(&(*m_physicsBodies.back()));
+	PhysicsBody & body = *bodyPtr;
+	body.m_scale	= size;
+	body.m_bodyType	= bodyType;
+	body.m_manager	= this;
+	body.m_id		= m_physicsBodies.Insert(bodyPtr);
+
+	PhysicsBackend::BodyDef bodyDef;
+	bodyDef.m_position	= pos;
+	bodyDef.m_size		= size;
+	bodyDef.m_angle		= angle;
+	bodyDef.m_bodyType	= bodyType;
+	bodyDef.m_shapeType	= shape;
+	bodyDef.m_owner		= &body;
+	if (recycled)
+	{
+		body.m_handle = handle;
+		m_backend->ResetBody(handle, bodyDef);
+	}
+	else
+	{
+		body.m_handle = m_backend->CreateBody(bodyDef);
+	}
+
+	return bodyPtr;
 }
 
 PhysicBodyPtr PhysicsManager::AddCircle(const math::vec2 & pos, float radius, float angle, BodyType bodyType)
 {
-	b2CircleShape shape;
-	shape.m_radius	= radius * INV_BOX2D_SCALE_FACTOR;
-
-	b2Body * pBody = CreateBody(pos, DEG_TO_RAD(angle), b2BodyType(bodyType));
-	CreatePhysicsBody(CreateFixture(pBody, shape)->GetBody());
-	m_physicsBodies.back()->m_scale = math::vec2(radius, radius) * 2.f;
-	return m_physicsBodies.back();
+	return CreatePhysicsBody(pos, math::vec2(radius, radius) * 2.f, angle, bodyType, PhysicsBackend::ShapeType::CIRCLE);
 }
 
 PhysicBodyPtr PhysicsManager::AddBox(const math::vec2 & pos, const math::vec2& size, float angle, BodyType bodyType)
 {
-	b2PolygonShape shape;
-	shape.SetAsBox(size.x * INV_BOX2D_SCALE_FACTOR * 0.5f, size.y * INV_BOX2D_SCALE_FACTOR * 0.5f);
-
-	b2Body * pBody = CreateBody(pos, DEG_TO_RAD(angle), b2BodyType(bodyType));
-	CreatePhysicsBody(CreateFixture(pBody, shape)->GetBody());
-	m_physicsBodies.back()->m_scale = size;
-	return m_physicsBodies.back();
+	return CreatePhysicsBody(pos, size, angle, bodyType, PhysicsBackend::ShapeType::BOX);
 }
 
 PhysicsContactListener& PhysicsManager::GetContactListener()
@@ -161,15 +188,102 @@ const PhysicsContactListener& PhysicsManager::GetContactListener() const
 const std::vector<PhysicBodyPtr>& PhysicsManager::GetAllBodies() const
 {
 	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
-	return m_physicsBodies;
+	return m_physicsBodies.GetValues();
+}
+
+PhysicBodyPtr PhysicsManager::GetBody(SlotMapHandle id) const
+{
+	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+	const PhysicBodyPtr* body = m_physicsBodies.Get(id);
+	return body ? *body : nullptr;
+}
+
+PhysicsManager::BackendType PhysicsManager::GetBackendType() const
+{
+	return m_backendType;
 }
 
 void PhysicsManager::Clear()
 {
+	{
+		std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+		for (auto & body : m_physicsBodies.GetValues())
+		{
+			if (body->m_backend)
+			{
+				m_backend->DestroyBody(body->m_handle);
+				body->m_backend = nullptr;
+			}
+		}
+	}
+
+	m_listener->Flush();
+
 	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
-	for (auto & body : m_physicsBodies)
+	m_physicsBodies.Clear();
+	m_destroyedBodies.clear();
+
+	for (auto & pool : m_bodyPool)
 	{
-		m_world->DestroyBody(body->m_body);
+		for (auto & body : pool.second)
+		{
+			m_backend->DestroyBody(body->m_handle);
+			body->m_backend = nullptr;
+		}
 	}
-	m_physicsBodies.clear();
+	m_bodyPool.clear();
+}
+
+void PhysicsManager::Reset()
+{
+	{
+		std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+		for (auto & body : m_physicsBodies.GetValues())
+		{
+			RetireBody(body);
+		}
+	}
+
+	m_listener->Flush();
+
+	std::lock_guard<std::mutex> lck(m_physicsBodiesMtx);
+	for (auto & body : m_physicsBodies.GetValues())
+	{
+		PoolBody(body);
+	}
+	m_physicsBodies.Clear();
+	m_destroyedBodies.clear();
+}
+
+void PhysicsManager::RetireBody(const PhysicBodyPtr & body)
+{
+	if (!body->m_backend)
+		return;
+
+	// a body still held outside the manager can not be handed out again
+	if (body.use_count() == 1)
+	{
+		m_backend->DisableBody(body->m_handle);
+	}
+	else
+	{
+		m_backend->DestroyBody(body->m_handle);
+		body->m_backend = nullptr;
+	}
+}
+
+void PhysicsManager::PoolBody(const PhysicBodyPtr & body)
+{
+	if (!body->m_backend)
+		return;
+
+	// picked up by a contact handler since it was retired
+	if (body.use_count() > 1)
+	{
+		m_backend->DestroyBody(body->m_handle);
+		body->m_backend = nullptr;
+		return;
+	}
+
+	m_bodyPool[PoolKey{ body->m_shapeType, body->m_bodyType, body->m_scale.x, body->m_scale.y }].emplace_back(body);
 }
\ No newline at end of file
@@ -1,13 +1,15 @@
 #pragma once
 
 #include "math.h"
-#include "Box2D/box2d.h"
+#include "PhysicsBackend.h"
+#include "SlotMap.h"
 
+#include <map>
+#include <tuple>
 #include <vector>
 #include <memory>
 #include <mutex>
 
-class b2World;
 class DebugDrawer;
 class PhysicsBody;
 class PhysicsContactListener;
@@ -20,38 +22,73 @@ public:
 	static const float BOX2D_SCALE_FACTOR;
 	static const float INV_BOX2D_SCALE_FACTOR;
 
-	enum class BodyType
+	using BodyType = PhysicsBackend::BodyType;
+
+	enum class BackendType
 	{
-		DYNAMIC		= b2_dynamicBody,
-		STATIC		= b2_staticBody,
-		KINEMATIC	= b2_kinematicBody
+		BOX2D,		// general rigid bodies
+		FLAPPY		// integration and overlap tests only, no collision response
 	};
 
-	PhysicsManager(const math::vec2 & gravity, DebugDrawer& debugDrawer);
+	// gravity in physics units (m/s^2)
+	PhysicsManager(const math::vec2 & gravity, BackendType backendType = BackendType::BOX2D);
 	~PhysicsManager();
 	void Update(float dt, int velocityIter = 8, int positionIter = 3);
 
 	PhysicBodyPtr AddCircle(const math::vec2 & pos, float radius, float angle, BodyType bodyType);
 	PhysicBodyPtr AddBox(const math::vec2 & pos, const math::vec2& size, float angle, BodyType bodyType);
-	void RenderDebugShapes() const;
+#ifndef NN_HEADLESS
+	void RenderDebugShapes(DebugDrawer& debugDrawer) const;
+#endif
 
 	PhysicsContactListener& GetContactListener();
 	const PhysicsContactListener& GetContactListener() const;
 	const std::vector<PhysicBodyPtr>& GetAllBodies() const;
+	// nullptr once the body has been removed
+	PhysicBodyPtr GetBody(SlotMapHandle id) const;
+	BackendType GetBackendType() const;
 
+	// removes and destroys every body
 	void Clear();
+	// removes every body but keeps them for reuse, the next AddCircle / AddBox of the same
+	// shape, type and size repositions a kept body instead of creating one
+	void Reset();
 
 private:
+	friend class PhysicsBody;
+
+	// queues a body destroyed by PhysicsBody::Destroy for removal after the step
+	void MarkDestroyed(SlotMapHandle id);
 	void ClearDestroyedShapes();
-	b2Body* CreateBody(const math::vec2 & pos, float radians, b2BodyType type) const;
-	b2Fixture* CreateFixture(b2Body* body, const b2Shape& shape) const;
-	void CreatePhysicsBody(b2Body* body);
 
-	b2Vec2						m_gravity;
-	std::unique_ptr<b2World>	m_world;
-	std::unique_ptr<PhysicsContactListener> m_listener;
-	DebugDrawer&				m_debugDrawer;
+	// removal from the world in two steps around the flush of the end contacts,
+	// bodies only referenced by the manager go to the pool, the others are destroyed
+	void RetireBody(const PhysicBodyPtr & body);
+	void PoolBody(const PhysicBodyPtr & body);
+	PhysicBodyPtr CreatePhysicsBody(const math::vec2 & pos, const math::vec2 & size, float angle, BodyType bodyType, PhysicsBackend::ShapeType shape);
+
+	BackendType									m_backendType;
+	std::unique_ptr<PhysicsContactListener>		m_listener;
+	std::unique_ptr<PhysicsBackend>				m_backend;
+
+	SlotMap<PhysicBodyPtr>						m_physicsBodies;
+	std::vector<SlotMapHandle>					m_destroyedBodies;	// dirty list, removed by ClearDestroyedShapes
+	std::vector<SlotMapHandle>					m_removedBodies;
+
+	struct PoolKey
+	{
+		PhysicsBackend::ShapeType	m_shapeType;
+		BodyType					m_bodyType;
+		float						m_sizeX;
+		float						m_sizeY;
+
+		bool operator<(const PoolKey& rhs) const
+		{
+			return std::tie(m_shapeType, m_bodyType, m_sizeX, m_sizeY) < std::tie(rhs.m_shapeType, rhs.m_bodyType, rhs.m_sizeX, rhs.m_sizeY);
+		}
+	};
 
-	std::vector<std::shared_ptr<PhysicsBody>>	m_physicsBodies;
+	// disabled bodies waiting to be reused
+	std::map<PoolKey, std::vector<PhysicBodyPtr>>	m_bodyPool;
 	mutable std::mutex							m_physicsBodiesMtx;
 };
\ No newline at end of file
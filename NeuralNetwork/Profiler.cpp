@@ -0,0 +1,289 @@
+#include "Profiler.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+// single producer ring of one thread. slots are atomics so that the reader may copy
+// them while the owner keeps recording, m_writing tells it which ones were overwritten
+class Profiler::ThreadRing
+{
+public:
+	ThreadRing(unsigned threadId, const std::string& threadName) :
+		m_threadId(threadId),
+		m_threadName(threadName.empty() ? "Thread " + std::to_string(threadId) : threadName),
+		m_depth(0),
+		m_slots(new Slot[RING_SIZE]),
+		m_writing(0),
+		m_head(0)
+	{
+	}
+
+	// owner thread only
+	void Push(const char* name, int64_t start, int64_t end, unsigned depth)
+	{
+		uint64_t index = m_head.load(std::memory_order_relaxed);
+		m_writing.store(index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Slot& slot = m_slots[index & (RING_SIZE - 1)];
+		slot.m_name.store(name, std::memory_order_relaxed);
+		slot.m_start.store(start, std::memory_order_relaxed);
+		slot.m_end.store(end, std::memory_order_relaxed);
+		slot.m_depth.store(depth, std::memory_order_relaxed);
+
+		m_head.store(index + 1, std::memory_order_release);
+	}
+
+	// any thread. events are pushed when they end, so the scan stops at the first one before from
+	void Read(std::vector<Event>& events, int64_t from, int64_t to) const
+	{
+		uint64_t head	= m_head.load(std::memory_order_acquire);
+		uint64_t first	= head > RING_SIZE ? head - RING_SIZE : 0;
+
+		size_t begin = events.size();
+		uint64_t index = head;
+		for (; index > first; --index)
+		{
+			const Slot& slot = m_slots[(index - 1) & (RING_SIZE - 1)];
+			Event event;
+			event.m_name	= slot.m_name.load(std::memory_order_relaxed);
+			event.m_start	= slot.m_start.load(std::memory_order_relaxed);
+			event.m_end		= slot.m_end.load(std::memory_order_relaxed);
+			event.m_depth	= slot.m_depth.load(std::memory_order_relaxed);
+			if (event.m_end < from)
+			{
+				break;
+			}
+			events.emplace_back(event);
+		}
+
+		// drop the slots the owner overwrote while they were copied
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t writing	= m_writing.load(std::memory_order_relaxed);
+		uint64_t valid		= writing > RING_SIZE ? writing - RING_SIZE : 0;
+		size_t validCount	= head > valid ? static_cast<size_t>(head - (std::max)(valid, index)) : 0;
+		events.resize(begin + (std::min)(validCount, events.size() - begin));
+
+		events.erase(std::remove_if(events.begin() + begin, events.end(), [to](const Event& event) { return event.m_end > to; }), events.end());
+	}
+
+	const unsigned	m_threadId;
+	std::string		m_threadName;	// guarded by Profiler::m_mutex
+	unsigned		m_depth;		// owner thread only
+
+private:
+	struct Slot
+	{
+		std::atomic<const char*>	m_name;
+		std::atomic<int64_t>		m_start;
+		std::atomic<int64_t>		m_end;
+		std::atomic<unsigned>		m_depth;
+	};
+
+	std::unique_ptr<Slot[]>	m_slots;
+	std::atomic<uint64_t>	m_writing;	// events started to be written
+	std::atomic<uint64_t>	m_head;		// events published
+};
+
+const unsigned Profiler::RING_SIZE;
+const unsigned Profiler::FRAME_HISTORY;
+std::atomic<bool> Profiler::s_enabled(false);
+
+namespace
+{
+	void WriteJsonString(std::ostream& stream, const std::string& text)
+	{
+		stream << '"';
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+				stream << '\\' << c;
+			else if (static_cast<unsigned char>(c) >= 0x20)
+				stream << c;
+		}
+		stream << '"';
+	}
+}
+
+Profiler::Profiler() :
+	m_epoch(std::chrono::steady_clock::now()),
+	m_nextThreadId(0),
+	m_frameMarks(FRAME_HISTORY, 0),
+	m_frameCount(0)
+{
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+bool Profiler::IsEnabled()
+{
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::SetEnabled(bool set)
+{
+	s_enabled.store(set, std::memory_order_relaxed);
+}
+
+int64_t Profiler::Now() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	// threads that never record get no ring
+	ThreadState& state = GetThreadState();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	state.m_name = name;
+	if (state.m_ring)
+	{
+		state.m_ring->m_threadName = name;
+	}
+}
+
+void Profiler::MarkFrame()
+{
+	int64_t now = Now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_frameMarks[m_frameCount % FRAME_HISTORY] = now;
+	++m_frameCount;
+}
+
+std::vector<int64_t> Profiler::GetFrameMarks(unsigned count) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	count = (std::min)(count, (std::min)(m_frameCount, FRAME_HISTORY));
+
+	std::vector<int64_t> marks;
+	marks.reserve(count);
+	for (unsigned i = m_frameCount - count; i < m_frameCount; ++i)
+	{
+		marks.emplace_back(m_frameMarks[i % FRAME_HISTORY]);
+	}
+	return marks;
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::Collect(int64_t from, int64_t to) const
+{
+	std::vector<std::shared_ptr<ThreadRing>> rings;
+	std::vector<ThreadEvents> threads;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto & thread : m_threads)
+		{
+			if (std::shared_ptr<ThreadRing> ring = thread.lock())
+			{
+				threads.emplace_back(ThreadEvents{ ring->m_threadId, ring->m_threadName, {} });
+				rings.emplace_back(std::move(ring));
+			}
+		}
+	}
+
+	// parents before their children
+	for (size_t i = 0; i < rings.size(); ++i)
+	{
+		std::vector<Event>& events = threads[i].m_events;
+		rings[i]->Read(events, from, to);
+		std::sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs)
+		{
+			return lhs.m_start != rhs.m_start ? lhs.m_start < rhs.m_start : lhs.m_depth < rhs.m_depth;
+		});
+	}
+	return threads;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const
+{
+	std::ofstream stream(path);
+	if (!stream)
+	{
+		return false;
+	}
+
+	// timestamps are in microseconds
+	stream << std::fixed << std::setprecision(3);
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	for (auto & thread : Collect())
+	{
+		stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.m_threadId << ",\"args\":{\"name\":";
+		WriteJsonString(stream, thread.m_threadName);
+		stream << "}}";
+		first = false;
+
+		for (auto & event : thread.m_events)
+		{
+			stream << ",\n{\"name\":";
+			WriteJsonString(stream, event.m_name);
+			stream << ",\"cat\":\"nn\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.m_threadId
+				<< ",\"ts\":" << event.m_start * 1e-3 << ",\"dur\":" << (event.m_end - event.m_start) * 1e-3 << "}";
+		}
+	}
+
+	for (int64_t mark : GetFrameMarks())
+	{
+		stream << (first ? "" : ",") << "\n{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << mark * 1e-3 << "}";
+		first = false;
+	}
+
+	stream << "\n]}\n";
+	return static_cast<bool>(stream);
+}
+
+Profiler::ThreadState& Profiler::GetThreadState()
+{
+	static thread_local ThreadState s_state;
+	return s_state;
+}
+
+Profiler::ThreadRing& Profiler::GetThreadRing()
+{
+	// the profiler only keeps a weak reference, the ring goes away with its thread
+	ThreadState& state = GetThreadState();
+	if (!state.m_ring)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threads.erase(std::remove_if(m_threads.begin(), m_threads.end(), [](const std::weak_ptr<ThreadRing>& ring) { return ring.expired(); }), m_threads.end());
+
+		state.m_ring = std::make_shared<ThreadRing>(m_nextThreadId++, state.m_name);
+		m_threads.emplace_back(state.m_ring);
+	}
+	return *state.m_ring;
+}
+
+ProfileScope::ProfileScope(const char* name) :
+	m_name(nullptr),
+	m_ring(nullptr),
+	m_start(0),
+	m_depth(0)
+{
+	if (!Profiler::IsEnabled())
+	{
+		return;
+	}
+
+	Profiler& profiler = Profiler::Get();
+	m_ring	= &profiler.GetThreadRing();
+	m_name	= name;
+	m_depth	= m_ring->m_depth++;
+	m_start	= profiler.Now();
+}
+
+ProfileScope::~ProfileScope()
+{
+	if (!m_name)
+	{
+		return;
+	}
+
+	int64_t end = Profiler::Get().Now();
+	--m_ring->m_depth;
+	m_ring->Push(m_name, m_start, end, m_depth);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// scoped timers recorded per thread into fixed size rings, read back by the
+// profiler panel and the chrome trace dump. recording takes no lock, a disabled
+// profiler costs one relaxed load per scope.
+//	PROFILE_SCOPE("PhysicsManager::Update");
+class Profiler
+{
+public:
+	static const unsigned RING_SIZE		= 1u << 15;	// events kept per thread, power of two
+	static const unsigned FRAME_HISTORY	= 128;		// frame boundaries kept
+
+	struct Event
+	{
+		const char*	m_name;		// string literal
+		int64_t		m_start;	// ns since the profiler started
+		int64_t		m_end;
+		unsigned	m_depth;	// scopes open on the thread when this one started
+	};
+
+	struct ThreadEvents
+	{
+		unsigned			m_threadId;
+		std::string			m_threadName;
+		std::vector<Event>	m_events;	// sorted by start
+	};
+
+	static Profiler& Get();
+
+	static bool IsEnabled();
+	static void SetEnabled(bool set);
+
+	// ns since the profiler started
+	int64_t Now() const;
+
+	// shown in the panel and the trace instead of "Thread N"
+	void SetThreadName(const std::string& name);
+
+	// boundary between two frames, called once per frame by the main loop
+	void MarkFrame();
+	// the last count frame boundaries, oldest first
+	std::vector<int64_t> GetFrameMarks(unsigned count = FRAME_HISTORY) const;
+
+	// events of every thread that ended in [from, to]
+	std::vector<ThreadEvents> Collect(int64_t from = 0, int64_t to = INT64_MAX) const;
+
+	// every recorded event in the chrome://tracing (and Perfetto) json format
+	bool WriteChromeTrace(const std::string& path) const;
+
+private:
+	class ThreadRing;
+	friend class ProfileScope;
+
+	struct ThreadState
+	{
+		std::shared_ptr<ThreadRing>	m_ring;	// created by the first scope of the thread
+		std::string					m_name;
+	};
+
+	Profiler();
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	static ThreadState& GetThreadState();
+	ThreadRing& GetThreadRing();
+
+	static std::atomic<bool>					s_enabled;
+
+	const std::chrono::steady_clock::time_point	m_epoch;
+	mutable std::mutex							m_mutex;	// thread list and frame marks
+	std::vector<std::weak_ptr<ThreadRing>>		m_threads;	// rings of exited threads expire
+	unsigned									m_nextThreadId;
+	std::vector<int64_t>						m_frameMarks;
+	unsigned									m_frameCount;
+};
+
+// times the enclosing scope on the calling thread
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name);
+	~ProfileScope();
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char*				m_name;		// null when the profiler was disabled at the start
+	Profiler::ThreadRing*	m_ring;
+	int64_t					m_start;
+	unsigned				m_depth;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_NAME_(line) PROFILE_CONCAT_(profileScope_, line)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_NAME_(__LINE__)(name)
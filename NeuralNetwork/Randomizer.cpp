@@ -1,26 +1,255 @@
 #include "Randomizer.h"
 
-Randomizer::Randomizer(float minValue, float maxValue) : 
-				m_distributionInt((int)minValue, (int)maxValue),
-				m_rndGen(m_randDevice() + static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count())),
-				m_distributionFloat(minValue, maxValue),
-				m_minVal(minValue),
-				m_maxVal(maxValue)
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+namespace
+{
+	uint64_t SplitMix64(uint64_t & x)
+	{
+		uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t RotL(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	uint32_t RotL32(uint32_t x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+
+	const unsigned	LANES		= RandomEngineLanes::LANES;
+	const size_t	CHUNK_STEPS	= 64;					// 4 KB of draws per chunk
+	const size_t	CHUNK_DRAWS	= CHUNK_STEPS * LANES;
+	const float		UNIT_24		= 1.f / 16777216.f;		// 2^-24
+
+	// the high 24 bits of each draw, kept in int32 so the conversion vectorizes
+	void ToUniform(const uint32_t* bits, size_t draws, float minValue, float scale, float* values)
+	{
+		for (size_t i = 0; i < draws; ++i)
+		{
+			values[i] = minValue + scale * static_cast<float>(static_cast<int32_t>(bits[i] >> 8));
+		}
+	}
+
+	// one pair of draws per pair of values, draws is even
+	void ToNormal(const uint32_t* bits, size_t draws, float mean, float stdDev, float* values)
+	{
+		const float TWO_PI = 6.28318530718f;
+		const size_t half = draws / 2;
+		for (size_t i = 0; i < half; ++i)
+		{
+			// u1 in (0, 1] keeps the log finite
+			float u1 = static_cast<float>(static_cast<int32_t>(bits[i] >> 8) + 1) * UNIT_24;
+			float u2 = static_cast<float>(static_cast<int32_t>(bits[half + i] >> 8)) * UNIT_24;
+			float r = stdDev * std::sqrt(-2.f * std::log(u1));
+			values[i]			= mean + r * std::cos(TWO_PI * u2);
+			values[half + i]	= mean + r * std::sin(TWO_PI * u2);
+		}
+	}
+
+	// whole chunks straight into values, the last partial one through a copy
+	template<typename F>
+	void FillChunks(RandomEngineLanes& lanes, float* values, size_t count, F convert)
+	{
+		uint32_t bits[CHUNK_DRAWS];
+		while (count > 0)
+		{
+			size_t steps = (std::min)(CHUNK_STEPS, (count + LANES - 1) / LANES);
+			size_t draws = steps * LANES;
+			lanes.Next(bits, steps);
+
+			if (draws <= count)
+			{
+				convert(bits, draws, values);
+			}
+			else
+			{
+				float chunk[CHUNK_DRAWS];
+				convert(bits, draws, chunk);
+				std::copy(chunk, chunk + count, values);
+				break;
+			}
+			values	+= draws;
+			count	-= draws;
+		}
+	}
+}
+
+const uint64_t Randomizer::DEFAULT_SEED = 0x853c49e6748fea9bull;
+
+RandomEngine::RandomEngine(uint64_t seed, unsigned stream)
+{
+	Seed(seed, stream);
+}
+
+void RandomEngine::Seed(uint64_t seed, unsigned stream)
+{
+	// splitmix64 never gives four zero words, the all zero state is the only invalid one
+	for (auto & s : m_state)
+		s = SplitMix64(seed);
+
+	for (unsigned i = 0; i < stream; ++i)
+		Jump();
+}
+
+uint64_t RandomEngine::Next()
+{
+	const uint64_t result = RotL(m_state[1] * 5, 7) * 9;
+	const uint64_t t = m_state[1] << 17;
+
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= t;
+	m_state[3] = RotL(m_state[3], 45);
+
+	return result;
+}
+
+void RandomEngine::Jump()
+{
+	static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+	Jump(JUMP);
+}
+
+void RandomEngine::LongJump()
+{
+	static const uint64_t LONG_JUMP[] = { 0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull };
+	Jump(LONG_JUMP);
+}
+
+void RandomEngine::Jump(const uint64_t (&polynomial)[4])
 {
-	srand(unsigned(time(NULL)) + reinterpret_cast<unsigned>(this));
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	for (uint64_t jump : polynomial)
+	{
+		for (int b = 0; b < 64; ++b)
+		{
+			if (jump & (1ull << b))
+			{
+				for (int i = 0; i < 4; ++i)
+					s[i] ^= m_state[i];
+			}
+			Next();
+		}
+	}
+
+	for (int i = 0; i < 4; ++i)
+		m_state[i] = s[i];
+}
+
+uint64_t RandomEngine::DeriveSeed(uint64_t seed, uint64_t index)
+{
+	uint64_t x = seed ^ SplitMix64(index);
+	return SplitMix64(x);
+}
+
+void RandomEngineLanes::Seed(const RandomEngine& engine)
+{
+	// a long jump away from every stream of engine, its draws seed the lanes
+	RandomEngine seeder = engine;
+	seeder.LongJump();
+	for (unsigned l = 0; l < LANES; ++l)
+	{
+		uint64_t a = seeder.Next(), b = seeder.Next();
+		m_state[0][l] = static_cast<uint32_t>(a);
+		m_state[1][l] = static_cast<uint32_t>(a >> 32);
+		m_state[2][l] = static_cast<uint32_t>(b);
+		m_state[3][l] = static_cast<uint32_t>(b >> 32) | (a == 0 && b == 0 ? 1u : 0u);
+	}
+}
+
+void RandomEngineLanes::Next(uint32_t* values, size_t steps)
+{
+	// the state is copied to locals for the whole run, it cannot alias values then
+	uint32_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+	for (unsigned l = 0; l < LANES; ++l)
+	{
+		s0[l] = m_state[0][l]; s1[l] = m_state[1][l]; s2[l] = m_state[2][l]; s3[l] = m_state[3][l];
+	}
+
+	for (size_t step = 0; step < steps; ++step, values += LANES)
+	{
+		for (unsigned l = 0; l < LANES; ++l)
+		{
+			values[l] = s0[l] + s3[l];
+
+			const uint32_t t = s1[l] << 9;
+			s2[l] ^= s0[l];
+			s3[l] ^= s1[l];
+			s1[l] ^= s2[l];
+			s0[l] ^= s3[l];
+			s2[l] ^= t;
+			s3[l] = RotL32(s3[l], 11);
+		}
+	}
+
+	for (unsigned l = 0; l < LANES; ++l)
+	{
+		m_state[0][l] = s0[l]; m_state[1][l] = s1[l]; m_state[2][l] = s2[l]; m_state[3][l] = s3[l];
+	}
+}
+
+Randomizer::Randomizer(float minValue, float maxValue, uint64_t seed, unsigned stream) :
+	m_engine(seed, stream),
+	m_minVal(minValue),
+	m_maxVal(maxValue),
+	m_minInt(static_cast<int>(minValue)),
+	m_intRange(static_cast<uint64_t>(static_cast<int64_t>(maxValue) - static_cast<int64_t>(minValue)) + 1)
+{
+	m_lanes.Seed(m_engine);
+}
+
+Randomizer::Randomizer(int minValue, int maxValue, uint64_t seed, unsigned stream) :
+	Randomizer(static_cast<float>(minValue), static_cast<float>(maxValue), seed, stream)
+{
+	// the float constructor loses precision above 2^24
+	m_minInt	= minValue;
+	m_intRange	= static_cast<uint64_t>(static_cast<int64_t>(maxValue) - minValue) + 1;
 }
 
-Randomizer::Randomizer(int minValue, int maxValue) : 
-	Randomizer(static_cast<float>(minValue), static_cast<float>(maxValue))
+void Randomizer::Seed(uint64_t seed, unsigned stream)
 {
+	m_engine.Seed(seed, stream);
+	m_lanes.Seed(m_engine);
 }
 
 int Randomizer::GetRandomInt()
 {
-	return m_distributionInt(m_rndGen);
+	assert(m_intRange > 0 && m_intRange <= (1ull << 32));
+
+	// multiply-shift range reduction (Lemire) on the high 32 bits, the bias is below 2^-32 * range
+	return m_minInt + static_cast<int>(((m_engine.Next() >> 32) * m_intRange) >> 32);
 }
 
 float Randomizer::GetRandomFloat()
 {
-	return m_distributionFloat(m_rndGen);
-}
\ No newline at end of file
+	// 24 random bits, exactly representable in [0, 1)
+	float unit = static_cast<float>(m_engine.Next() >> 40) * (1.f / 16777216.f);
+	return m_minVal + (m_maxVal - m_minVal) * unit;
+}
+
+unsigned Randomizer::GetRandomIndex(unsigned count)
+{
+	assert(count > 0);
+	return static_cast<unsigned>(((m_engine.Next() >> 32) * count) >> 32);
+}
+
+void Randomizer::FillUniform(float* values, size_t count)
+{
+	const float minValue = m_minVal, scale = (m_maxVal - m_minVal) * UNIT_24;
+	FillChunks(m_lanes, values, count, [=](const uint32_t* bits, size_t draws, float* out) { ToUniform(bits, draws, minValue, scale, out); });
+}
+
+void Randomizer::FillNormal(float* values, size_t count, float mean, float stdDev)
+{
+	FillChunks(m_lanes, values, count, [=](const uint32_t* bits, size_t draws, float* out) { ToNormal(bits, draws, mean, stdDev, out); });
+}
@@ -1,25 +1,82 @@
 #pragma once
 
-#include <ctime>
-#include <chrono>
-#include <random>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
 
+// xoshiro256** (Blackman, Vigna), 256 bits of state and a period of 2^256 - 1.
+// the seed is expanded with splitmix64, Jump skips 2^128 draws so the streams of one seed never overlap
+class RandomEngine
+{
+public:
+	explicit RandomEngine(uint64_t seed = 0, unsigned stream = 0);
+
+	// restarts the sequence at the given stream of the seed
+	void Seed(uint64_t seed, unsigned stream = 0);
+	uint64_t Next();
+	void Jump();
+	// skips 2^192 draws, 2^64 streams fit between two long jumps
+	void LongJump();
+
+	// unrelated seed for the index-th child of a seed, e.g. one per island
+	static uint64_t DeriveSeed(uint64_t seed, uint64_t index);
+
+private:
+	// advances by the jump polynomial
+	void Jump(const uint64_t (&polynomial)[4]);
+
+	uint64_t	m_state[4];
+};
+
+// LANES xoshiro128+ engines stepped together for bulk floats. 32 bit words and no multiply,
+// the state is stored lane by lane so the loop over the lanes compiles to vector instructions.
+// only the high bits are used, the low bits of xoshiro128+ are weak
+class RandomEngineLanes
+{
+public:
+	static const unsigned LANES = 16;
+
+	// the lanes are seeded from draws of engine after a long jump
+	void Seed(const RandomEngine& engine);
+	// writes steps * LANES draws, lane after lane
+	void Next(uint32_t* values, size_t steps);
+
+private:
+	uint32_t	m_state[4][LANES];
+};
+
+// every owner draws from its own engine, so workers need no locks and the results do not
+// depend on which thread runs them. equal seeds and streams give equal sequences on every platform
 class Randomizer
 {
 public:
-	Randomizer(float minValue, float maxValue);
-	Randomizer(int minValue, int maxValue);
+	static const uint64_t DEFAULT_SEED;
+
+	Randomizer(float minValue, float maxValue, uint64_t seed = DEFAULT_SEED, unsigned stream = 0);
+	Randomizer(int minValue, int maxValue, uint64_t seed = DEFAULT_SEED, unsigned stream = 0);
+
+	// restarts the sequence, equal seeds give equal sequences
+	void Seed(uint64_t seed, unsigned stream = 0);
 
+	// [min, max]
 	int GetRandomInt();
+	// [min, max)
 	float GetRandomFloat();
+	// [0, count)
+	unsigned GetRandomIndex(unsigned count);
+
+	// bulk draws from the interleaved engines. they follow a sequence of their own and
+	// leave the one of the single draws untouched
+	// [min, max)
+	void FillUniform(float* values, size_t count);
+	// normal distribution (Box-Muller), the range of the randomizer is not used.
+	// goes through the math library, the last bit may differ between platforms
+	void FillNormal(float* values, size_t count, float mean, float stdDev);
 
 private:
-	float									m_minVal, 
-											m_maxVal;
-	std::random_device						m_randDevice;  
-	std::mt19937							m_rndGen; 
-	std::uniform_int_distribution<int>		m_distributionInt;
-	std::uniform_real_distribution<float>	m_distributionFloat;
+	RandomEngine		m_engine;
+	RandomEngineLanes	m_lanes;
+	float				m_minVal, 
+						m_maxVal;
+	int					m_minInt;
+	uint64_t			m_intRange;
 };
-
@@ -1,13 +1,20 @@
 #include "SceneManager.h"
 
-#include "GraphicsManager.h"
+#include "math.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
 #include "PhysicsManager.h"
 #include "TrainingScene.h"
 
-SceneManager::SceneManager(GraphicsManager& graphicsMgr) :	m_graphicsMgr(graphicsMgr),
-															m_hasInit(false),
-															m_sceneSpd(1),
-															m_debugRender(true)
+#ifndef NN_HEADLESS
+#include "GraphicsManager.h"
+#endif
+
+#include <algorithm>
+
+SceneManager::SceneManager() :	m_hasInit(false),
+								m_sceneSpd(1),
+								m_debugRender(true)
 {
 
 }
@@ -20,8 +27,22 @@ void SceneManager::Init(const ScenesConfig& config)
 {
 	m_config = config;
 
-	// training scenes
-	m_trainingScene = std::make_shared<TrainingScene>(m_graphicsMgr, m_config.m_agentCount);
+	// islands and shards share one pool, nested loops are fine
+	m_islands.clear();
+	m_threadPool.reset();
+	if (m_config.m_islandCount > 1 || m_config.m_shardCount > 1)
+	{
+		m_threadPool = std::make_unique<ThreadPool>(m_config.m_threadCount);
+	}
+
+	// training scenes, one per island
+	for (unsigned i = 0; i < (std::max)(1u, m_config.m_islandCount); ++i)
+	{
+		m_islands.emplace_back(std::make_shared<TrainingScene>(m_config.m_agentCount, m_config.m_shardCount, m_threadPool.get(), m_config.m_physicsBackend, m_config.m_brainType,
+			RandomEngine::DeriveSeed(m_config.m_seed, i)));
+	}
+	m_trainingScene = m_islands.front();
+	m_lastMigration.assign(m_islands.size(), 0);
 
 	m_hasInit = true;
 }
@@ -33,24 +54,53 @@ void SceneManager::Update(float dt)
 		return;
 	}
 
-	if (m_trainingScene)
+	PROFILE_SCOPE("SceneManager::Update");
+
+	if (m_islands.size() == 1)
 	{
 		for (unsigned i = 0; i < m_sceneSpd; ++i)
 		{
 			m_trainingScene->Update(dt);
 		}
+	}
+	else if (!m_islands.empty())
+	{
+		// islands share nothing while stepping
+		m_threadPool->ParallelFor(static_cast<unsigned>(m_islands.size()), [&](unsigned island)
+		{
+			for (unsigned i = 0; i < m_sceneSpd; ++i)
+			{
+				m_islands[island]->Update(dt);
+			}
+		});
 
-		m_trainingScene->Render();
+		MigrateGenomes();
+	}
+}
 
-		if(m_debugRender)
-			m_trainingScene->GetPhysicsManager().RenderDebugShapes();
+#ifndef NN_HEADLESS
+void SceneManager::Render(GraphicsManager& graphicsMgr) const
+{
+	if (!m_hasInit || !m_trainingScene)
+	{
+		return;
 	}
+
+	m_trainingScene->Render(graphicsMgr);
+
+	if(m_debugRender)
+		m_trainingScene->GetPhysicsManager().RenderDebugShapes(graphicsMgr.GetDebugDrawer());
 }
+#endif
 
 void SceneManager::Unload()
 {
 	m_hasInit = false;
 	m_config  = ScenesConfig();
+	m_trainingScene.reset();
+	m_islands.clear();
+	m_lastMigration.clear();
+	m_threadPool.reset();
 }
 
 bool SceneManager::GetDebugRender() const
@@ -73,7 +123,36 @@ std::shared_ptr<TrainingScene> const& SceneManager::GetTrainingScene() const
 	return m_trainingScene;
 }
 
+std::vector<std::shared_ptr<TrainingScene>> const& SceneManager::GetIslands() const
+{
+	return m_islands;
+}
+
+void SceneManager::MigrateGenomes()
+{
+	if (m_config.m_migrationInterval == 0 || m_config.m_migrantCount == 0)
+	{
+		return;
+	}
+
+	// ring topology, every island receives the elites of the previous one.
+	// runs between updates so the result does not depend on thread timing
+	unsigned islandCount = static_cast<unsigned>(m_islands.size());
+	for (unsigned i = 0; i < islandCount; ++i)
+	{
+		unsigned generation = m_islands[i]->GetCurrentGeneration();
+		if (generation < m_lastMigration[i] + m_config.m_migrationInterval)
+		{
+			continue;
+		}
+
+		const TrainingScene& source = *m_islands[(i + islandCount - 1) % islandCount];
+		m_islands[i]->ImportMigrants(source.GetElites(m_config.m_migrantCount));
+		m_lastMigration[i] = generation;
+	}
+}
+
 void SceneManager::SetSceneSpeed(unsigned speed)
 {
-	m_sceneSpd = min(max(speed, 1), 1 << 10);
+	m_sceneSpd = Clamp(speed, 1u, 1u << 10);
 }
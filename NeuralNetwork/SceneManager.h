@@ -2,8 +2,13 @@
 
 #include <vector>
 #include <future>
+#include <cstdint>
+
+#include "PhysicsManager.h"
+#include "TrainingShard.h"
 
 class ANNTrainer;
+class ThreadPool;
 class TrainingScene;
 class GraphicsManager;
 
@@ -14,26 +19,49 @@ public:
 	{
 		unsigned	m_agentCount	= 50;
 		float		m_discreteDT	= 1.f / 60.f;
+
+		// island model, every island is an independent scene with its own population
+		unsigned	m_islandCount		= 1;
+		unsigned	m_threadCount		= 0;	// 0 = all hardware threads
+		unsigned	m_migrationInterval	= 5;	// generations between migrations
+		unsigned	m_migrantCount		= 2;	// genomes sent to the next island
+
+		// every generation of an island is split over shards simulated in parallel
+		unsigned	m_shardCount		= 1;
+
+		PhysicsManager::BackendType	m_physicsBackend = PhysicsManager::BackendType::BOX2D;
+		TrainingShard::BrainType	m_brainType		= TrainingShard::BrainType::POPULATION;
+
+		// every random draw of a run derives from it, equal configs give equal runs
+		uint64_t					m_seed			= 1;
 	};
 
-	SceneManager(GraphicsManager& graphicsMgr);
+	SceneManager();
 	~SceneManager();
 	void Init(const ScenesConfig& config);
 	void Update(float dt);
+#ifndef NN_HEADLESS
+	void Render(GraphicsManager& graphicsMgr) const;
+#endif
 
 	void Unload();
 	bool GetDebugRender() const;
 	void SetDebugRender(bool set);
 	unsigned GetSceneSpeed() const;
 	std::shared_ptr<TrainingScene> const& GetTrainingScene() const;
+	std::vector<std::shared_ptr<TrainingScene>> const& GetIslands() const;
 
 	void SetSceneSpeed(unsigned speed);
 
 private:
+	void MigrateGenomes();
+
 	bool										m_debugRender;
 	bool										m_hasInit;
 	ScenesConfig								m_config;
-	GraphicsManager&							m_graphicsMgr;
-	std::shared_ptr<TrainingScene>				m_trainingScene;
+	std::shared_ptr<TrainingScene>				m_trainingScene;	// first island, the one rendered
+	std::vector<std::shared_ptr<TrainingScene>>	m_islands;
+	std::vector<unsigned>						m_lastMigration;	// generation of the last migration per island
+	std::unique_ptr<ThreadPool>					m_threadPool;
 	unsigned									m_sceneSpd;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// handle of a SlotMap element, stays valid until the element is erased.
+// a slot reused by a later element has a higher generation, so old handles never alias it
+struct SlotMapHandle
+{
+	uint32_t	m_index;
+	uint32_t	m_generation;
+
+	bool operator==(const SlotMapHandle& rhs) const { return m_index == rhs.m_index && m_generation == rhs.m_generation; }
+	bool operator!=(const SlotMapHandle& rhs) const { return !(*this == rhs); }
+};
+
+// unordered container with O(1) insert, lookup and erase through handles.
+// the values are packed in one vector, erase moves the last value into the hole
+template<typename T>
+class SlotMap
+{
+public:
+	SlotMapHandle Insert(T value)
+	{
+		uint32_t index;
+		if (m_freeSlots.empty())
+		{
+			index = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back(Slot{ 0, 0 });
+		}
+		else
+		{
+			index = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+
+		m_slots[index].m_dense = static_cast<uint32_t>(m_values.size());
+		m_values.emplace_back(std::move(value));
+		m_denseToSlot.emplace_back(index);
+
+		return SlotMapHandle{ index, m_slots[index].m_generation };
+	}
+
+	// false if the handle is stale
+	bool Erase(SlotMapHandle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return false;
+		}
+
+		uint32_t dense = m_slots[handle.m_index].m_dense;
+		uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+		if (dense != last)
+		{
+			m_values[dense]		= std::move(m_values[last]);
+			m_denseToSlot[dense]	= m_denseToSlot[last];
+			m_slots[m_denseToSlot[dense]].m_dense = dense;
+		}
+		m_values.pop_back();
+		m_denseToSlot.pop_back();
+
+		++m_slots[handle.m_index].m_generation;
+		m_freeSlots.emplace_back(handle.m_index);
+		return true;
+	}
+
+	void Clear()
+	{
+		for (uint32_t index : m_denseToSlot)
+		{
+			++m_slots[index].m_generation;
+			m_freeSlots.emplace_back(index);
+		}
+		m_values.clear();
+		m_denseToSlot.clear();
+	}
+
+	void Reserve(size_t count)
+	{
+		m_values.reserve(count);
+		m_denseToSlot.reserve(count);
+		m_slots.reserve(count);
+		m_freeSlots.reserve(count);
+	}
+
+	bool IsValid(SlotMapHandle handle) const
+	{
+		return handle.m_index < m_slots.size() && m_slots[handle.m_index].m_generation == handle.m_generation;
+	}
+
+	// nullptr if the handle is stale
+	T* Get(SlotMapHandle handle)
+	{
+		return IsValid(handle) ? &m_values[m_slots[handle.m_index].m_dense] : nullptr;
+	}
+
+	const T* Get(SlotMapHandle handle) const
+	{
+		return IsValid(handle) ? &m_values[m_slots[handle.m_index].m_dense] : nullptr;
+	}
+
+	// packed values, in no particular order
+	const std::vector<T>& GetValues() const
+	{
+		return m_values;
+	}
+
+	size_t GetSize() const
+	{
+		return m_values.size();
+	}
+
+private:
+	struct Slot
+	{
+		uint32_t	m_dense;		// position in m_values while alive
+		uint32_t	m_generation;
+	};
+
+	std::vector<T>			m_values;
+	std::vector<uint32_t>	m_denseToSlot;
+	std::vector<Slot>		m_slots;
+	std::vector<uint32_t>	m_freeSlots;
+};
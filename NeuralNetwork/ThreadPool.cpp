@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount) :
+	m_quit(false)
+{
+	if (threadCount == 0)
+	{
+		threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+	}
+
+	// the caller is the first thread
+	for (unsigned i = 1; i < threadCount; ++i)
+	{
+		m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeCond.notify_all();
+
+	for (auto & worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::ParallelFor(unsigned count, const std::function<void(unsigned)>& func)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// nothing to share, skip the synchronization
+	if (count == 1 || m_workers.empty())
+	{
+		for (unsigned i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->m_func		= &func;
+	job->m_count	= count;
+	job->m_next		= 0;
+	job->m_done		= 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.emplace_back(job);
+	}
+	m_wakeCond.notify_all();
+
+	RunJob(*job);
+	RemoveJob(job);
+
+	// wait for the items other threads picked up
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCond.wait(lock, [&] { return job->m_done == job->m_count; });
+}
+
+unsigned ThreadPool::GetThreadCount() const
+{
+	return static_cast<unsigned>(m_workers.size()) + 1;
+}
+
+void ThreadPool::WorkerLoop(unsigned index)
+{
+	Profiler::Get().SetThreadName("Worker " + std::to_string(index));
+
+	for (;;)
+	{
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCond.wait(lock, [&] { return m_quit || !m_jobs.empty(); });
+			if (m_jobs.empty())
+			{
+				return;
+			}
+			job = m_jobs.front();
+		}
+
+		RunJob(*job);
+		RemoveJob(job);
+	}
+}
+
+void ThreadPool::RunJob(Job& job)
+{
+	unsigned i;
+	while ((i = job.m_next++) < job.m_count)
+	{
+		(*job.m_func)(i);
+
+		if (++job.m_done == job.m_count)
+		{
+			// lock so the waiting caller cannot miss the notification
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_doneCond.notify_all();
+		}
+	}
+}
+
+void ThreadPool::RemoveJob(const std::shared_ptr<Job>& job)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+	if (it != m_jobs.end())
+	{
+		m_jobs.erase(it);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// fixed set of worker threads for data parallel loops.
+// the calling thread always works on its own loop too, so ParallelFor may be
+// nested (or called with no workers at all) without deadlocking.
+class ThreadPool
+{
+public:
+	// threadCount includes the calling thread, 0 uses every hardware thread
+	explicit ThreadPool(unsigned threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// runs func(i) for every i in [0, count) and returns once all calls finished
+	void ParallelFor(unsigned count, const std::function<void(unsigned)>& func);
+
+	unsigned GetThreadCount() const;
+
+private:
+	struct Job
+	{
+		const std::function<void(unsigned)>*	m_func;
+		unsigned								m_count;
+		std::atomic<unsigned>					m_next;
+		std::atomic<unsigned>					m_done;
+	};
+
+	void WorkerLoop(unsigned index);
+	void RunJob(Job& job);
+	void RemoveJob(const std::shared_ptr<Job>& job);
+
+	bool								m_quit;
+	std::mutex							m_mutex;
+	std::condition_variable				m_wakeCond;
+	std::condition_variable				m_doneCond;
+	std::deque<std::shared_ptr<Job>>	m_jobs;
+	std::vector<std::thread>			m_workers;
+};
@@ -1,93 +1,94 @@
 #include "TrainingScene.h"
 
-#include "ImGui/imgui.h"
-
 #include "math.h"
-#include "ANNWrapper.h"
-#include "GLRenderer.h"
-#include "DebugDrawer.h"
+#include "ThreadPool.h"
 #include "PhysicsBody.h"
+#include "Profiler.h"
 #include "PhysicsManager.h"
-#include "SceneConstants.h"
+
+#ifndef NN_HEADLESS
+#include "GLRenderer.h"
 #include "GraphicsManager.h"
-#include "PhysicsContactListener.h"
+#endif
 
 #include <ctime>
+#include <cfloat>
 #include <iostream>
+#include <cassert>
+#include <algorithm>
 
-TrainingScene::TrainingScene(GraphicsManager& graphicsMgr, unsigned agentCount) :
-	m_physicsMgr(std::make_unique<PhysicsManager>(math::vec2(0.f, -9.8f), graphicsMgr.GetDebugDrawer())),
+TrainingScene::TrainingScene(unsigned agentCount, unsigned shardCount, ThreadPool* threadPool, PhysicsManager::BackendType physicsBackend, TrainingShard::BrainType brainType, uint64_t seed) :
 	m_gameRestarting(false),
 	m_agentCount(agentCount),
-	m_randomizer(-1.f, 1.f),
-	m_obstacleSpawnTimer(0.f),
-	m_graphicsMgr(graphicsMgr),
+	m_threadPool(threadPool),
+	m_randomizer(-1.f, 1.f, seed, GA_STREAM),
+	m_seedRandomizer(0, 1 << 30, seed, OBSTACLE_STREAM),
+	m_genomes(agentCount, ANNWrapper::GetNumWeights(GetBrainConfig())),
 	m_currScore(0),
 	m_maxScore(0),
 	m_currGeneration(0),
 	m_bgTimer(0.f)
 {
-	m_physicsMgr->GetContactListener().SetBeginContactCallbackFunction(&TrainingScene::ContactEnterCallback, this);
-	m_physicsMgr->GetContactListener().SetEndContactCallbackFunction(&TrainingScene::ContactExitCallback, this);
+	// every agent leaves one death record per generation
+	m_collectedWeights.reserve(agentCount);
+	m_parents.reserve(agentCount);
+	m_eliteRows.reserve(agentCount);
+	m_crossoverRolls.reserve(static_cast<size_t>(agentCount) * (m_genomes.GetGenomeSize() >> 1) * 3);
+
+	// agents are split in contiguous blocks, the last shard may be smaller
+	shardCount			= Clamp(shardCount, 1u, (std::max)(1u, agentCount));
+	m_agentsPerShard	= (agentCount + shardCount - 1) / shardCount;
+	for (unsigned first = 0; first < agentCount; first += m_agentsPerShard)
+	{
+		m_shards.emplace_back(std::make_unique<TrainingShard>(GetBrainConfig(), first, (std::min)(m_agentsPerShard, agentCount - first), physicsBackend, brainType,
+			seed, SHARD_STREAM + static_cast<unsigned>(m_shards.size())));
+	}
 }
 
 TrainingScene::~TrainingScene()
 {
-	m_physicsMgr->GetContactListener().ClearListenerFunctions();
 }
 
 void TrainingScene::Update(float dt)
 {
+	PROFILE_SCOPE("TrainingScene::Update");
+
 	// update bg parallax bg 
 	m_bgTimer += dt * 0.25f;
-	
-	m_physicsMgr->Update(dt);
 
-	if ((m_obstacleSpawnTimer -= dt) <= 0.f)
+	// shards share nothing while stepping
+	if (m_threadPool && m_shards.size() > 1)
 	{
-		SpawnObstacle();
-		m_obstacleSpawnTimer = SceneConstants::ObstacleSpawnTime;
+		m_threadPool->ParallelFor(static_cast<unsigned>(m_shards.size()), [&](unsigned shard) { m_shards[shard]->Update(dt); });
 	}
-
-	for (auto & bird : m_birds)
+	else
 	{
-		// compute distances
-		PhysicBodyPtr nearestObj = GetNearestObstacle();
-		PhysicBodyPtr secNearestObj = GetSecondNearestObstacle();
-		float computeMid	= 0.5f * (reinterpret_cast<PhysicsBody*>(nearestObj->GetUserData())->GetPosition().y + nearestObj->GetPosition().y);
-		float computeMid2	= secNearestObj ? 0.5f * (reinterpret_cast<PhysicsBody*>(secNearestObj->GetUserData())->GetPosition().y + secNearestObj->GetPosition().y) : 0.f;
-		
-		if ((bird.m_delay -= dt) <= 0.f)	// delay to simulate finger tapping
+		for (auto & shard : m_shards)
 		{
-			float input[static_cast<unsigned>(InputType::COUNT)];
-			input[static_cast<unsigned>(InputType::DIST_FROM_OBSTACLE)]					= nearestObj->GetPosition().x - bird.m_bird->GetPosition().x;
-			input[static_cast<unsigned>(InputType::HEIGHT_FROM_NEAREST_HOLE)]			= computeMid - bird.m_bird->GetPosition().y;
-			input[static_cast<unsigned>(InputType::HEIGHT_FROM_SECOND_NEAREST_HOLE)]	= computeMid2 - bird.m_bird->GetPosition().y;
-
-			if (bird.m_ann->Run(input)[0] >= 0.f)
-			{
-				bird.m_bird->SetVelocity(math::vec2(0.f, SceneConstants::FlapStrength));
-				bird.m_delay = SceneConstants::FlapDelay;
-			}
+			shard->Update(dt);
 		}
+	}
 
-		if ((bird.m_animTimer += dt) >= 0.025f)
+	// every shard sees the same obstacles, the ones still running agree on the score
+	bool isAlive = false;
+	for (auto & shard : m_shards)
+	{
+		if (shard->GetLiveBirdCount() > 0)
 		{
-			bird.m_animTimer = 0.f;
-			bird.m_currFrame = (bird.m_currFrame + 1) % 14;
+			m_currScore	= (std::max)(m_currScore, shard->GetScore());
+			isAlive		= true;
 		}
-
-		float maxDeg = bird.m_bird->GetVelocity().y < 0.f ? -45.f : 45.f;
-		bird.m_currAngle = Interpolate(0.f, maxDeg, fabs(bird.m_bird->GetVelocity().y) / SceneConstants::FlapStrength);
 	}
+	m_maxScore = (std::max)(m_maxScore, m_currScore);
 
-	if (m_birds.empty())
+	if (!isAlive)
 	{
 		RestartGame();
 	}
 }
 
-void TrainingScene::Render() const
+#ifndef NN_HEADLESS
+void TrainingScene::Render(GraphicsManager& graphicsMgr) const
 {
 	// render background
 	{
@@ -97,23 +98,26 @@ void TrainingScene::Render() const
 		textureInfo.m_rows = 1;
 		textureInfo.m_currFrame = m_bgTimer;
 		textureInfo.m_tint = math::vec4(1.f, 1.f, 1.f, 1.f);
-		m_graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, math::vec2(), m_graphicsMgr.GetVirtualWindowSize(), 0.f);
+		graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, math::vec2(), graphicsMgr.GetVirtualWindowSize(), 0.f);
 	}
 
-	// render birds
-	for (auto & bird : m_birds)
+	// render birds of every shard
+	for (auto & shard : m_shards)
 	{
-		GLRenderer::TextureInfo textureInfo;
-		textureInfo.m_textureName = "Assets/bird_anim.png";
-		textureInfo.m_cols = 5;
-		textureInfo.m_rows = 3;
-		textureInfo.m_currFrame = static_cast<float>(bird.m_currFrame);
-		textureInfo.m_tint = bird.m_birdColor;
-		m_graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, bird.m_bird->GetPosition(), bird.m_bird->GetSize(), bird.m_currAngle);
+		for (auto & bird : shard->GetBirds())
+		{
+			GLRenderer::TextureInfo textureInfo;
+			textureInfo.m_textureName = "Assets/bird_anim.png";
+			textureInfo.m_cols = 5;
+			textureInfo.m_rows = 3;
+			textureInfo.m_currFrame = static_cast<float>(bird.m_currFrame);
+			textureInfo.m_tint = bird.m_birdColor;
+			graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, bird.m_bird->GetPosition(), bird.m_bird->GetSize(), bird.m_currAngle);
+		}
 	}
 
-	// render obstacles
-	for (auto & obstacle : m_obstacles)
+	// render obstacles, identical in every running shard
+	for (auto & obstacle : GetDisplayShard().GetObstacles().GetAll())
 	{
 		GLRenderer::TextureInfo textureInfo;
 		textureInfo.m_textureName = "Assets/pole.png";
@@ -122,13 +126,18 @@ void TrainingScene::Render() const
 		textureInfo.m_currFrame = 0;
 		textureInfo.m_tint = math::vec4(1.f, 1.f, 1.f, 1.f);
 
-		m_graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, obstacle->GetPosition(), obstacle->GetSize(), obstacle->GetAngle());
+		for (const PhysicsBody* pole : { obstacle.m_lower.get(), obstacle.m_upper.get() })
+		{
+			if (pole)
+				graphicsMgr.GetRenderer().AddTextureToScene(textureInfo, pole->GetPosition(), pole->GetSize(), pole->GetAngle());
+		}
 	}
 }
+#endif
 
 PhysicsManager & TrainingScene::GetPhysicsManager() const
 {
-	return *m_physicsMgr;
+	return GetDisplayShard().GetPhysicsManager();
 }
 
 unsigned TrainingScene::GetCurrentScore() const
@@ -148,52 +157,69 @@ unsigned TrainingScene::GetCurrentGeneration() const
 
 unsigned TrainingScene::GetLiveBirdCount() const
 {
-	return m_birds.size();
+	unsigned count = 0;
+	for (auto & shard : m_shards)
+	{
+		count += shard->GetLiveBirdCount();
+	}
+	return count;
 }
 
-void TrainingScene::StartGame()
+std::vector<std::vector<fann_type>> TrainingScene::GetElites(unsigned count) const
 {
-	float height = 385.f;
+	count = (std::min)(count, static_cast<unsigned>(m_eliteRows.size()));
 
-	PhysicBodyPtr groundA = m_physicsMgr->AddBox(math::vec2(0.f, -height), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC);
-	groundA->SetCategoryBits(static_cast<uint16>(ObjectType::GROUND));
-	groundA->SetName("Ground");
-	groundA->SetDebugFill(true);
-	groundA->SetDebugColor(DEBUG_YELLOW);
+	std::vector<std::vector<fann_type>> elites;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const fann_type* genome = m_genomes.GetBack(m_eliteRows[i]);
+		elites.emplace_back(genome, genome + m_genomes.GetGenomeSize());
+	}
+	return elites;
+}
 
-	PhysicBodyPtr groundB = m_physicsMgr->AddBox(math::vec2(0.f, height), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC);
-	groundB->SetCategoryBits(static_cast<uint16>(ObjectType::GROUND));
-	groundB->SetName("Ground");
-	groundB->SetDebugFill(true);
-	groundB->SetDebugColor(DEBUG_YELLOW);
+void TrainingScene::ImportMigrants(const std::vector<std::vector<fann_type>>& migrants)
+{
+	m_migrants.insert(m_migrants.end(), migrants.begin(), migrants.end());
+}
 
-	PhysicBodyPtr destroyer = m_physicsMgr->AddBox(math::vec2(-750.f, 0.f), math::vec2(50.f, 1000.f), 0.f, PhysicsManager::BodyType::STATIC);
-	destroyer->SetCategoryBits(static_cast<uint16>(ObjectType::DESTROYER));
-	destroyer->SetName("Destroyer");
+void TrainingScene::StartGame()
+{
+	// one obstacle stream per generation, replayed by every shard
+	unsigned obstacleSeed = static_cast<unsigned>(m_seedRandomizer.GetRandomInt());
+	for (auto & shard : m_shards)
+	{
+		shard->Reset(obstacleSeed);
+	}
 
 	m_currGeneration++;
 }
 
 void TrainingScene::RestartGame()
 {
+	PROFILE_SCOPE("TrainingScene::RestartGame");
+
 	// reset variables
 	m_currScore				= 0;
-	m_obstacleSpawnTimer	= 0.f;
 	m_bgTimer				= 0.f;
 
-	// reset physics
-	m_obstacles.clear();
-	m_physicsMgr->Clear();
-	
+	// merge the death records of every shard
+	for (auto & shard : m_shards)
+	{
+		shard->TakeDeathRecords(m_collectedWeights);
+	}
+
 	// start game
 	StartGame();
 
 	// start of the scene, randomize weights first
 	if (m_collectedWeights.empty())
 	{
+		// the rows are contiguous, one fill for the whole population
+		m_randomizer.FillUniform(m_genomes.GetFront(0), static_cast<size_t>(m_agentCount) * m_genomes.GetGenomeSize());
 		for (unsigned i = 0; i < m_agentCount; ++i)
 		{
-			m_birds.emplace_back(std::move(SpawnBird()));
+			SpawnBird(i, m_genomes.GetFront(i));
 		}
 	}
 	else
@@ -203,235 +229,114 @@ void TrainingScene::RestartGame()
 	}
 }
 
-void TrainingScene::ContactEnterCallback(const ContactInfo & contactInfo)
-{
-	bool isABird		= contactInfo.m_bodyA->GetName() == "Bird";
-	bool isBBird		= contactInfo.m_bodyB->GetName() == "Bird";
-	bool isAObstacle	= contactInfo.m_bodyA->GetName() == "Obstacle";
-	bool isBObstacle	= contactInfo.m_bodyB->GetName() == "Obstacle";
-	bool isADestroyer	= contactInfo.m_bodyA->GetName() == "Destroyer";
-	bool isBDestroyer	= contactInfo.m_bodyB->GetName() == "Destroyer";
-	bool isAGround		= contactInfo.m_bodyA->GetName() == "Ground";
-	bool isBGround		= contactInfo.m_bodyB->GetName() == "Ground";
-
-	if ((isAObstacle && isBDestroyer) || (isBObstacle && isADestroyer))
-	{
-		PhysicsBody* body = isAObstacle ? contactInfo.m_bodyA : contactInfo.m_bodyB;
-		auto it = std::find_if(m_obstacles.begin(), m_obstacles.end(), [&](const PhysicBodyPtr& ptr) { return &(*ptr) == body; });
-		if (it != m_obstacles.end())
-		{
-			body->Destroy();
-			++m_currScore;
-			m_maxScore = max(m_maxScore, m_currScore);
-			m_obstacles.erase(it);
-		}
-	}
-	else if (	(isABird && isBObstacle) || 
-				(isBBird && isAObstacle) ||
-				(isABird && isBGround)	 ||
-				(isBBird && isAGround)	)
-	{
-		PhysicBodyPtr nearestObj = GetNearestObstacle();
-		PhysicsBody* pBody = isABird ? contactInfo.m_bodyA : contactInfo.m_bodyB;
-		auto it = std::find_if(m_birds.begin(), m_birds.end(), [&](const BirdInfo& info) { return &(*info.m_bird) == pBody; });
-		if (it != m_birds.end())
-		{
-			WeightInfo weight;
-			weight.m_distFromHole		= fabs(pBody->GetPosition().y - 0.5f * (reinterpret_cast<PhysicsBody*>(nearestObj->GetUserData())->GetPosition().y + nearestObj->GetPosition().y));
-			weight.m_currPointsOnDeath	= m_currScore;
-			weight.m_weights			= it->m_ann->GetWeights();
-			m_collectedWeights.emplace_back(std::move(weight));
-
-			it->m_bird->Destroy();
-			m_birds.erase(it);
-		}
-	}
-}
-
-void TrainingScene::ContactExitCallback(const ContactInfo & contactInfo)
-{
-}
-
-std::shared_ptr<PhysicsBody> TrainingScene::GetNearestObstacle() const
+const TrainingShard& TrainingScene::GetDisplayShard() const
 {
-	float birdBackX = m_birds.front().m_bird->GetPosition().x - m_birds.front().m_bird->GetSize().x * 0.5f;
-	std::vector<PhysicBodyPtr> const & allBodies = m_physicsMgr->GetAllBodies();
-
-	int idx = -1;
-	float currDist = FLT_MAX;
-
-	for (unsigned i = 0; i < allBodies.size(); ++i)
+	for (auto & shard : m_shards)
 	{
-		if (allBodies[i]->GetName() == "Obstacle")
+		if (shard->GetLiveBirdCount() > 0)
 		{
-			float xFront = allBodies[i]->GetPosition().x + allBodies[i]->GetSize().x * 0.5f;
-			float diff = xFront - birdBackX;
-			if (diff > 0.f && currDist > diff)
-			{
-				currDist = diff;
-				idx = static_cast<int>(i);
-			}
+			return *shard;
 		}
 	}
-	return idx == -1 ? nullptr : allBodies[idx];
+	return *m_shards.front();
 }
 
-std::shared_ptr<PhysicsBody> TrainingScene::GetSecondNearestObstacle() const
+ANNWrapper::ANNConfig TrainingScene::GetBrainConfig()
 {
-	float birdBackX = m_birds.front().m_bird->GetPosition().x - m_birds.front().m_bird->GetSize().x * 0.5f;
-	std::vector<PhysicBodyPtr> const & allBodies = m_physicsMgr->GetAllBodies();
-
-	int idx = -1;
-	float currDist = FLT_MAX, currDist2 = FLT_MAX;
-
-	for (unsigned i = 0; i < allBodies.size(); ++i)
-	{
-		if (allBodies[i]->GetName() == "Obstacle")
-		{
-			float xFront = allBodies[i]->GetPosition().x + allBodies[i]->GetSize().x * 0.5f;
-			float diff = xFront - birdBackX;
-			if (diff > 0.f)
-			{
-				if (currDist > diff)
-				{
-					currDist = diff;
-				}
-				else if (currDist < diff && diff < currDist2)
-				{
-					currDist2 = diff;
-					idx = static_cast<int>(i);
-				}
-			}
-		}
-	}
-	return idx == -1 ? nullptr : allBodies[idx];
-}
-
-TrainingScene::BirdInfo TrainingScene::SpawnBird() const
-{
-	BirdInfo info = SpawnBird(std::vector<fann_type>());
-	return info;
-}
-
-TrainingScene::BirdInfo TrainingScene::SpawnBird(const std::vector<fann_type>& weights) const
-{
-	BirdInfo info;
-
-	info.m_bird = m_physicsMgr->AddCircle(math::vec2(-400.f, 0.f), SceneConstants::BirdSize * 0.5f, 0.f, PhysicsManager::BodyType::DYNAMIC);
-
-	info.m_bird->SetName("Bird");
-	info.m_bird->SetIsSensor(true);
-	info.m_bird->SetCategoryBits(static_cast<uint16>(ObjectType::BIRD));
-	info.m_bird->SetMaskBits(static_cast<uint16>(ObjectType::GROUND) | static_cast<uint16>(ObjectType::OBSTACLE));
-	info.m_bird->SetGravityScale(4.f);
-
-	info.m_currAngle = 0.f;
-	info.m_currFrame = 0;
-	info.m_animTimer = 0.f;
-
-	static Randomizer colRandomizer(0.f, 1.f);
-	info.m_birdColor = math::vec4(colRandomizer.GetRandomFloat(), colRandomizer.GetRandomFloat(), colRandomizer.GetRandomFloat(), 1.f);
-
-	info.m_delay = 0.f;
-
 	ANNWrapper::ANNConfig config;
 	config.m_epochsBtwnReports	= 5000;
 	config.m_maxEpochs			= 10000;
 	config.m_maxErr				= 0.001f;
-	config.m_numInputs			= static_cast<int>(InputType::COUNT);
+	config.m_numInputs			= static_cast<int>(TrainingShard::InputType::COUNT);
 	config.m_numLayers			= 2;
 	config.m_numNeuronsInHidden = 3;
 	config.m_numOutputs			= 1;
-	info.m_ann = std::make_unique<ANNWrapper>(config);
-
-	if (weights.empty())
-		info.m_ann->RandomizeWeights();
-	else
-		info.m_ann->SetWeights(weights);
-
-	return info;
+	return config;
 }
 
-void TrainingScene::SpawnObstacle()
+void TrainingScene::SpawnBird(unsigned agent, const fann_type* weights)
 {
-	const float obstacleLt		= 600.f;
-	const float obstacleSPos	= 650.f;
-
-	float rndHeight = SceneConstants::HoleDistanceRange * m_randomizer.GetRandomFloat();
-	float obstacleHalfHt = (obstacleLt + SceneConstants::HoleHeight) * 0.5f;
-
-	PhysicBodyPtr obstacles[]
-	{
-		m_physicsMgr->AddBox(math::vec2(obstacleSPos, rndHeight - obstacleHalfHt), math::vec2(90.f, obstacleLt), 0.f, PhysicsManager::BodyType::DYNAMIC),	// lower
-		m_physicsMgr->AddBox(math::vec2(obstacleSPos, rndHeight + obstacleHalfHt), math::vec2(90.f, obstacleLt), 180.f, PhysicsManager::BodyType::DYNAMIC)	// upper
-	};
-
-	// set user data
-	obstacles[0]->SetUserData(&(*obstacles[1]));
-	obstacles[1]->SetUserData(&(*obstacles[0]));
-
-	for (auto & obstacle : obstacles)
-	{
-		obstacle->SetName("Obstacle");
-		obstacle->SetCategoryBits(static_cast<uint16>(ObjectType::OBSTACLE));
-		obstacle->SetMaskBits(static_cast<uint16>(ObjectType::BIRD) | static_cast<uint16>(ObjectType::DESTROYER));
-		obstacle->SetVelocity(math::vec2(-SceneConstants::ObstacleInitialSpeed, 0.f));
-		obstacle->SetIsSensor(true);
-		obstacle->SetGravityScale(0.f);
-
-		m_obstacles.emplace_back(std::move(obstacle));
-	}
+	m_shards[agent / m_agentsPerShard]->SpawnBird(weights);
 }
 
 void TrainingScene::Selection()
 {
-	// sort points then dist
+	// sort points then dist, ties by agent so the order the shards merged their records in does not matter
 	std::sort(m_collectedWeights.begin(), m_collectedWeights.end(), [](const WeightInfo& l, const WeightInfo & r)
 	{
-		if (l.m_currPointsOnDeath > r.m_currPointsOnDeath)
-			return true;
-		if (l.m_currPointsOnDeath < r.m_currPointsOnDeath)
-			return false;
-		return l.m_distFromHole < r.m_distFromHole;
+		if (l.m_currPointsOnDeath != r.m_currPointsOnDeath)
+			return l.m_currPointsOnDeath > r.m_currPointsOnDeath;
+		if (l.m_distFromHole != r.m_distFromHole)
+			return l.m_distFromHole < r.m_distFromHole;
+		return l.m_agent < r.m_agent;
 	});
 
 	// get only 10%
-	int max_parents_count = max(2, static_cast<int>(ceil(m_agentCount * 0.1f)));
-	m_collectedWeights = std::vector<WeightInfo>(m_collectedWeights.begin(), m_collectedWeights.begin() + max_parents_count);
+	unsigned recordCount = static_cast<unsigned>(m_collectedWeights.size());
+	unsigned parentCount = (std::min)((std::max)(2u, static_cast<unsigned>(ceil(m_agentCount * 0.1f))), recordCount);
+
+	m_parents.clear();
+	for (unsigned i = 0; i < parentCount; ++i)
+	{
+		m_parents.emplace_back(m_collectedWeights[i].m_agent);
+	}
+	m_eliteRows.assign(m_parents.begin(), m_parents.end());
+
+	// migrants take the place of the weakest parents, the best local parent always stays.
+	// they are stored over the genomes of the weakest birds, which never breed
+	unsigned migrantCount = (std::min)(static_cast<unsigned>(m_migrants.size()), (std::min)(parentCount - 1, recordCount - parentCount));
+	for (unsigned i = 0; i < migrantCount; ++i)
+	{
+		assert(m_migrants[i].size() == m_genomes.GetGenomeSize());
+		unsigned row = m_collectedWeights[recordCount - 1 - i].m_agent;
+		std::copy(m_migrants[i].begin(), m_migrants[i].end(), m_genomes.GetFront(row));
+		m_parents[parentCount - 1 - i] = row;
+	}
+	m_migrants.clear();
 }
 
 void TrainingScene::Crossover()
 {
 	// genetic algorithm starts here
+	unsigned genomeSize = m_genomes.GetGenomeSize();
+	unsigned weightSize = genomeSize >> 1;	// 1/2 of the weights will be crossed over 
+
+	// three rolls in [-1, 1) per crossed gene: crossover or mutation, gene index, mutated value
+	m_crossoverRolls.resize(static_cast<size_t>(m_agentCount) * weightSize * 3);
+	m_randomizer.FillUniform(m_crossoverRolls.data(), m_crossoverRolls.size());
+	const float* roll = m_crossoverRolls.data();
+
 	for (unsigned i = 0; i < m_agentCount; ++i)
 	{
-		int currIdx = i % m_collectedWeights.size(), other;
+		int currIdx = i % m_parents.size(), other;
 		do
 		{
-			other = rand() % m_collectedWeights.size();
+			other = m_randomizer.GetRandomIndex(static_cast<unsigned>(m_parents.size()));
 		} while (other == currIdx);
 
-		const std::vector<fann_type>& parentA = m_collectedWeights[currIdx].m_weights;
-		const std::vector<fann_type>& parentB = m_collectedWeights[other].m_weights;
-		std::vector<fann_type> child = parentA;
+		const fann_type* parentA = m_genomes.GetFront(m_parents[currIdx]);
+		const fann_type* parentB = m_genomes.GetFront(m_parents[other]);
+		fann_type* child = m_genomes.GetBack(i);
+		std::copy(parentA, parentA + genomeSize, child);
 
-		unsigned weightSize = child.size() >> 1;	// 1/2 of the weights will be crossed over 
-		for (unsigned i = 0; i < weightSize; ++i)
+		for (unsigned i = 0; i < weightSize; ++i, roll += 3)
 		{
-			float probability = (m_randomizer.GetRandomFloat() + 1.f) * 0.5f;
+			float probability = (roll[0] + 1.f) * 0.5f;
+			unsigned rndNum = (std::min)(genomeSize - 1, static_cast<unsigned>((roll[1] + 1.f) * 0.5f * genomeSize));
 			if (probability <= 0.9f)
 			{
-				int rndNum = rand() % parentB.size();
-				child[rndNum] = parentB[rndNum];									// get gene from B parent
+				child[rndNum] = parentB[rndNum];		// get gene from B parent
 			}
 			else
 			{
-				child[rand() % child.size()] = m_randomizer.GetRandomFloat();		// mutated gene
+				child[rndNum] = roll[2];				// mutated gene
 			}
 		}
 
-		m_birds.emplace_back(std::move(SpawnBird(child)));
+		SpawnBird(i, child);
 	}
 
+	// the children are the running generation now, the parents stay in the back until the next breeding
+	m_genomes.Swap();
 	m_collectedWeights.clear();
 }
\ No newline at end of file
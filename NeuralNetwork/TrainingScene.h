@@ -9,91 +9,77 @@
 
 #include "math.h"
 #include "Randomizer.h"
+#include "ANNWrapper.h"
+#include "TrainingShard.h"
+#include "GenomeBuffer.h"
 
-class ANNWrapper;
-class PhysicsBody;
+class ThreadPool;
 class PhysicsManager;
 class GraphicsManager;
 
-struct ContactInfo;
-
 class TrainingScene
 {
 public:
-	TrainingScene(GraphicsManager& graphicsMgr, unsigned agentCount);
+	// with shardCount > 1 every generation is split over shards stepped on threadPool.
+	// equal seeds give equal generations whatever the thread count
+	TrainingScene(unsigned agentCount, unsigned shardCount = 1, ThreadPool* threadPool = nullptr, PhysicsManager::BackendType physicsBackend = PhysicsManager::BackendType::BOX2D,
+		TrainingShard::BrainType brainType = TrainingShard::BrainType::POPULATION, uint64_t seed = Randomizer::DEFAULT_SEED);
 	virtual ~TrainingScene();
 	virtual void Update(float dt);
-	virtual void Render() const;
+#ifndef NN_HEADLESS
+	virtual void Render(GraphicsManager& graphicsMgr) const;
+#endif
 
+	// physics of the first shard that still has birds alive
 	PhysicsManager & GetPhysicsManager() const;
 	unsigned GetCurrentScore() const;
 	unsigned GetMaxScore() const;
 	unsigned GetCurrentGeneration() const;
 	unsigned GetLiveBirdCount() const;
 
+	// island model: parents of the last finished generation, best first
+	std::vector<std::vector<fann_type>> GetElites(unsigned count) const;
+	// genomes from another island, they replace the weakest parents of the next generation
+	void ImportMigrants(const std::vector<std::vector<fann_type>>& migrants);
+
 protected:
+	using WeightInfo = TrainingShard::WeightInfo;
+
 	void StartGame();
 	void RestartGame();
 
-	virtual void ContactEnterCallback(const ContactInfo & contactInfo);
-	virtual void ContactExitCallback(const ContactInfo & contactInfo);
+	// genetic algorithm over m_collectedWeights, the death records merged by RestartGame
+	void Selection();
+	void Crossover();
 
 	bool							m_gameRestarting;
-	std::unique_ptr<PhysicsManager> m_physicsMgr;
+	std::vector<WeightInfo>			m_collectedWeights;
 
 private:
-	enum class ObjectType
+	// streams of the scene seed
+	enum RandomStream : unsigned
 	{
-		BIRD		= 1 << 1,
-		GROUND		= 1 << 2,
-		OBSTACLE	= 1 << 3,
-		DESTROYER	= 1 << 4
+		GA_STREAM,
+		OBSTACLE_STREAM,
+		SHARD_STREAM		// + shard index, bird colors
 	};
 
-	enum class InputType
-	{
-		DIST_FROM_OBSTACLE,
-		HEIGHT_FROM_NEAREST_HOLE,
-		HEIGHT_FROM_SECOND_NEAREST_HOLE,
-		COUNT
-	};
-
-	struct BirdInfo
-	{
-		std::unique_ptr<ANNWrapper>		m_ann;
-		std::shared_ptr<PhysicsBody>	m_bird;
-		float							m_delay;
-		float							m_animTimer;
-		unsigned						m_currFrame;
-		math::vec4						m_birdColor;
-		float							m_currAngle;
-	};
-
-	struct WeightInfo
-	{
-		std::vector<fann_type>	m_weights;
-		float					m_distFromHole;
-		unsigned				m_currPointsOnDeath;
-	};
-
-	std::shared_ptr<PhysicsBody> GetNearestObstacle() const;
-	std::shared_ptr<PhysicsBody> GetSecondNearestObstacle() const;
-	BirdInfo SpawnBird() const;
-	BirdInfo SpawnBird(const std::vector<fann_type>& weights ) const;
-	void SpawnObstacle();
-
-	// genetic algorithm
-	void Selection();
-	void Crossover();
+	static ANNWrapper::ANNConfig GetBrainConfig();
+	const TrainingShard& GetDisplayShard() const;
+	void SpawnBird(unsigned agent, const fann_type* weights);
 
 	float					m_bgTimer;
-	float					m_obstacleSpawnTimer;
-	std::vector<BirdInfo>	m_birds;
 	unsigned				m_agentCount;
+	unsigned				m_agentsPerShard;
+	std::vector<std::unique_ptr<TrainingShard>> m_shards;
+	ThreadPool*				m_threadPool;
 	Randomizer				m_randomizer;
-	std::vector<WeightInfo>	m_collectedWeights;
-	GraphicsManager&		m_graphicsMgr;
+	Randomizer				m_seedRandomizer;
+	GenomeBuffer			m_genomes;			// row = agent
+	std::vector<unsigned>	m_parents;			// rows of the front genomes
+	std::vector<unsigned>	m_eliteRows;		// rows of the back genomes after breeding
+	std::vector<std::vector<fann_type>> m_migrants;
+	std::vector<float>		m_crossoverRolls;	// bulk random draws of one breeding
 	unsigned				m_currScore, m_maxScore;
 	unsigned				m_currGeneration;
-	std::vector<std::shared_ptr<PhysicsBody>> m_obstacles;
 };
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "TrainingShard.h"
+
+#include "ANNPopulation.h"
+#include "DebugColors.h"
+#include "PhysicsBody.h"
+#include "Profiler.h"
+#include "PhysicsManager.h"
+#include "SceneConstants.h"
+#include "PhysicsContactListener.h"
+
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+
+const unsigned TrainingShard::NO_BIRD = ~0u;
+
+TrainingShard::TrainingShard(const ANNWrapper::ANNConfig& brainConfig, unsigned firstAgent, unsigned capacity, PhysicsManager::BackendType physicsBackend, BrainType brainType, uint64_t seed, unsigned stream) :
+	m_physicsMgr(std::make_unique<PhysicsManager>(math::vec2(0.f, -9.8f), physicsBackend)),
+	m_firstAgent(firstAgent),
+	m_brainType(brainType),
+	m_population(brainType == BrainType::POPULATION ? std::make_unique<ANNPopulation>(brainConfig, capacity) : nullptr),
+	m_fixedBrains(brainType == BrainType::FIXED ? capacity : 0),
+	m_fixedOutputs(m_fixedBrains.size() * FixedBrain::NUM_OUTPUTS),
+	m_birdIndices(capacity, NO_BIRD),
+	m_obstacleRandomizer(-1.f, 1.f),
+	m_colorRandomizer(0.f, 1.f, seed, stream),
+	m_obstacleSpawnTimer(0.f),
+	m_currScore(0)
+{
+	assert(brainType != BrainType::FIXED || ANNWrapper::GetLayerSizes(brainConfig) == FixedBrain::GetLayerSizes());
+	assert(brainType != BrainType::FIXED || ANNWrapper::ACTIVATION_FUNCTION == FANN_SIGMOID_SYMMETRIC);
+
+	// only the bodies of a contact are used, handled in bulk after the step
+	PhysicsContactListener& listener = m_physicsMgr->GetContactListener();
+	listener.SetDeferred(true);
+	listener.SetManifoldsRequired(false);
+	listener.Reserve(2 * capacity + 16);
+	listener.SetBeginContactBatchHandler(static_cast<uint8_t>(ObjectType::BIRD), static_cast<uint8_t>(ObjectType::OBSTACLE), &TrainingShard::BirdDeathContacts, this);
+	listener.SetBeginContactBatchHandler(static_cast<uint8_t>(ObjectType::BIRD), static_cast<uint8_t>(ObjectType::GROUND), &TrainingShard::BirdDeathContacts, this);
+	listener.SetBeginContactHandler(static_cast<uint8_t>(ObjectType::OBSTACLE), static_cast<uint8_t>(ObjectType::DESTROYER), &TrainingShard::ObstacleDestroyerContact, this);
+}
+
+TrainingShard::~TrainingShard()
+{
+	m_physicsMgr->GetContactListener().ClearListenerFunctions();
+}
+
+void TrainingShard::Reset(unsigned obstacleSeed)
+{
+	// reset variables
+	m_currScore				= 0;
+	m_obstacleSpawnTimer	= 0.f;
+	m_obstacleRandomizer.Seed(obstacleSeed);
+
+	// reset physics
+	m_birds.clear();
+	std::fill(m_birdIndices.begin(), m_birdIndices.end(), NO_BIRD);
+	m_obstacles.Clear();
+	m_physicsMgr->Reset();
+
+	float height = 385.f;
+
+	PhysicBodyPtr groundA = m_physicsMgr->AddBox(math::vec2(0.f, -height), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC);
+	SetObjectType(*groundA, ObjectType::GROUND);
+	groundA->SetDebugFill(true);
+	groundA->SetDebugColor(DEBUG_YELLOW);
+
+	PhysicBodyPtr groundB = m_physicsMgr->AddBox(math::vec2(0.f, height), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC);
+	SetObjectType(*groundB, ObjectType::GROUND);
+	groundB->SetDebugFill(true);
+	groundB->SetDebugColor(DEBUG_YELLOW);
+
+	PhysicBodyPtr destroyer = m_physicsMgr->AddBox(math::vec2(-750.f, 0.f), math::vec2(50.f, 1000.f), 0.f, PhysicsManager::BodyType::STATIC);
+	SetObjectType(*destroyer, ObjectType::DESTROYER);
+}
+
+void TrainingShard::SpawnBird(const fann_type* weights)
+{
+	BirdInfo info;
+
+	info.m_bird = m_physicsMgr->AddCircle(math::vec2(-400.f, 0.f), SceneConstants::BirdSize * 0.5f, 0.f, PhysicsManager::BodyType::DYNAMIC);
+
+	info.m_bird->SetIsSensor(true);
+	SetObjectType(*info.m_bird, ObjectType::BIRD);
+	info.m_bird->SetMaskBits(GetCategoryBits(ObjectType::GROUND) | GetCategoryBits(ObjectType::OBSTACLE));
+	info.m_bird->SetGravityScale(4.f);
+
+	info.m_currAngle = 0.f;
+	info.m_currFrame = 0;
+	info.m_animTimer = 0.f;
+
+	info.m_birdColor = math::vec4(m_colorRandomizer.GetRandomFloat(), m_colorRandomizer.GetRandomFloat(), m_colorRandomizer.GetRandomFloat(), 1.f);
+
+	info.m_delay = 0.f;
+
+	// birds are spawned in order, the brain of a bird is in the slot of its position in m_birds
+	info.m_agentIdx = static_cast<unsigned>(m_birds.size());
+	info.m_bird->SetOwner(info.m_agentIdx);
+	m_birdIndices[info.m_agentIdx] = static_cast<unsigned>(m_birds.size());
+	SetBrainWeights(static_cast<unsigned>(m_birds.size()), weights);
+
+	m_birds.emplace_back(std::move(info));
+}
+
+void TrainingShard::Update(float dt)
+{
+	// the generation of this shard is over, wait for the others
+	if (m_birds.empty())
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("TrainingShard::Update");
+
+	m_physicsMgr->Update(dt);
+
+	if ((m_obstacleSpawnTimer -= dt) <= 0.f)
+	{
+		SpawnObstacle();
+		m_obstacleSpawnTimer = SceneConstants::ObstacleSpawnTime;
+	}
+
+	// the last birds may have died during the step
+	if (m_birds.empty())
+	{
+		return;
+	}
+
+	// the obstacles ahead are the same for every bird, find them once per tick
+	m_obstacles.Advance(GetBirdBackX());
+	const ObstacleQueue::Obstacle* nearestObj		= m_obstacles.GetNearest(0);
+	const ObstacleQueue::Obstacle* secNearestObj	= m_obstacles.GetNearest(1);
+	float nearestX		= nearestObj->GetX();
+	float computeMid	= nearestObj->GetHoleY();
+	float computeMid2	= secNearestObj ? secNearestObj->GetHoleY() : 0.f;
+
+	{
+		PROFILE_SCOPE("TrainingShard::Brains");
+
+		// gather sensor inputs of the live birds, their brains are the first slots
+		unsigned liveCount = static_cast<unsigned>(m_birds.size());
+		for (unsigned slot = 0; slot < liveCount; ++slot)
+		{
+			const BirdInfo& bird = m_birds[slot];
+			float input[static_cast<unsigned>(InputType::COUNT)];
+			input[static_cast<unsigned>(InputType::DIST_FROM_OBSTACLE)]					= nearestX - bird.m_bird->GetPosition().x;
+			input[static_cast<unsigned>(InputType::HEIGHT_FROM_NEAREST_HOLE)]			= computeMid - bird.m_bird->GetPosition().y;
+			input[static_cast<unsigned>(InputType::HEIGHT_FROM_SECOND_NEAREST_HOLE)]	= computeMid2 - bird.m_bird->GetPosition().y;
+
+			if (m_brainType == BrainType::FIXED)
+				m_fixedBrains[slot].Run(input, &m_fixedOutputs[slot * FixedBrain::NUM_OUTPUTS]);
+			else
+				m_population->SetInputs(slot, input);
+		}
+
+		// evaluate the brains of the live birds in one pass
+		if (m_brainType == BrainType::POPULATION)
+			m_population->Run(liveCount);
+	}
+
+	for (unsigned slot = 0; slot < static_cast<unsigned>(m_birds.size()); ++slot)
+	{
+		BirdInfo& bird = m_birds[slot];
+		if ((bird.m_delay -= dt) <= 0.f)	// delay to simulate finger tapping
+		{
+			fann_type output = m_brainType == BrainType::FIXED ?
+				m_fixedOutputs[slot * FixedBrain::NUM_OUTPUTS] :
+				m_population->GetOutput(slot, 0);
+			if (output >= 0.f)
+			{
+				bird.m_bird->SetVelocity(math::vec2(0.f, SceneConstants::FlapStrength));
+				bird.m_delay = SceneConstants::FlapDelay;
+			}
+		}
+
+		if ((bird.m_animTimer += dt) >= 0.025f)
+		{
+			bird.m_animTimer = 0.f;
+			bird.m_currFrame = (bird.m_currFrame + 1) % 14;
+		}
+
+		float maxDeg = bird.m_bird->GetVelocity().y < 0.f ? -45.f : 45.f;
+		bird.m_currAngle = Interpolate(0.f, maxDeg, fabs(bird.m_bird->GetVelocity().y) / SceneConstants::FlapStrength);
+	}
+}
+
+void TrainingShard::TakeDeathRecords(std::vector<WeightInfo>& records)
+{
+	std::move(m_deathRecords.begin(), m_deathRecords.end(), std::back_inserter(records));
+	m_deathRecords.clear();
+}
+
+PhysicsManager & TrainingShard::GetPhysicsManager() const
+{
+	return *m_physicsMgr;
+}
+
+const std::vector<TrainingShard::BirdInfo>& TrainingShard::GetBirds() const
+{
+	return m_birds;
+}
+
+const ObstacleQueue& TrainingShard::GetObstacles() const
+{
+	return m_obstacles;
+}
+
+unsigned TrainingShard::GetScore() const
+{
+	return m_currScore;
+}
+
+unsigned TrainingShard::GetLiveBirdCount() const
+{
+	return static_cast<unsigned>(m_birds.size());
+}
+
+unsigned TrainingShard::GetCapacity() const
+{
+	return m_brainType == BrainType::FIXED ? static_cast<unsigned>(m_fixedBrains.size()) : m_population->GetCapacity();
+}
+
+uint16_t TrainingShard::GetCategoryBits(ObjectType type)
+{
+	return static_cast<uint16_t>(1 << static_cast<unsigned>(type));
+}
+
+void TrainingShard::SetObjectType(PhysicsBody& body, ObjectType type)
+{
+	body.SetTypeId(static_cast<uint8_t>(type));
+	body.SetCategoryBits(GetCategoryBits(type));
+}
+
+void TrainingShard::ObstacleDestroyerContact(const ContactInfo & contactInfo)
+{
+	PhysicsBody* body = contactInfo.m_bodyA;
+	if (m_obstacles.Remove(body))
+	{
+		body->Destroy();
+		++m_currScore;
+	}
+}
+
+void TrainingShard::BirdDeathContacts(const ContactInfo * contacts, unsigned count)
+{
+	// the birds of an earlier batch of this step may have been the last ones
+	if (m_birds.empty())
+	{
+		return;
+	}
+
+	m_obstacles.Advance(GetBirdBackX());
+	const ObstacleQueue::Obstacle* nearestObj = m_obstacles.GetNearest(0);
+	float holeY = nearestObj ? nearestObj->GetHoleY() : 0.f;
+
+	for (unsigned i = 0; i < count; ++i)
+	{
+		PhysicsBody& bird = *contacts[i].m_bodyA;
+
+		// a bird touching several bodies in one step is only killed once
+		unsigned index = m_birdIndices[bird.GetOwner()];
+		if (index == NO_BIRD)
+		{
+			continue;
+		}
+
+		WeightInfo weight;
+		weight.m_distFromHole		= nearestObj ? fabs(bird.GetPosition().y - holeY) : 0.f;
+		weight.m_currPointsOnDeath	= m_currScore;
+		weight.m_agent				= m_firstAgent + bird.GetOwner();
+		m_deathRecords.emplace_back(std::move(weight));
+
+		bird.Destroy();
+
+		// swap with the last bird, its brain follows so the live brains stay the first slots
+		m_birdIndices[bird.GetOwner()] = NO_BIRD;
+		if (index != m_birds.size() - 1)
+		{
+			m_birds[index] = std::move(m_birds.back());
+			m_birdIndices[m_birds[index].m_agentIdx] = index;
+			MoveBrain(static_cast<unsigned>(m_birds.size() - 1), index);
+		}
+		m_birds.pop_back();
+	}
+}
+
+float TrainingShard::GetBirdBackX() const
+{
+	// every bird flies at the same x
+	const PhysicsBody& bird = *m_birds.front().m_bird;
+	return bird.GetPosition().x - bird.GetSize().x * 0.5f;
+}
+
+void TrainingShard::SetBrainWeights(unsigned slot, const fann_type* weights)
+{
+	if (m_brainType == BrainType::FIXED)
+		m_fixedBrains[slot].SetWeights(weights);
+	else
+		m_population->SetWeights(slot, weights);
+}
+
+void TrainingShard::MoveBrain(unsigned from, unsigned to)
+{
+	if (m_brainType == BrainType::FIXED)
+		m_fixedBrains[to] = m_fixedBrains[from];
+	else
+		m_population->CopyWeights(from, to);
+}
+
+void TrainingShard::SpawnObstacle()
+{
+	const float obstacleLt		= 600.f;
+	const float obstacleSPos	= 650.f;
+
+	float rndHeight = SceneConstants::HoleDistanceRange * m_obstacleRandomizer.GetRandomFloat();
+	float obstacleHalfHt = (obstacleLt + SceneConstants::HoleHeight) * 0.5f;
+
+	PhysicBodyPtr obstacles[]
+	{
+		m_physicsMgr->AddBox(math::vec2(obstacleSPos, rndHeight - obstacleHalfHt), math::vec2(90.f, obstacleLt), 0.f, PhysicsManager::BodyType::DYNAMIC),	// lower
+		m_physicsMgr->AddBox(math::vec2(obstacleSPos, rndHeight + obstacleHalfHt), math::vec2(90.f, obstacleLt), 180.f, PhysicsManager::BodyType::DYNAMIC)	// upper
+	};
+
+	for (auto & obstacle : obstacles)
+	{
+		SetObjectType(*obstacle, ObjectType::OBSTACLE);
+		obstacle->SetMaskBits(GetCategoryBits(ObjectType::BIRD) | GetCategoryBits(ObjectType::DESTROYER));
+		obstacle->SetVelocity(math::vec2(-SceneConstants::ObstacleInitialSpeed, 0.f));
+		obstacle->SetIsSensor(true);
+		obstacle->SetGravityScale(0.f);
+	}
+
+	m_obstacles.Push(std::move(obstacles[0]), std::move(obstacles[1]));
+}
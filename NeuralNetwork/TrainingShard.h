@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "FANN/fann.h"
+
+#include "math.h"
+#include "Randomizer.h"
+#include "ANNWrapper.h"
+#include "FixedANN.h"
+#include "ObstacleQueue.h"
+#include "PhysicsManager.h"
+
+class ANNPopulation;
+class PhysicsBody;
+
+struct ContactInfo;
+
+// one slice of a generation, simulated in its own physics world.
+// birds never interact, every shard replays the same seeded obstacle stream and
+// the selection orders ties by agent, not by the order the records were merged in,
+// so a population split over shards behaves exactly like one shared world
+// while the shards can be stepped on different threads.
+class TrainingShard
+{
+public:
+	enum class InputType
+	{
+		DIST_FROM_OBSTACLE,
+		HEIGHT_FROM_NEAREST_HOLE,
+		HEIGHT_FROM_SECOND_NEAREST_HOLE,
+		COUNT
+	};
+
+	enum class BrainType
+	{
+		POPULATION,		// any topology, the whole shard evaluated in one batched pass
+		FIXED			// FixedBrain per bird, topology fixed at compile time
+	};
+
+	// must match TrainingScene::GetBrainConfig and ANNWrapper::ACTIVATION_FUNCTION
+	using FixedBrain = FixedANN<FixedANNSigmoidSymmetric<ANNWrapper::ACTIVATION_STEEPNESS_PERCENT>, static_cast<unsigned>(InputType::COUNT), 1>;
+
+	struct BirdInfo
+	{
+		std::shared_ptr<PhysicsBody>	m_bird;
+		unsigned						m_agentIdx;		// agent index in the shard, owner of the body
+		float							m_delay;
+		float							m_animTimer;
+		unsigned						m_currFrame;
+		math::vec4						m_birdColor;
+		float							m_currAngle;
+	};
+
+	// death record of a bird, input of the selection
+	struct WeightInfo
+	{
+		unsigned				m_agent;		// agent index in the scene
+		float					m_distFromHole;
+		unsigned				m_currPointsOnDeath;
+	};
+
+	// agents [firstAgent, firstAgent + capacity) of the scene are simulated here, seed and stream pick the bird colors
+	TrainingShard(const ANNWrapper::ANNConfig& brainConfig, unsigned firstAgent, unsigned capacity, PhysicsManager::BackendType physicsBackend, BrainType brainType,
+		uint64_t seed = Randomizer::DEFAULT_SEED, unsigned stream = 0);
+	~TrainingShard();
+
+	// clears the world for a new generation, shards given the same seed see the same obstacles
+	void Reset(unsigned obstacleSeed);
+	// weights are copied into the brain of the next free slot
+	void SpawnBird(const fann_type* weights);
+	void Update(float dt);
+
+	// moves the death records collected since the last call into records
+	void TakeDeathRecords(std::vector<WeightInfo>& records);
+
+	PhysicsManager& GetPhysicsManager() const;
+	const std::vector<BirdInfo>& GetBirds() const;
+	const ObstacleQueue& GetObstacles() const;
+	unsigned GetScore() const;
+	unsigned GetLiveBirdCount() const;
+	unsigned GetCapacity() const;
+
+private:
+	// body type ids, also the bit of the body in the collision filter
+	enum class ObjectType : uint8_t
+	{
+		NONE,
+		BIRD,
+		GROUND,
+		OBSTACLE,
+		DESTROYER
+	};
+
+	static const unsigned NO_BIRD;
+
+	static uint16_t GetCategoryBits(ObjectType type);
+	static void SetObjectType(PhysicsBody& body, ObjectType type);
+
+	// contact handlers, bodyA is of the first type in the name. contacts are deferred,
+	// the deaths of a step arrive as one batch sorted by agent
+	void BirdDeathContacts(const ContactInfo * contacts, unsigned count);
+	void ObstacleDestroyerContact(const ContactInfo & contactInfo);
+
+	float GetBirdBackX() const;
+	void SpawnObstacle();
+
+	// weights of the brain in a slot, stored in m_population or m_fixedBrains.
+	// slot i holds the brain of m_birds[i], the live brains are always the first slots
+	void SetBrainWeights(unsigned slot, const fann_type* weights);
+	void MoveBrain(unsigned from, unsigned to);
+
+	std::unique_ptr<PhysicsManager>	m_physicsMgr;
+	unsigned						m_firstAgent;
+	BrainType						m_brainType;
+	std::unique_ptr<ANNPopulation>	m_population;
+	std::vector<FixedBrain>			m_fixedBrains;		// per slot, with BrainType::FIXED
+	std::vector<fann_type>			m_fixedOutputs;
+	std::vector<BirdInfo>			m_birds;
+	std::vector<unsigned>			m_birdIndices;		// per agent, position in m_birds or NO_BIRD
+	std::vector<WeightInfo>			m_deathRecords;
+	ObstacleQueue					m_obstacles;
+	Randomizer						m_obstacleRandomizer;
+	Randomizer						m_colorRandomizer;
+	float							m_obstacleSpawnTimer;
+	unsigned						m_currScore;
+};
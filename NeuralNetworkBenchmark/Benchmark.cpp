@@ -0,0 +1,580 @@
+#include "Benchmark.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include <cmath>
+#include <ctime>
+#include <regex>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+	const int64_t	MAX_ITERATIONS	= 1000000000;
+
+	// read by nobody, written through volatile so the escaped values stay alive
+	const void* volatile s_escapeSink = nullptr;
+
+	std::vector<Benchmark*>& GetRegistry()
+	{
+		static std::vector<Benchmark*> registry;
+		return registry;
+	}
+
+	// process cpu time of every thread in seconds
+	double GetProcessCpuTime()
+	{
+#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+			return 0.0;
+		ULARGE_INTEGER k, u;
+		k.LowPart = kernel.dwLowDateTime;	k.HighPart = kernel.dwHighDateTime;
+		u.LowPart = user.dwLowDateTime;		u.HighPart = user.dwHighDateTime;
+		return static_cast<double>(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+		return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+	}
+
+	struct Options
+	{
+		std::string	m_filter		= ".";
+		double		m_minTime		= 0.5;
+		unsigned	m_repetitions	= 1;
+		bool		m_json			= false;
+		bool		m_list			= false;
+		std::string	m_outFile;
+	};
+
+	struct Run
+	{
+		std::string	m_name;
+		std::string	m_runName;
+		std::string	m_aggregate;		// empty for an iteration run
+		std::string	m_label;
+		std::string	m_error;
+		unsigned	m_repetitionIndex;
+		int64_t		m_iterations;
+		double		m_realTime;			// ns per iteration
+		double		m_cpuTime;
+		double		m_itemsPerSecond;	// 0 if not set
+	};
+
+	bool ParseFlag(const char* arg, const char* name, std::string& value)
+	{
+		size_t length = std::strlen(name);
+		if (std::strncmp(arg, name, length) || arg[length] != '=')
+			return false;
+		value = arg + length + 1;
+		return true;
+	}
+
+	std::string GetRunName(const std::string& name, const std::vector<int64_t>& args)
+	{
+		std::string runName = name;
+		for (int64_t arg : args)
+			runName += "/" + std::to_string(arg);
+		return runName;
+	}
+
+	std::string EscapeJson(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			switch (c)
+			{
+			case '"':	escaped += "\\\"";	break;
+			case '\\':	escaped += "\\\\";	break;
+			case '\n':	escaped += "\\n";	break;
+			case '\t':	escaped += "\\t";	break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char code[8];
+					std::snprintf(code, sizeof(code), "\\u%04x", c);
+					escaped += code;
+				}
+				else
+				{
+					escaped += c;
+				}
+			}
+		}
+		return escaped;
+	}
+
+	// one run of the benchmark with a fixed iteration count
+	Run RunOnce(const Benchmark& benchmark, const std::vector<int64_t>& args, int64_t iterations)
+	{
+		BenchmarkState state(args, iterations);
+		benchmark.GetFunction()(state);
+
+		Run run;
+		run.m_runName			= GetRunName(benchmark.GetName(), args);
+		run.m_name				= run.m_runName;
+		run.m_label				= state.GetLabel();
+		run.m_error				= state.GetError();
+		run.m_repetitionIndex	= 0;
+		run.m_iterations		= iterations;
+		run.m_realTime			= state.GetRealTime() * 1e9 / iterations;
+		run.m_cpuTime			= state.GetCpuTime() * 1e9 / iterations;
+		double seconds			= benchmark.IsRealTime() ? state.GetRealTime() : state.GetCpuTime();
+		run.m_itemsPerSecond	= state.GetItemsProcessed() > 0 && seconds > 0.0 ? state.GetItemsProcessed() / seconds : 0.0;
+		return run;
+	}
+
+	// grows the iteration count until a run lasts min time, the last run is the result
+	Run RunUntilMinTime(const Benchmark& benchmark, const std::vector<int64_t>& args, double minTime)
+	{
+		int64_t iterations = 1;
+		for (;;)
+		{
+			Run run = RunOnce(benchmark, args, iterations);
+			double seconds = (benchmark.IsRealTime() ? run.m_realTime : run.m_cpuTime) * 1e-9 * iterations;
+			if (!run.m_error.empty() || seconds >= minTime || iterations >= MAX_ITERATIONS)
+				return run;
+
+			// aim 40% past min time, at most 10x per round while the run is too short to trust
+			double multiplier = seconds > 0.0 ? minTime * 1.4 / seconds : 10.0;
+			if (seconds < minTime * 0.1)
+				multiplier = (std::min)(multiplier, 10.0);
+			int64_t next = static_cast<int64_t>(iterations * multiplier);
+			iterations = (std::min)(MAX_ITERATIONS, (std::max)(next, iterations + 1));
+		}
+	}
+
+	Run Aggregate(const std::vector<Run>& runs, const char* name)
+	{
+		Run result = runs.front();
+		result.m_name				= result.m_runName + "_" + name;
+		result.m_aggregate			= name;
+		result.m_repetitionIndex	= 0;
+
+		auto reduce = [&](double Run::* field)
+		{
+			std::vector<double> values;
+			for (const Run& run : runs)
+				values.emplace_back(run.*field);
+
+			double mean = 0.0;
+			for (double value : values)
+				mean += value;
+			mean /= values.size();
+
+			if (!std::strcmp(name, "mean"))
+				return mean;
+			if (!std::strcmp(name, "median"))
+			{
+				std::sort(values.begin(), values.end());
+				size_t half = values.size() / 2;
+				return values.size() % 2 ? values[half] : (values[half - 1] + values[half]) * 0.5;
+			}
+
+			double variance = 0.0;
+			for (double value : values)
+				variance += (value - mean) * (value - mean);
+			return values.size() > 1 ? std::sqrt(variance / (values.size() - 1)) : 0.0;
+		};
+
+		result.m_realTime		= reduce(&Run::m_realTime);
+		result.m_cpuTime		= reduce(&Run::m_cpuTime);
+		result.m_itemsPerSecond	= reduce(&Run::m_itemsPerSecond);
+		return result;
+	}
+
+	void PrintConsole(std::ostream& out, const Run& run)
+	{
+		char line[512];
+		if (!run.m_error.empty())
+		{
+			std::snprintf(line, sizeof(line), "%-50s ERROR: %s\n", run.m_name.c_str(), run.m_error.c_str());
+			out << line;
+			return;
+		}
+
+		std::snprintf(line, sizeof(line), "%-50s %13.0f ns %13.0f ns %12lld", run.m_name.c_str(), run.m_realTime, run.m_cpuTime, static_cast<long long>(run.m_iterations));
+		out << line;
+		if (run.m_itemsPerSecond > 0.0)
+		{
+			std::snprintf(line, sizeof(line), " items_per_second=%.4g/s", run.m_itemsPerSecond);
+			out << line;
+		}
+		if (!run.m_label.empty())
+		{
+			out << " " << run.m_label;
+		}
+		out << "\n";
+	}
+
+	void WriteJson(std::ostream& out, const std::vector<Run>& runs, const Options& options, const char* executable)
+	{
+		char date[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+		out << "{\n  \"context\": {\n";
+		out << "    \"date\": \"" << date << "\",\n";
+		out << "    \"executable\": \"" << EscapeJson(executable) << "\",\n";
+		out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+		out << "    \"library_build_type\": \"release\"\n";
+#else
+		out << "    \"library_build_type\": \"debug\"\n";
+#endif
+		out << "  },\n  \"benchmarks\": [";
+
+		char number[64];
+		for (size_t i = 0; i < runs.size(); ++i)
+		{
+			const Run& run = runs[i];
+			out << (i ? ",\n" : "\n") << "    {\n";
+			out << "      \"name\": \"" << EscapeJson(run.m_name) << "\",\n";
+			out << "      \"run_name\": \"" << EscapeJson(run.m_runName) << "\",\n";
+			out << "      \"run_type\": \"" << (run.m_aggregate.empty() ? "iteration" : "aggregate") << "\",\n";
+			out << "      \"repetitions\": " << options.m_repetitions << ",\n";
+			if (run.m_aggregate.empty())
+				out << "      \"repetition_index\": " << run.m_repetitionIndex << ",\n";
+			else
+				out << "      \"aggregate_name\": \"" << run.m_aggregate << "\",\n";
+			out << "      \"threads\": 1,\n";
+			if (!run.m_error.empty())
+			{
+				out << "      \"error_occurred\": true,\n";
+				out << "      \"error_message\": \"" << EscapeJson(run.m_error) << "\"\n    }";
+				continue;
+			}
+			out << "      \"iterations\": " << run.m_iterations << ",\n";
+			std::snprintf(number, sizeof(number), "%.6e", run.m_realTime);
+			out << "      \"real_time\": " << number << ",\n";
+			std::snprintf(number, sizeof(number), "%.6e", run.m_cpuTime);
+			out << "      \"cpu_time\": " << number << ",\n";
+			out << "      \"time_unit\": \"ns\"";
+			if (run.m_itemsPerSecond > 0.0)
+			{
+				std::snprintf(number, sizeof(number), "%.6e", run.m_itemsPerSecond);
+				out << ",\n      \"items_per_second\": " << number;
+			}
+			if (!run.m_label.empty())
+			{
+				out << ",\n      \"label\": \"" << EscapeJson(run.m_label) << "\"";
+			}
+			out << "\n    }";
+		}
+		out << "\n  ]\n}\n";
+	}
+}
+
+BenchmarkState::BenchmarkState(const std::vector<int64_t>& args, int64_t iterations) :
+	m_args(args),
+	m_iterations(iterations),
+	m_remaining(iterations),
+	m_started(false),
+	m_running(false),
+	m_cpuStart(0.0),
+	m_realTime(0.0),
+	m_cpuTime(0.0),
+	m_itemsProcessed(0)
+{
+}
+
+bool BenchmarkState::KeepRunning()
+{
+	if (!m_started)
+	{
+		m_started = true;
+		StartTimer();
+	}
+
+	if (m_remaining > 0 && m_error.empty())
+	{
+		--m_remaining;
+		return true;
+	}
+
+	if (m_running)
+		StopTimer();
+	return false;
+}
+
+void BenchmarkState::PauseTiming()
+{
+	if (m_running)
+		StopTimer();
+}
+
+void BenchmarkState::ResumeTiming()
+{
+	if (!m_running)
+		StartTimer();
+}
+
+int64_t BenchmarkState::GetRange(unsigned index) const
+{
+	return index < m_args.size() ? m_args[index] : 0;
+}
+
+int64_t BenchmarkState::GetIterations() const
+{
+	return m_iterations;
+}
+
+void BenchmarkState::SetItemsProcessed(int64_t items)
+{
+	m_itemsProcessed = items;
+}
+
+void BenchmarkState::SetLabel(const std::string& label)
+{
+	m_label = label;
+}
+
+void BenchmarkState::SkipWithError(const std::string& error)
+{
+	m_error = error;
+}
+
+double BenchmarkState::GetRealTime() const
+{
+	return m_realTime;
+}
+
+double BenchmarkState::GetCpuTime() const
+{
+	return m_cpuTime;
+}
+
+int64_t BenchmarkState::GetItemsProcessed() const
+{
+	return m_itemsProcessed;
+}
+
+const std::string& BenchmarkState::GetLabel() const
+{
+	return m_label;
+}
+
+const std::string& BenchmarkState::GetError() const
+{
+	return m_error;
+}
+
+void BenchmarkState::StartTimer()
+{
+	m_running	= true;
+	m_realStart	= std::chrono::steady_clock::now();
+	m_cpuStart	= GetProcessCpuTime();
+}
+
+void BenchmarkState::StopTimer()
+{
+	m_running	= false;
+	m_realTime	+= std::chrono::duration<double>(std::chrono::steady_clock::now() - m_realStart).count();
+	m_cpuTime	+= GetProcessCpuTime() - m_cpuStart;
+}
+
+Benchmark::Benchmark(const std::string& name, BenchmarkFunction function) :
+	m_name(name),
+	m_function(function),
+	m_minTime(0.0),
+	m_useRealTime(false)
+{
+}
+
+Benchmark* Benchmark::Arg(int64_t arg)
+{
+	m_args.push_back({ arg });
+	return this;
+}
+
+Benchmark* Benchmark::Args(const std::vector<int64_t>& args)
+{
+	m_args.push_back(args);
+	return this;
+}
+
+Benchmark* Benchmark::MinTime(double seconds)
+{
+	m_minTime = seconds;
+	return this;
+}
+
+Benchmark* Benchmark::UseRealTime()
+{
+	m_useRealTime = true;
+	return this;
+}
+
+const std::string& Benchmark::GetName() const
+{
+	return m_name;
+}
+
+BenchmarkFunction Benchmark::GetFunction() const
+{
+	return m_function;
+}
+
+const std::vector<std::vector<int64_t>>& Benchmark::GetArgs() const
+{
+	return m_args;
+}
+
+double Benchmark::GetMinTime() const
+{
+	return m_minTime;
+}
+
+bool Benchmark::IsRealTime() const
+{
+	return m_useRealTime;
+}
+
+Benchmark* RegisterBenchmark(const std::string& name, BenchmarkFunction function)
+{
+	// never freed, the registry lives as long as the program
+	Benchmark* benchmark = new Benchmark(name, function);
+	GetRegistry().emplace_back(benchmark);
+	return benchmark;
+}
+
+void EscapePointer(const void* pointer)
+{
+	s_escapeSink = pointer;
+}
+
+int RunBenchmarks(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string value;
+		if (ParseFlag(argv[i], "--benchmark_filter", value))
+		{
+			options.m_filter = value;
+		}
+		else if (ParseFlag(argv[i], "--benchmark_min_time", value))
+		{
+			options.m_minTime = std::strtod(value.c_str(), nullptr);
+		}
+		else if (ParseFlag(argv[i], "--benchmark_repetitions", value))
+		{
+			options.m_repetitions = (std::max)(1u, static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)));
+		}
+		else if (ParseFlag(argv[i], "--benchmark_format", value) && (value == "console" || value == "json"))
+		{
+			options.m_json = value == "json";
+		}
+		else if (ParseFlag(argv[i], "--benchmark_out", value))
+		{
+			options.m_outFile = value;
+		}
+		else if (!std::strcmp(argv[i], "--benchmark_list_tests"))
+		{
+			options.m_list = true;
+		}
+		else
+		{
+			std::cout << "usage: " << argv[0] << " [--benchmark_filter=REGEX] [--benchmark_min_time=SECONDS] [--benchmark_repetitions=N]"
+				" [--benchmark_format=console|json] [--benchmark_out=FILE (json)] [--benchmark_list_tests]" << std::endl;
+			return -1;
+		}
+	}
+
+	std::regex filter;
+	try
+	{
+		filter = std::regex(options.m_filter);
+	}
+	catch (const std::regex_error&)
+	{
+		std::cerr << "invalid --benchmark_filter: " << options.m_filter << std::endl;
+		return -1;
+	}
+
+	if (!options.m_json && !options.m_list)
+	{
+		char header[256];
+		std::snprintf(header, sizeof(header), "%-50s %16s %16s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+		std::cout << header << std::string(std::strlen(header) - 1, '-') << std::endl;
+	}
+
+	std::vector<Run> results;
+	for (const Benchmark* benchmark : GetRegistry())
+	{
+		std::vector<std::vector<int64_t>> argSets = benchmark->GetArgs();
+		if (argSets.empty())
+			argSets.emplace_back();
+
+		for (const auto& args : argSets)
+		{
+			std::string runName = GetRunName(benchmark->GetName(), args);
+			if (!std::regex_search(runName, filter))
+				continue;
+
+			if (options.m_list)
+			{
+				std::cout << runName << std::endl;
+				continue;
+			}
+
+			// the iteration count is found once, the repetitions reuse it
+			double minTime = benchmark->GetMinTime() > 0.0 ? benchmark->GetMinTime() : options.m_minTime;
+			std::vector<Run> runs;
+			runs.emplace_back(RunUntilMinTime(*benchmark, args, minTime));
+			for (unsigned r = 1; r < options.m_repetitions && runs.front().m_error.empty(); ++r)
+			{
+				runs.emplace_back(RunOnce(*benchmark, args, runs.front().m_iterations));
+				runs.back().m_repetitionIndex = r;
+			}
+
+			for (const Run& run : runs)
+			{
+				if (!options.m_json)
+					PrintConsole(std::cout, run);
+				results.emplace_back(run);
+			}
+
+			if (runs.size() > 1)
+			{
+				for (const char* aggregate : { "mean", "median", "stddev" })
+				{
+					results.emplace_back(Aggregate(runs, aggregate));
+					if (!options.m_json)
+						PrintConsole(std::cout, results.back());
+				}
+			}
+		}
+	}
+
+	if (options.m_list)
+		return 0;
+
+	if (options.m_json)
+	{
+		WriteJson(std::cout, results, options, argv[0]);
+	}
+
+	if (!options.m_outFile.empty())
+	{
+		std::ofstream file(options.m_outFile);
+		if (!file)
+		{
+			std::cerr << "cannot write " << options.m_outFile << std::endl;
+			return -1;
+		}
+		WriteJson(file, results, options, argv[0]);
+	}
+
+	bool failed = std::any_of(results.begin(), results.end(), [](const Run& run) { return !run.m_error.empty(); });
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// small benchmark harness modelled on Google Benchmark: the same loop, flags and json
+// output, so its tools (e.g. compare.py) can diff two runs of this executable
+class BenchmarkState
+{
+public:
+	BenchmarkState(const std::vector<int64_t>& args, int64_t iterations);
+
+	// while (state.KeepRunning()) { ... } runs the body GetIterations() times, timed
+	bool KeepRunning();
+
+	// excludes the setup of an iteration from the time
+	void PauseTiming();
+	void ResumeTiming();
+
+	int64_t GetRange(unsigned index) const;
+	int64_t GetIterations() const;
+
+	// reported as items_per_second
+	void SetItemsProcessed(int64_t items);
+	void SetLabel(const std::string& label);
+	// stops the loop, the benchmark is reported as failed
+	void SkipWithError(const std::string& error);
+
+	double GetRealTime() const;		// seconds
+	double GetCpuTime() const;		// seconds, process time of every thread
+	int64_t GetItemsProcessed() const;
+	const std::string& GetLabel() const;
+	const std::string& GetError() const;
+
+private:
+	void StartTimer();
+	void StopTimer();
+
+	std::vector<int64_t>					m_args;
+	int64_t									m_iterations;
+	int64_t									m_remaining;
+	bool									m_started;
+	bool									m_running;
+
+	std::chrono::steady_clock::time_point	m_realStart;
+	double									m_cpuStart;
+	double									m_realTime;
+	double									m_cpuTime;
+
+	int64_t									m_itemsProcessed;
+	std::string								m_label;
+	std::string								m_error;
+};
+
+using BenchmarkFunction = void(*)(BenchmarkState&);
+
+class Benchmark
+{
+public:
+	Benchmark(const std::string& name, BenchmarkFunction function);
+
+	// one run per argument set, named name/arg0/arg1/...
+	Benchmark* Arg(int64_t arg);
+	Benchmark* Args(const std::vector<int64_t>& args);
+	// seconds the iterations of one run should take at least, default --benchmark_min_time
+	Benchmark* MinTime(double seconds);
+	// wall time picks the iteration count, for benchmarks that use several threads
+	Benchmark* UseRealTime();
+
+	const std::string& GetName() const;
+	BenchmarkFunction GetFunction() const;
+	const std::vector<std::vector<int64_t>>& GetArgs() const;
+	double GetMinTime() const;
+	bool IsRealTime() const;
+
+private:
+	std::string							m_name;
+	BenchmarkFunction					m_function;
+	std::vector<std::vector<int64_t>>	m_args;
+	double								m_minTime;	// <= 0 uses the flag
+	bool								m_useRealTime;
+};
+
+Benchmark* RegisterBenchmark(const std::string& name, BenchmarkFunction function);
+
+// keeps the compiler from dropping a computation whose result is unused
+void EscapePointer(const void* pointer);
+template<typename T> void DoNotOptimize(const T& value) { EscapePointer(&value); }
+
+// runs the registered benchmarks selected by the command line, returns the exit code
+//	--benchmark_filter=REGEX  --benchmark_min_time=SECONDS  --benchmark_repetitions=N
+//	--benchmark_format=console|json  --benchmark_out=FILE  --benchmark_list_tests
+int RunBenchmarks(int argc, char** argv);
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_NAME_(fnc, line) BENCHMARK_CONCAT_(s_benchmark_##fnc##_, line)
+#define BENCHMARK(fnc) static Benchmark* BENCHMARK_NAME_(fnc, __LINE__) = RegisterBenchmark(#fnc, fnc)
@@ -0,0 +1,9 @@
+#include "Benchmark.h"
+
+// benchmark entry point, the benchmarks register themselves in NetworkBenchmarks.cpp and SceneBenchmarks.cpp
+//	usage: NeuralNetworkBenchmark [--benchmark_filter=REGEX] [--benchmark_min_time=SECONDS] [--benchmark_repetitions=N]
+//								  [--benchmark_format=console|json] [--benchmark_out=FILE] [--benchmark_list_tests]
+int main(int argc, char** argv)
+{
+	return RunBenchmarks(argc, argv);
+}
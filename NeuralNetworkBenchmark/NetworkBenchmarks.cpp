@@ -0,0 +1,266 @@
+#include "Benchmark.h"
+
+#include "../NeuralNetwork/ANNWrapper.h"
+#include "../NeuralNetwork/Randomizer.h"
+
+#include "FANN/fann.h"
+#include "FANN/parallel_fann.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace
+{
+	struct FannDeleter
+	{
+		void operator()(struct fann* ann) const				{ fann_destroy(ann); }
+		void operator()(struct fann_train_data* data) const	{ fann_destroy_train(data); }
+	};
+
+	using FannPtr		= std::unique_ptr<struct fann, FannDeleter>;
+	using TrainDataPtr	= std::unique_ptr<struct fann_train_data, FannDeleter>;
+
+	// network with the layer sizes of the arguments and the activation of ANNWrapper
+	FannPtr CreateNetwork(const std::vector<unsigned>& layers)
+	{
+		FannPtr ann(fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data()));
+		fann_set_activation_function_hidden(ann.get(), ANNWrapper::ACTIVATION_FUNCTION);
+		fann_set_activation_function_output(ann.get(), ANNWrapper::ACTIVATION_FUNCTION);
+		fann_set_activation_steepness_hidden(ann.get(), ANNWrapper::ACTIVATION_STEEPNESS);
+		fann_set_activation_steepness_output(ann.get(), ANNWrapper::ACTIVATION_STEEPNESS);
+
+		Randomizer randomizer(-1.f, 1.f);
+		std::vector<fann_type> weights(fann_get_total_connections(ann.get()));
+		randomizer.FillUniform(weights.data(), weights.size());
+		fann_set_weights(ann.get(), weights.data());
+		return ann;
+	}
+
+	std::vector<unsigned> GetLayers(const BenchmarkState& state)
+	{
+		std::vector<unsigned> layers;
+		for (unsigned i = 0; state.GetRange(i) > 0; ++i)
+			layers.emplace_back(static_cast<unsigned>(state.GetRange(i)));
+		return layers;
+	}
+
+	// smooth target in [-1, 1] of random inputs, something a small network can fit
+	TrainDataPtr CreateTrainData(unsigned count, unsigned numInputs, unsigned numOutputs)
+	{
+		TrainDataPtr data(fann_create_train(count, numInputs, numOutputs));
+		Randomizer randomizer(-1.f, 1.f);
+		for (unsigned i = 0; i < count; ++i)
+		{
+			randomizer.FillUniform(data->input[i], numInputs);
+			for (unsigned o = 0; o < numOutputs; ++o)
+			{
+				float sum = 0.f;
+				for (unsigned n = 0; n < numInputs; ++n)
+					sum += data->input[i][n] * static_cast<float>((n + o) % 3) - 0.5f;
+				data->output[i][o] = std::tanh(sum);
+			}
+		}
+		return data;
+	}
+}
+
+// args: layer sizes
+void BM_FannRun(BenchmarkState& state)
+{
+	std::vector<unsigned> layers = GetLayers(state);
+	FannPtr ann = CreateNetwork(layers);
+
+	Randomizer randomizer(-1.f, 1.f);
+	std::vector<fann_type> inputs(layers.front());
+	randomizer.FillUniform(inputs.data(), inputs.size());
+
+	while (state.KeepRunning())
+	{
+		DoNotOptimize(*fann_run(ann.get(), inputs.data()));
+	}
+
+	unsigned connections = fann_get_total_connections(ann.get());
+	state.SetItemsProcessed(state.GetIterations() * connections);
+	state.SetLabel("connections/s, " + std::to_string(connections) + " connections");
+}
+BENCHMARK(BM_FannRun)->Args({ 3, 1 })->Args({ 3, 3, 1 })->Args({ 3, 16, 1 })->Args({ 16, 64, 16 })->Args({ 64, 256, 256, 10 })->Args({ 256, 512, 512, 10 });
+
+// args: layer sizes, the whole set goes through the matrix-form pass of fann_test_data
+void BM_FannTestData(BenchmarkState& state)
+{
+	const unsigned SAMPLES = 1024;
+
+	std::vector<unsigned> layers = GetLayers(state);
+	FannPtr ann = CreateNetwork(layers);
+	TrainDataPtr data = CreateTrainData(SAMPLES, layers.front(), layers.back());
+
+	while (state.KeepRunning())
+	{
+		float mse = fann_test_data(ann.get(), data.get());
+		DoNotOptimize(mse);
+	}
+
+	unsigned connections = fann_get_total_connections(ann.get());
+	state.SetItemsProcessed(state.GetIterations() * SAMPLES * connections);
+	state.SetLabel("connections/s, " + std::to_string(connections) + " connections");
+}
+BENCHMARK(BM_FannTestData)->Args({ 3, 16, 1 })->Args({ 16, 64, 16 })->Args({ 64, 256, 256, 10 })->Args({ 256, 512, 512, 10 });
+
+// args: 0 = fann_create_from_file, 1 = fann_create_from_binary, then the layer sizes
+void BM_FannLoad(BenchmarkState& state)
+{
+	bool binary = state.GetRange(0) != 0;
+
+	std::vector<unsigned> layers;
+	for (unsigned i = 1; state.GetRange(i) > 0; ++i)
+		layers.emplace_back(static_cast<unsigned>(state.GetRange(i)));
+	FannPtr ann = CreateNetwork(layers);
+
+	const char* path = binary ? "BM_FannLoad.bin" : "BM_FannLoad.net";
+	if ((binary ? fann_save_binary(ann.get(), path) : fann_save(ann.get(), path)) != 0)
+	{
+		state.SkipWithError("could not save the network");
+	}
+
+	while (state.KeepRunning())
+	{
+		FannPtr loaded(binary ? fann_create_from_binary(path) : fann_create_from_file(path));
+		DoNotOptimize(loaded.get());
+	}
+	std::remove(path);
+
+	unsigned connections = fann_get_total_connections(ann.get());
+	state.SetItemsProcessed(state.GetIterations() * connections);
+	state.SetLabel(std::string("connections/s, ") + (binary ? "binary" : "text"));
+}
+BENCHMARK(BM_FannLoad)->Args({ 0, 16, 64, 16 })->Args({ 1, 16, 64, 16 })->Args({ 0, 256, 512, 512, 10 })->Args({ 1, 256, 512, 512, 10 });
+
+// args: layer count, hidden neurons, the inputs and outputs of the bird brain
+void BM_ANNWrapperRun(BenchmarkState& state)
+{
+	ANNWrapper::ANNConfig config = {};
+	config.m_numInputs			= 3;
+	config.m_numOutputs			= 1;
+	config.m_numLayers			= static_cast<int>(state.GetRange(0));
+	config.m_numNeuronsInHidden	= static_cast<int>(state.GetRange(1));
+	ANNWrapper ann(config);
+
+	Randomizer randomizer(-1.f, 1.f);
+	ann.RandomizeWeights(randomizer);
+
+	fann_type inputs[3] = { 0.25f, -0.5f, 0.75f };
+	fann_type output = 0.f;
+	while (state.KeepRunning())
+	{
+		ann.Run(inputs, &output);
+		DoNotOptimize(output);
+	}
+	state.SetItemsProcessed(state.GetIterations());
+}
+BENCHMARK(BM_ANNWrapperRun)->Args({ 2, 0 })->Args({ 3, 3 })->Args({ 3, 16 })->Args({ 4, 64 });
+
+// same through the allocating overload
+void BM_ANNWrapperRunVector(BenchmarkState& state)
+{
+	ANNWrapper::ANNConfig config = {};
+	config.m_numInputs			= 3;
+	config.m_numOutputs			= 1;
+	config.m_numLayers			= static_cast<int>(state.GetRange(0));
+	config.m_numNeuronsInHidden	= static_cast<int>(state.GetRange(1));
+	ANNWrapper ann(config);
+
+	Randomizer randomizer(-1.f, 1.f);
+	ann.RandomizeWeights(randomizer);
+
+	std::vector<fann_type> inputs = { 0.25f, -0.5f, 0.75f };
+	while (state.KeepRunning())
+	{
+		std::vector<fann_type> outputs = ann.Run(inputs);
+		DoNotOptimize(outputs.front());
+	}
+	state.SetItemsProcessed(state.GetIterations());
+}
+BENCHMARK(BM_ANNWrapperRunVector)->Args({ 2, 0 })->Args({ 3, 16 });
+
+// args: fann_train_enum, threads (0 = serial fann_train_epoch, otherwise the parallel_fann variant)
+void BM_FannTrainEpoch(BenchmarkState& state)
+{
+	const unsigned SAMPLES = 2048, INPUTS = 8, HIDDEN = 32, OUTPUTS = 4;
+
+	fann_train_enum algorithm	= static_cast<fann_train_enum>(state.GetRange(0));
+	unsigned threads			= static_cast<unsigned>(state.GetRange(1));
+
+	FannPtr ann = CreateNetwork({ INPUTS, HIDDEN, OUTPUTS });
+	fann_set_training_algorithm(ann.get(), algorithm);
+	TrainDataPtr data = CreateTrainData(SAMPLES, INPUTS, OUTPUTS);
+
+	float (FANN_API *parallelEpoch)(struct fann*, struct fann_train_data*, const unsigned int) = nullptr;
+	switch (algorithm)
+	{
+	case FANN_TRAIN_BATCH:		parallelEpoch = fann_train_epoch_batch_parallel;		break;
+	case FANN_TRAIN_RPROP:		parallelEpoch = fann_train_epoch_irpropm_parallel;		break;
+	case FANN_TRAIN_QUICKPROP:	parallelEpoch = fann_train_epoch_quickprop_parallel;	break;
+	case FANN_TRAIN_SARPROP:	parallelEpoch = fann_train_epoch_sarprop_parallel;		break;
+	case FANN_TRAIN_MINIBATCH:	parallelEpoch = fann_train_epoch_minibatch_parallel;	break;
+	default:																			break;
+	}
+	if (threads > 0 && !parallelEpoch)
+	{
+		state.SkipWithError("no parallel variant");
+	}
+
+	while (state.KeepRunning())
+	{
+		float mse = threads > 0 ? parallelEpoch(ann.get(), data.get(), threads) : fann_train_epoch(ann.get(), data.get());
+		DoNotOptimize(mse);
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * SAMPLES);
+	state.SetLabel(std::string("samples/s, ") + FANN_TRAIN_NAMES[algorithm] + (threads > 0 ? " parallel" : ""));
+}
+BENCHMARK(BM_FannTrainEpoch)
+	->Args({ FANN_TRAIN_INCREMENTAL, 0 })
+	->Args({ FANN_TRAIN_BATCH, 0 })->Args({ FANN_TRAIN_BATCH, 1 })->Args({ FANN_TRAIN_BATCH, 2 })->Args({ FANN_TRAIN_BATCH, 4 })
+	->Args({ FANN_TRAIN_RPROP, 0 })->Args({ FANN_TRAIN_RPROP, 1 })->Args({ FANN_TRAIN_RPROP, 2 })->Args({ FANN_TRAIN_RPROP, 4 })
+	->Args({ FANN_TRAIN_QUICKPROP, 0 })->Args({ FANN_TRAIN_QUICKPROP, 4 })
+	->Args({ FANN_TRAIN_SARPROP, 0 })->Args({ FANN_TRAIN_SARPROP, 4 })
+	->Args({ FANN_TRAIN_MINIBATCH, 0 })->Args({ FANN_TRAIN_MINIBATCH, 4 })
+	->UseRealTime();
+
+// same epochs through a trainer that keeps its replicas, against the per call copies above
+void BM_FannTrainerEpoch(BenchmarkState& state)
+{
+	const unsigned SAMPLES = 2048, INPUTS = 8, HIDDEN = 32, OUTPUTS = 4;
+
+	fann_train_enum algorithm	= static_cast<fann_train_enum>(state.GetRange(0));
+	unsigned threads			= static_cast<unsigned>(state.GetRange(1));
+
+	FannPtr ann = CreateNetwork({ INPUTS, HIDDEN, OUTPUTS });
+	fann_set_training_algorithm(ann.get(), algorithm);
+	TrainDataPtr data = CreateTrainData(SAMPLES, INPUTS, OUTPUTS);
+
+	std::unique_ptr<fann_parallel_trainer, void (FANN_API *)(fann_parallel_trainer*)> trainer(fann_create_parallel_trainer(ann.get(), threads), fann_destroy_parallel_trainer);
+	if (!trainer)
+	{
+		state.SkipWithError("fann_create_parallel_trainer failed");
+	}
+
+	while (state.KeepRunning())
+	{
+		float mse = fann_train_epoch_parallel(trainer.get(), data.get());
+		DoNotOptimize(mse);
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * SAMPLES);
+	state.SetLabel(std::string("samples/s, ") + FANN_TRAIN_NAMES[algorithm] + " trainer");
+}
+BENCHMARK(BM_FannTrainerEpoch)
+	->Args({ FANN_TRAIN_BATCH, 1 })->Args({ FANN_TRAIN_BATCH, 2 })->Args({ FANN_TRAIN_BATCH, 4 })
+	->Args({ FANN_TRAIN_RPROP, 1 })->Args({ FANN_TRAIN_RPROP, 2 })->Args({ FANN_TRAIN_RPROP, 4 })
+	->Args({ FANN_TRAIN_QUICKPROP, 4 })
+	->Args({ FANN_TRAIN_SARPROP, 4 })
+	->Args({ FANN_TRAIN_MINIBATCH, 1 })->Args({ FANN_TRAIN_MINIBATCH, 4 })
+	->UseRealTime();
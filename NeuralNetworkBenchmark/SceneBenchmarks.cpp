@@ -0,0 +1,218 @@
+#include "Benchmark.h"
+
+#include "../NeuralNetwork/ThreadPool.h"
+#include "../NeuralNetwork/Randomizer.h"
+#include "../NeuralNetwork/PhysicsBody.h"
+#include "../NeuralNetwork/TrainingScene.h"
+#include "../NeuralNetwork/PhysicsManager.h"
+#include "../NeuralNetwork/SceneConstants.h"
+
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const uint64_t BENCHMARK_SEED = 1;
+
+	const char* GetBackendName(PhysicsManager::BackendType backendType)
+	{
+		return backendType == PhysicsManager::BackendType::FLAPPY ? "flappy" : "box2d";
+	}
+
+	// gives the benchmark the genetic algorithm steps of a generation restart
+	class BreedingScene : public TrainingScene
+	{
+	public:
+		BreedingScene(unsigned agentCount) :
+			TrainingScene(agentCount, 1, nullptr, PhysicsManager::BackendType::FLAPPY, TrainingShard::BrainType::POPULATION, BENCHMARK_SEED),
+			m_agentCount(agentCount),
+			m_recordRandomizer(0, 100, BENCHMARK_SEED)
+		{
+		}
+
+		// death records of a whole generation and an empty world, what RestartGame breeds from
+		void PrepareGeneration()
+		{
+			m_collectedWeights.clear();
+			for (unsigned i = 0; i < m_agentCount; ++i)
+			{
+				WeightInfo record;
+				record.m_agent				= i;
+				record.m_currPointsOnDeath	= static_cast<unsigned>(m_recordRandomizer.GetRandomInt());
+				record.m_distFromHole		= static_cast<float>(m_recordRandomizer.GetRandomInt());
+				m_collectedWeights.emplace_back(record);
+			}
+			StartGame();
+		}
+
+		void Breed()
+		{
+			Selection();
+			Crossover();
+		}
+
+	private:
+		unsigned	m_agentCount;
+		Randomizer	m_recordRandomizer;
+	};
+}
+
+// args: agents, shards, PhysicsManager::BackendType. one iteration is the first TICKS ticks of a fresh scene:
+// the same seeded ticks every iteration, however many the run picks. a generation can outlive them
+// (a random bird may never die), the label tells how far the ticks got
+void BM_TrainingSceneUpdate(BenchmarkState& state)
+{
+	const unsigned TICKS = 600;
+
+	unsigned agentCount = static_cast<unsigned>(state.GetRange(0));
+	unsigned shardCount = static_cast<unsigned>(state.GetRange(1));
+	PhysicsManager::BackendType backendType = static_cast<PhysicsManager::BackendType>(state.GetRange(2));
+
+	std::unique_ptr<ThreadPool> threadPool = shardCount > 1 ? std::make_unique<ThreadPool>() : nullptr;
+	std::unique_ptr<TrainingScene> scene;
+
+	const float dt = static_cast<float>(DISCRETE_DT);
+	while (state.KeepRunning())
+	{
+		state.PauseTiming();
+		scene.reset();
+		scene = std::make_unique<TrainingScene>(agentCount, shardCount, threadPool.get(), backendType, TrainingShard::BrainType::POPULATION, BENCHMARK_SEED);
+		state.ResumeTiming();
+
+		// the first update spawns generation 1, restarts are included as they come
+		for (unsigned i = 0; i < TICKS; ++i)
+		{
+			scene->Update(dt);
+		}
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * TICKS);
+	state.SetLabel(std::string("ticks/s, ") + GetBackendName(backendType) + ", " + std::to_string(TICKS) + " ticks to generation " +
+		(scene ? std::to_string(scene->GetCurrentGeneration()) : std::string("0")) + ", " + (scene ? std::to_string(scene->GetLiveBirdCount()) : std::string("0")) + " alive");
+}
+BENCHMARK(BM_TrainingSceneUpdate)
+	->Args({ 50, 1, 0 })->Args({ 50, 1, 1 })
+	->Args({ 500, 1, 0 })->Args({ 500, 1, 1 })->Args({ 500, 4, 0 })->Args({ 500, 4, 1 })
+	->Args({ 2000, 1, 0 })->Args({ 2000, 1, 1 })->Args({ 2000, 4, 0 })->Args({ 2000, 4, 1 })
+	->UseRealTime();
+
+// args: birds, PhysicsManager::BackendType. the training scene workload on both backends: sensor birds
+// filtered against the grounds and obstacles only, flapping above their own floor, and obstacle pairs
+// moving back and forth through them
+void BM_PhysicsManagerUpdate(BenchmarkState& state)
+{
+	// type ids of the TrainingShard object types, the id is also the bit of the body in the filter
+	const uint8_t BIRD_TYPE = 1, GROUND_TYPE = 2, OBSTACLE_TYPE = 3, DESTROYER_TYPE = 4;
+	const uint16_t BIRD = 1 << BIRD_TYPE, GROUND = 1 << GROUND_TYPE, OBSTACLE = 1 << OBSTACLE_TYPE, DESTROYER = 1 << DESTROYER_TYPE;
+	const unsigned OBSTACLE_PAIRS = 4;
+	const float HEIGHT = 385.f, OBSTACLE_LENGTH = 600.f, OBSTACLE_RANGE = 650.f;
+
+	unsigned birdCount = static_cast<unsigned>(state.GetRange(0));
+	PhysicsManager::BackendType backendType = static_cast<PhysicsManager::BackendType>(state.GetRange(1));
+
+	PhysicsManager physicsMgr(math::vec2(0.f, -9.8f), backendType);
+	std::vector<PhysicBodyPtr> statics;
+	statics.emplace_back(physicsMgr.AddBox(math::vec2(0.f, -HEIGHT), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC));
+	statics.emplace_back(physicsMgr.AddBox(math::vec2(0.f, HEIGHT), math::vec2(1500.f, 50.f), 0.f, PhysicsManager::BodyType::STATIC));
+	for (auto & ground : statics)
+	{
+		ground->SetTypeId(GROUND_TYPE);
+		ground->SetCategoryBits(GROUND);
+	}
+
+	statics.emplace_back(physicsMgr.AddBox(math::vec2(-750.f, 0.f), math::vec2(50.f, 1000.f), 0.f, PhysicsManager::BodyType::STATIC));
+	statics.back()->SetTypeId(DESTROYER_TYPE);
+	statics.back()->SetCategoryBits(DESTROYER);
+
+	// obstacle pairs a spawn interval apart, as many as the scene has alive
+	std::vector<PhysicBodyPtr> obstacles;
+	float obstacleHalfHt = (OBSTACLE_LENGTH + SceneConstants::HoleHeight) * 0.5f;
+	float obstacleSpacing = SceneConstants::ObstacleSpawnTime * SceneConstants::ObstacleInitialSpeed;
+	for (unsigned i = 0; i < OBSTACLE_PAIRS; ++i)
+	{
+		float x = OBSTACLE_RANGE - i * obstacleSpacing;
+		float hole = SceneConstants::HoleDistanceRange * ((i % 3) - 1.f);
+		obstacles.emplace_back(physicsMgr.AddBox(math::vec2(x, hole - obstacleHalfHt), math::vec2(90.f, OBSTACLE_LENGTH), 0.f, PhysicsManager::BodyType::DYNAMIC));
+		obstacles.emplace_back(physicsMgr.AddBox(math::vec2(x, hole + obstacleHalfHt), math::vec2(90.f, OBSTACLE_LENGTH), 180.f, PhysicsManager::BodyType::DYNAMIC));
+	}
+
+	for (auto & obstacle : obstacles)
+	{
+		obstacle->SetTypeId(OBSTACLE_TYPE);
+		obstacle->SetFilterBits(OBSTACLE, BIRD | DESTROYER);
+		obstacle->SetVelocity(math::vec2(-SceneConstants::ObstacleInitialSpeed, 0.f));
+		obstacle->SetIsSensor(true);
+		obstacle->SetGravityScale(0.f);
+	}
+
+	// every bird keeps above a floor of its own, so the birds spread over the height of the scene
+	std::vector<PhysicBodyPtr> birds;
+	std::vector<float> floors;
+	for (unsigned i = 0; i < birdCount; ++i)
+	{
+		floors.emplace_back(-250.f + (i % 10) * 50.f);
+		birds.emplace_back(physicsMgr.AddCircle(math::vec2(-400.f, floors.back() + 100.f), SceneConstants::BirdSize * 0.5f, 0.f, PhysicsManager::BodyType::DYNAMIC));
+		birds.back()->SetIsSensor(true);
+		birds.back()->SetTypeId(BIRD_TYPE);
+		birds.back()->SetFilterBits(BIRD, GROUND | OBSTACLE);
+		birds.back()->SetGravityScale(4.f);
+	}
+
+	auto tick = [&]()
+	{
+		for (unsigned i = 0; i < birdCount; ++i)
+		{
+			if (birds[i]->GetPosition().y < floors[i] && birds[i]->GetVelocity().y < 0.f)
+				birds[i]->SetVelocity(math::vec2(0.f, SceneConstants::FlapStrength));
+		}
+
+		// obstacles turn around at the edges instead of being destroyed and respawned
+		for (auto & obstacle : obstacles)
+		{
+			math::vec2 pos = obstacle->GetPosition(), vel = obstacle->GetVelocity();
+			if ((pos.x < -OBSTACLE_RANGE && vel.x < 0.f) || (pos.x > OBSTACLE_RANGE && vel.x > 0.f))
+				obstacle->SetVelocity(math::vec2(-vel.x, 0.f));
+		}
+
+		physicsMgr.Update(static_cast<float>(DISCRETE_DT));
+	};
+
+	// let the birds spread out first
+	for (unsigned i = 0; i < 60; ++i)
+	{
+		tick();
+	}
+
+	while (state.KeepRunning())
+	{
+		tick();
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * birdCount);
+	state.SetLabel(std::string("birds/s, ") + GetBackendName(backendType));
+}
+BENCHMARK(BM_PhysicsManagerUpdate)
+	->Args({ 100, 0 })->Args({ 100, 1 })
+	->Args({ 1000, 0 })->Args({ 1000, 1 })
+	->Args({ 5000, 0 })->Args({ 5000, 1 });
+
+// args: agents. TrainingScene::Selection and Crossover of one generation, spawning the children included
+void BM_SelectionCrossover(BenchmarkState& state)
+{
+	unsigned agentCount = static_cast<unsigned>(state.GetRange(0));
+	BreedingScene scene(agentCount);
+
+	while (state.KeepRunning())
+	{
+		state.PauseTiming();
+		scene.PrepareGeneration();
+		state.ResumeTiming();
+
+		scene.Breed();
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * agentCount);
+	state.SetLabel("agents/s");
+}
+BENCHMARK(BM_SelectionCrossover)->Arg(50)->Arg(500)->Arg(5000);
@@ -0,0 +1,160 @@
+#include "../NeuralNetwork/Profiler.h"
+#include "../NeuralNetwork/SceneManager.h"
+#include "../NeuralNetwork/TrainingScene.h"
+#include "../NeuralNetwork/SceneConstants.h"
+
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+// headless training entry point, no window / GL context required
+//	usage: NeuralNetworkHeadless [--agents N] [--generations N] [--target-score N]
+//								 [--islands N] [--shards N] [--threads N] [--migration-interval N] [--migrants N] [--seed N] [--trace FILE]
+int main(int argc, char** argv)
+{
+	SceneManager::ScenesConfig config;
+	unsigned maxGenerations = 100;
+	unsigned targetScore	= 0;
+	const char* traceFile	= nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		bool hasValue = (i + 1) < argc;
+		if (!strcmp(argv[i], "--agents") && hasValue)
+		{
+			config.m_agentCount = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--generations") && hasValue)
+		{
+			maxGenerations = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--target-score") && hasValue)
+		{
+			targetScore = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--islands") && hasValue)
+		{
+			config.m_islandCount = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--shards") && hasValue)
+		{
+			config.m_shardCount = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--physics") && hasValue && !strcmp(argv[i + 1], "box2d"))
+		{
+			config.m_physicsBackend = PhysicsManager::BackendType::BOX2D;
+			++i;
+		}
+		else if (!strcmp(argv[i], "--physics") && hasValue && !strcmp(argv[i + 1], "flappy"))
+		{
+			config.m_physicsBackend = PhysicsManager::BackendType::FLAPPY;
+			++i;
+		}
+		else if (!strcmp(argv[i], "--brain") && hasValue && !strcmp(argv[i + 1], "population"))
+		{
+			config.m_brainType = TrainingShard::BrainType::POPULATION;
+			++i;
+		}
+		else if (!strcmp(argv[i], "--brain") && hasValue && !strcmp(argv[i + 1], "fixed"))
+		{
+			config.m_brainType = TrainingShard::BrainType::FIXED;
+			++i;
+		}
+		else if (!strcmp(argv[i], "--threads") && hasValue)
+		{
+			config.m_threadCount = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--migration-interval") && hasValue)
+		{
+			config.m_migrationInterval = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--migrants") && hasValue)
+		{
+			config.m_migrantCount = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (!strcmp(argv[i], "--seed") && hasValue)
+		{
+			config.m_seed = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--trace") && hasValue)
+		{
+			traceFile = argv[++i];
+		}
+		else
+		{
+			std::cout << "usage: " << argv[0] << " [--agents N] [--generations N (0 = endless)] [--target-score N (0 = none)]"
+				" [--islands N] [--shards N] [--threads N (0 = all)] [--migration-interval N] [--migrants N] [--physics box2d|flappy] [--brain population|fixed] [--seed N] [--trace FILE]" << std::endl;
+			return -1;
+		}
+	}
+
+	if (config.m_agentCount < 2)
+	{
+		config.m_agentCount = 2;
+	}
+
+	config.m_discreteDT = static_cast<float>(DISCRETE_DT);
+
+	// the trace keeps the last Profiler::RING_SIZE scopes of every thread
+	if (traceFile)
+	{
+		Profiler::SetEnabled(true);
+		Profiler::Get().SetThreadName("Main");
+	}
+
+	SceneManager sceneMgr;
+	sceneMgr.Init(config);
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	unsigned currGeneration = 0;
+	unsigned long long ticks = 0;
+
+	// run the simulation as fast as possible, no frame rate controller
+	while (maxGenerations == 0 || currGeneration <= maxGenerations)
+	{
+		if (traceFile)
+		{
+			Profiler::Get().MarkFrame();
+		}
+		sceneMgr.Update(config.m_discreteDT);
+		++ticks;
+
+		// generations are counted on the first island, scores over all of them
+		const TrainingScene& scene = *sceneMgr.GetTrainingScene();
+		unsigned currScore = 0, maxScore = 0;
+		for (auto & island : sceneMgr.GetIslands())
+		{
+			currScore	= (std::max)(currScore, island->GetCurrentScore());
+			maxScore	= (std::max)(maxScore, island->GetMaxScore());
+		}
+
+		bool reachedTarget = targetScore > 0 && currScore >= targetScore;
+		if (scene.GetCurrentGeneration() != currGeneration || reachedTarget)
+		{
+			if (currGeneration > 0)
+			{
+				double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - timeStart).count();
+				printf("Generation %6u. Highest Score: %6u. Ticks: %10llu. Elapsed: %.2fs\n", currGeneration, maxScore, ticks, elapsed);
+				fflush(stdout);
+			}
+
+			if (reachedTarget)
+			{
+				break;
+			}
+			currGeneration = scene.GetCurrentGeneration();
+		}
+	}
+
+	// before Unload, the rings of the worker threads go with them
+	if (traceFile && !Profiler::Get().WriteChromeTrace(traceFile))
+	{
+		std::cout << "could not write " << traceFile << std::endl;
+	}
+
+	sceneMgr.Unload();
+	return 0;
+}
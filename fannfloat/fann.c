@@ -604,6 +604,16 @@ FANN_EXTERNAL fann_type *FANN_API fann_run(struct fann * ann, fann_type * input)
 	(ann->first_layer->last_neuron - 1)->value = 1;
 #endif
 
+#ifndef FIXEDFANN
+	/* fully connected float networks use the vectorized forward pass when available */
+	if(ann->connection_rate >= 1 && fann_get_simd_level() != FANN_SIMD_NONE)
+	{
+		output = fann_run_simd(ann);
+		if(output != NULL)
+			return output;
+	}
+#endif
+
 	last_layer = ann->last_layer;
 	for(layer_it = ann->first_layer + 1; layer_it != last_layer; layer_it++)
 	{
@@ -812,6 +822,9 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
 {
 	if(ann == NULL)
 		return;
+#ifndef FIXEDFANN
+	fann_unmap_binary(ann);
+#endif
 	fann_safe_free(ann->weights);
 	fann_safe_free(ann->connections);
 	fann_safe_free(ann->first_layer->first_neuron);
@@ -837,6 +850,9 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
 	fann_safe_free( ann->scale_deviation_out );
 	fann_safe_free( ann->scale_new_min_out );
 	fann_safe_free( ann->scale_factor_out );
+	fann_safe_free( ann->simd_scratch );
+	fann_safe_free( ann->matrix_scratch );
+	fann_safe_free( ann->minibatch_order );
 #endif
 	
 	fann_safe_free(ann);
@@ -968,6 +984,8 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
     copy->rprop_delta_min = orig->rprop_delta_min;
     copy->rprop_delta_max = orig->rprop_delta_max;
     copy->rprop_delta_zero = orig->rprop_delta_zero;
+    copy->minibatch_size = orig->minibatch_size;
+    copy->minibatch_shuffle = orig->minibatch_shuffle;
 
     /* user_data is not deep copied.  user should use fann_copy_with_user_data() for that */
     copy->user_data = orig->user_data;
@@ -1290,6 +1308,8 @@ FANN_EXTERNAL void FANN_API fann_print_parameters(struct fann *ann)
 	printf("RPROP decrease factor                :%8.3f\n", ann->rprop_decrease_factor);
 	printf("RPROP delta min                      :%8.3f\n", ann->rprop_delta_min);
 	printf("RPROP delta max                      :%8.3f\n", ann->rprop_delta_max);
+	printf("Mini-batch size                      :%4d\n", ann->minibatch_size);
+	printf("Mini-batch shuffle                   :%4d\n", ann->minibatch_shuffle);
 	printf("Cascade output change fraction       :%11.6f\n", ann->cascade_output_change_fraction);
 	printf("Cascade candidate change fraction    :%11.6f\n", ann->cascade_candidate_change_fraction);
 	printf("Cascade output stagnation epochs     :%4d\n", ann->cascade_output_stagnation_epochs);
@@ -1616,6 +1636,14 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
 	ann->scale_deviation_out = NULL;
 	ann->scale_new_min_out = NULL;
 	ann->scale_factor_out = NULL;
+	ann->simd_scratch = NULL;
+	ann->simd_scratch_size = 0;
+	ann->matrix_scratch = NULL;
+	ann->matrix_scratch_size = 0;
+	ann->minibatch_order = NULL;
+	ann->minibatch_order_size = 0;
+	ann->binary_mapping = NULL;
+	ann->binary_mapping_size = 0;
 #endif	
 	
 	/* variables used for cascade correlation (reasonable defaults) */
@@ -1687,6 +1715,10 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
  	ann->sarprop_step_error_shift = 1.385f;
  	ann->sarprop_temperature = 0.015f;
  	ann->sarprop_epoch = 0;
+
+	/* Variables for use with mini-batch training (reasonable defaults) */
+	ann->minibatch_size = 32;
+	ann->minibatch_shuffle = 1;
  
 	fann_init_error_data((struct fann_error *) ann);
 
@@ -392,6 +392,30 @@ FANN_EXTERNAL unsigned int FANN_API fann_get_total_neurons(struct fann *ann);
 */ 
 FANN_EXTERNAL unsigned int FANN_API fann_get_total_connections(struct fann *ann);
 
+/* Function: fann_get_simd_level
+
+    Get the instruction set used by the vectorized forward pass of <fann_run>.
+
+    Returns:
+        The highest level supported by the CPU, limited by <fann_set_simd_level>.
+
+    See Also:
+        <fann_simd_level_enum>, <fann_set_simd_level>
+*/
+FANN_EXTERNAL enum fann_simd_level_enum FANN_API fann_get_simd_level(void);
+
+/* Function: fann_set_simd_level
+
+    Limit the instruction set used by the vectorized forward pass. Levels above the
+    one supported by the CPU are ignored, FANN_SIMD_NONE forces the portable C code.
+
+    The setting is process wide.
+
+    See Also:
+        <fann_simd_level_enum>, <fann_get_simd_level>
+*/
+FANN_EXTERNAL void FANN_API fann_set_simd_level(enum fann_simd_level_enum simd_level);
+
 /* Function: fann_get_network_type
 
     Get the type of neural network it was created as.
@@ -232,6 +232,7 @@ float fann_train_outputs_epoch(struct fann *ann, struct fann_train_data *data)
 			break;
 		case FANN_TRAIN_BATCH:
 		case FANN_TRAIN_INCREMENTAL:
+		case FANN_TRAIN_MINIBATCH:
 			fann_error((struct fann_error *) ann, FANN_E_CANT_USE_TRAIN_ALG);
 	}
 
@@ -256,6 +257,12 @@ int fann_reallocate_connections(struct fann *ann, unsigned int total_connections
 		return -1;
 	}
 
+#ifndef FIXEDFANN
+	/* the weights of a mapped network can not be reallocated */
+	if(fann_detach_binary(ann) != 0)
+		return -1;
+#endif
+
 	ann->weights = (fann_type *) realloc(ann->weights, total_connections * sizeof(fann_type));
 	if(ann->weights == NULL)
 	{
@@ -682,6 +689,7 @@ void fann_update_candidate_weights(struct fann *ann, unsigned int num_data)
 			break;
 		case FANN_TRAIN_BATCH:
 		case FANN_TRAIN_INCREMENTAL:
+		case FANN_TRAIN_MINIBATCH:
 			fann_error((struct fann_error *) ann, FANN_E_CANT_USE_TRAIN_ALG);
 			break;
 	}
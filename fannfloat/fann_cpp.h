@@ -1980,6 +1980,66 @@ namespace FANN {
             }
         }
 
+        /* Method: get_minibatch_size
+
+           Get the number of patterns FANN::TRAIN_MINIBATCH presents to the network between two
+           weight updates. The last mini-batch of an epoch may be smaller.
+
+           The default size is 32.
+
+           See also:
+           <set_minibatch_size>, <get_minibatch_shuffle>, <fann_get_minibatch_size>
+         */
+        unsigned int get_minibatch_size() {
+            unsigned int minibatch_size = 0;
+            if (ann != NULL) {
+                minibatch_size = fann_get_minibatch_size(ann);
+            }
+            return minibatch_size;
+        }
+
+        /* Method: set_minibatch_size
+
+           Set the number of patterns per weight update of FANN::TRAIN_MINIBATCH, 0 is used as 1.
+
+           More info available in <get_minibatch_size>
+         */
+        void set_minibatch_size(unsigned int minibatch_size) {
+            if (ann != NULL) {
+                fann_set_minibatch_size(ann, minibatch_size);
+            }
+        }
+
+        /* Method: get_minibatch_shuffle
+
+           Get whether FANN::TRAIN_MINIBATCH visits the training patterns in a new random order
+           every epoch.
+
+           The default is true.
+
+           See also:
+           <set_minibatch_shuffle>, <get_minibatch_size>, <fann_get_minibatch_shuffle>
+         */
+        bool get_minibatch_shuffle() {
+            bool minibatch_shuffle = false;
+            if (ann != NULL) {
+                minibatch_shuffle = fann_get_minibatch_shuffle(ann) != 0;
+            }
+            return minibatch_shuffle;
+        }
+
+        /* Method: set_minibatch_shuffle
+
+           Set whether FANN::TRAIN_MINIBATCH shuffles the patterns every epoch.
+
+           More info available in <get_minibatch_shuffle>
+         */
+        void set_minibatch_shuffle(bool minibatch_shuffle) {
+            if (ann != NULL) {
+                fann_set_minibatch_shuffle(ann, minibatch_shuffle ? 1 : 0);
+            }
+        }
+
         /* Method: get_train_stop_function
 
            Returns the the stop function used during training.
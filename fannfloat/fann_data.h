@@ -70,6 +70,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		The quickprop training algorithm is described by [Fahlman, 1988].
 	FANN_TRAIN_SARPROP - THE SARPROP ALGORITHM: A SIMULATED ANNEALING ENHANCEMENT TO RESILIENT BACK PROPAGATION
     http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.47.8197&rep=rep1&type=pdf
+	FANN_TRAIN_MINIBATCH - Stochastic gradient descent where the weights are updated after every
+		<fann_get_minibatch_size> patterns, optionally visited in a new random order every epoch.
+		Uses the learning_rate and learning_momentum. Fully connected networks evaluate each
+		mini-batch layer by layer as matrix products instead of one pattern at a time.
 	
 	See also:
 		<fann_set_training_algorithm>, <fann_get_training_algorithm>
@@ -80,7 +84,8 @@ enum fann_train_enum
 	FANN_TRAIN_BATCH,
 	FANN_TRAIN_RPROP,
 	FANN_TRAIN_QUICKPROP,
-	FANN_TRAIN_SARPROP
+	FANN_TRAIN_SARPROP,
+	FANN_TRAIN_MINIBATCH
 };
 
 /* Constant: FANN_TRAIN_NAMES
@@ -99,7 +104,8 @@ static char const *const FANN_TRAIN_NAMES[] = {
 	"FANN_TRAIN_BATCH",
 	"FANN_TRAIN_RPROP",
 	"FANN_TRAIN_QUICKPROP",
-	"FANN_TRAIN_SARPROP"
+	"FANN_TRAIN_SARPROP",
+	"FANN_TRAIN_MINIBATCH"
 };
 
 /* Enums: fann_activationfunc_enum
@@ -367,6 +373,46 @@ static char const *const FANN_NETTYPE_NAMES[] = {
 };
 
 
+/* Enum: fann_simd_level_enum
+
+	Instruction set used by the vectorized forward pass of <fann_run>. Only fully
+	connected float networks use the vectorized path, everything else always runs
+	the portable C code.
+
+	FANN_SIMD_NONE - Portable C code only.
+	FANN_SIMD_SSE2 - 4-wide SSE2 dot products and activations.
+	FANN_SIMD_AVX2 - 8-wide AVX2/FMA dot products and activations.
+
+	FANN_SIGMOID_SYMMETRIC is evaluated with a polynomial approximation of exp when
+	a SIMD level is active, results differ from the C code by less than 1e-6.
+
+	See Also:
+		<fann_get_simd_level>, <fann_set_simd_level>
+*/
+enum fann_simd_level_enum
+{
+	FANN_SIMD_NONE = 0,
+	FANN_SIMD_SSE2,
+	FANN_SIMD_AVX2
+};
+
+/* Constant: FANN_SIMD_LEVEL_NAMES
+
+   Constant array consisting of the names for the simd levels, so that the name of a
+   simd level can be received by:
+   (code)
+   char *name = FANN_SIMD_LEVEL_NAMES[fann_get_simd_level()];
+   (end)
+
+   See Also:
+      <fann_simd_level_enum>
+*/
+static char const *const FANN_SIMD_LEVEL_NAMES[] = {
+	"FANN_SIMD_NONE",
+	"FANN_SIMD_SSE2",
+	"FANN_SIMD_AVX2"
+};
+
 /* forward declarations for use with the callback */
 struct fann;
 struct fann_train_data;
@@ -743,6 +789,12 @@ struct fann
 	/* Current training epoch */
 	unsigned int sarprop_epoch;
 
+	/* Number of patterns per weight update of FANN_TRAIN_MINIBATCH */
+	unsigned int minibatch_size;
+
+	/* Whether FANN_TRAIN_MINIBATCH visits the patterns in a new random order every epoch */
+	int minibatch_shuffle;
+
 	/* Used to contain the slope errors used during batch training
 	 * Is allocated during first training session,
 	 * which means that if we do not train, it is never allocated.
@@ -797,6 +849,32 @@ struct fann
 	 * Resulting data values may be greater than user-defined maximum. 
 	 */
 	float *scale_factor_out;
+
+	/* Scratch memory for the vectorized forward pass, holds the contiguous
+	 * values of the source neurons followed by the sums of the current layer.
+	 * Allocated by the first call to fann_run.
+	 */
+	fann_type *simd_scratch;
+	unsigned int simd_scratch_size;
+
+	/* The transposed weights, then the values, sums and errors of every neuron
+	 * for each pattern of a block of the matrix-form passes. Allocated by the
+	 * first epoch or fann_test_data that evaluates the network in matrix form.
+	 */
+	fann_type *matrix_scratch;
+	unsigned int matrix_scratch_size;
+
+	/* The order a mini-batch epoch visits the patterns in, one index per pattern.
+	 * Allocated by the first mini-batch epoch.
+	 */
+	unsigned int *minibatch_order;
+	unsigned int minibatch_order_size;
+
+	/* The file mapping of a network created by fann_create_from_binary, the weights
+	 * point into it. NULL for any other network.
+	 */
+	void *binary_mapping;
+	size_t binary_mapping_size;
 #endif
 };
 
@@ -23,6 +23,18 @@
 #include <string.h>
 #include <limits.h>
 
+#ifndef FIXEDFANN
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#endif
+
 #include "config.h"
 #include "fann.h"
 #include "fann_data.h"
@@ -803,3 +815,570 @@ struct fann *fann_create_from_fd_1_1(FILE * conf, const char *configuration_file
 #endif
 	return ann;
 }
+
+#ifndef FIXEDFANN
+
+/* Binary networks.
+ *
+ * A header of fixed size is followed by the sections it points to, each aligned
+ * to FANN_BINARY_ALIGN bytes: the layer sizes, the neurons, the source of each
+ * connection, the weights, the cascade activations and the scaling parameters.
+ * Numbers are stored as in memory, the header records the byte order and the
+ * size of fann_type so that a file from another platform is rejected. The file
+ * is mapped copy-on-write and the weights are used where they lie in it.
+ */
+
+#define FANN_BINARY_MAGIC "FANN_BIN"
+#define FANN_BINARY_VERSION 1
+#define FANN_BINARY_BYTE_ORDER 0x01020304
+#define FANN_BINARY_ALIGN 64
+
+struct fann_binary_header
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int byte_order;
+	unsigned int header_size;
+	unsigned int type_size;
+
+	unsigned int num_layers;
+	unsigned int total_neurons;
+	unsigned int total_connections;
+	unsigned int network_type;
+	unsigned int scale_included;
+
+	float learning_rate;
+	float connection_rate;
+	float learning_momentum;
+	unsigned int training_algorithm;
+	unsigned int train_error_function;
+	unsigned int train_stop_function;
+	float cascade_output_change_fraction;
+	float quickprop_decay;
+	float quickprop_mu;
+	float rprop_increase_factor;
+	float rprop_decrease_factor;
+	float rprop_delta_min;
+	float rprop_delta_max;
+	float rprop_delta_zero;
+	unsigned int cascade_output_stagnation_epochs;
+	float cascade_candidate_change_fraction;
+	unsigned int cascade_candidate_stagnation_epochs;
+	unsigned int cascade_max_out_epochs;
+	unsigned int cascade_min_out_epochs;
+	unsigned int cascade_max_cand_epochs;
+	unsigned int cascade_min_cand_epochs;
+	unsigned int cascade_num_candidate_groups;
+	fann_type bit_fail_limit;
+	fann_type cascade_candidate_limit;
+	fann_type cascade_weight_multiplier;
+	unsigned int cascade_activation_functions_count;
+	unsigned int cascade_activation_steepnesses_count;
+
+	/* byte offsets from the start of the file */
+	unsigned int layer_sizes_offset;
+	unsigned int neurons_offset;
+	unsigned int connections_offset;
+	unsigned int weights_offset;
+	unsigned int cascade_offset;
+	unsigned int scale_offset;
+	unsigned int file_size;
+};
+
+struct fann_binary_neuron
+{
+	unsigned int num_inputs;
+	unsigned int activation_function;
+	fann_type activation_steepness;
+};
+
+/* Places a section of size bytes after offset, returns where it starts */
+static size_t fann_binary_section(size_t *offset, size_t size)
+{
+	size_t start = *offset;
+
+	/* empty sections take no room, so the file ends with the last byte written */
+	if(size != 0)
+		start = (start + FANN_BINARY_ALIGN - 1) / FANN_BINARY_ALIGN * FANN_BINARY_ALIGN;
+	*offset = start + size;
+	return start;
+}
+
+/* Whether count elements of size bytes at offset lie in the file and are aligned for their type */
+static int fann_binary_fits(size_t file_size, unsigned int offset, size_t count, size_t size)
+{
+	return offset % sizeof(unsigned int) == 0 && offset <= file_size &&
+		count <= (file_size - offset) / size;
+}
+
+/* Maps the whole file copy-on-write, returns NULL if it can not be opened or is empty */
+static void *fann_map_file(const char *path, size_t *size)
+{
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER file_size;
+	void *view = NULL;
+
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	if(GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && (unsigned long long) file_size.QuadPart <= (size_t) -1)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if(mapping != NULL)
+		{
+			/* the view keeps the mapping and the file open */
+			view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+		*size = (size_t) file_size.QuadPart;
+	}
+	CloseHandle(file);
+	return view;
+#else
+	struct stat file_stat;
+	void *view;
+	int file = open(path, O_RDONLY);
+
+	if(file < 0)
+		return NULL;
+
+	if(fstat(file, &file_stat) != 0 || file_stat.st_size <= 0)
+	{
+		close(file);
+		return NULL;
+	}
+
+	/* the mapping keeps the file open */
+	view = mmap(NULL, (size_t) file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+	if(view == MAP_FAILED)
+		return NULL;
+
+	*size = (size_t) file_stat.st_size;
+	return view;
+#endif
+}
+
+static void fann_unmap_file(void *mapping, size_t size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(mapping);
+#else
+	munmap(mapping, size);
+#endif
+}
+
+/* INTERNAL FUNCTION
+   Unmaps the file of a network created by fann_create_from_binary, its weights go with it.
+ */
+void fann_unmap_binary(struct fann *ann)
+{
+	if(ann->binary_mapping == NULL)
+		return;
+
+	fann_unmap_file(ann->binary_mapping, ann->binary_mapping_size);
+	ann->binary_mapping = NULL;
+	ann->binary_mapping_size = 0;
+	ann->weights = NULL;
+}
+
+/* INTERNAL FUNCTION
+   Moves the weights of a mapped network to the heap, before they are reallocated.
+ */
+int fann_detach_binary(struct fann *ann)
+{
+	fann_type *weights;
+
+	if(ann->binary_mapping == NULL)
+		return 0;
+
+	weights = (fann_type *) malloc(ann->total_connections_allocated * sizeof(fann_type));
+	if(weights == NULL)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+		return -1;
+	}
+	memcpy(weights, ann->weights, ann->total_connections_allocated * sizeof(fann_type));
+
+	fann_unmap_binary(ann);
+	ann->weights = weights;
+	return 0;
+}
+
+/* Save the network in the binary format.
+ */
+FANN_EXTERNAL int FANN_API fann_save_binary(struct fann *ann, const char *configuration_file)
+{
+	struct fann_binary_header header;
+	struct fann_binary_neuron record;
+	struct fann_layer *layer_it;
+	struct fann_neuron *neuron_it, *first_neuron, *last_neuron;
+	unsigned int sources[256];
+	unsigned int i, num_sources, layer_size;
+	size_t offset, scale_size;
+	int failed = 0;
+	FILE *conf;
+
+	first_neuron = ann->first_layer->first_neuron;
+	last_neuron = (ann->last_layer - 1)->last_neuron;
+	scale_size = ann->scale_mean_in != NULL ? 4 * (ann->num_input + ann->num_output) * sizeof(float) : 0;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FANN_BINARY_MAGIC, sizeof(header.magic));
+	header.version = FANN_BINARY_VERSION;
+	header.byte_order = FANN_BINARY_BYTE_ORDER;
+	header.header_size = sizeof(header);
+	header.type_size = sizeof(fann_type);
+
+	header.num_layers = (unsigned int)(ann->last_layer - ann->first_layer);
+	header.total_neurons = ann->total_neurons;
+	header.total_connections = ann->total_connections;
+	header.network_type = ann->network_type;
+	header.scale_included = scale_size != 0;
+
+	header.learning_rate = ann->learning_rate;
+	header.connection_rate = ann->connection_rate;
+	header.learning_momentum = ann->learning_momentum;
+	header.training_algorithm = ann->training_algorithm;
+	header.train_error_function = ann->train_error_function;
+	header.train_stop_function = ann->train_stop_function;
+	header.cascade_output_change_fraction = ann->cascade_output_change_fraction;
+	header.quickprop_decay = ann->quickprop_decay;
+	header.quickprop_mu = ann->quickprop_mu;
+	header.rprop_increase_factor = ann->rprop_increase_factor;
+	header.rprop_decrease_factor = ann->rprop_decrease_factor;
+	header.rprop_delta_min = ann->rprop_delta_min;
+	header.rprop_delta_max = ann->rprop_delta_max;
+	header.rprop_delta_zero = ann->rprop_delta_zero;
+	header.cascade_output_stagnation_epochs = ann->cascade_output_stagnation_epochs;
+	header.cascade_candidate_change_fraction = ann->cascade_candidate_change_fraction;
+	header.cascade_candidate_stagnation_epochs = ann->cascade_candidate_stagnation_epochs;
+	header.cascade_max_out_epochs = ann->cascade_max_out_epochs;
+	header.cascade_min_out_epochs = ann->cascade_min_out_epochs;
+	header.cascade_max_cand_epochs = ann->cascade_max_cand_epochs;
+	header.cascade_min_cand_epochs = ann->cascade_min_cand_epochs;
+	header.cascade_num_candidate_groups = ann->cascade_num_candidate_groups;
+	header.bit_fail_limit = ann->bit_fail_limit;
+	header.cascade_candidate_limit = ann->cascade_candidate_limit;
+	header.cascade_weight_multiplier = ann->cascade_weight_multiplier;
+	header.cascade_activation_functions_count = ann->cascade_activation_functions_count;
+	header.cascade_activation_steepnesses_count = ann->cascade_activation_steepnesses_count;
+
+	offset = sizeof(header);
+	header.layer_sizes_offset = (unsigned int) fann_binary_section(&offset, header.num_layers * sizeof(unsigned int));
+	header.neurons_offset = (unsigned int) fann_binary_section(&offset, ann->total_neurons * sizeof(struct fann_binary_neuron));
+	header.connections_offset = (unsigned int) fann_binary_section(&offset, ann->total_connections * sizeof(unsigned int));
+	header.weights_offset = (unsigned int) fann_binary_section(&offset, ann->total_connections * sizeof(fann_type));
+	header.cascade_offset = (unsigned int) fann_binary_section(&offset,
+		ann->cascade_activation_functions_count * sizeof(unsigned int) +
+		ann->cascade_activation_steepnesses_count * sizeof(fann_type));
+	header.scale_offset = (unsigned int) fann_binary_section(&offset, scale_size);
+	header.file_size = (unsigned int) offset;
+
+	/* the offsets are 32 bit */
+	if(offset > UINT_MAX)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_OPEN_CONFIG_W, configuration_file);
+		return -1;
+	}
+
+	conf = fopen(configuration_file, "wb");
+	if(!conf)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_OPEN_CONFIG_W, configuration_file);
+		return -1;
+	}
+
+	/* seeking past the end pads the gaps between the sections with zeros */
+	failed |= fwrite(&header, sizeof(header), 1, conf) != 1;
+
+	failed |= fseek(conf, header.layer_sizes_offset, SEEK_SET) != 0;
+	for(layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++)
+	{
+		layer_size = (unsigned int)(layer_it->last_neuron - layer_it->first_neuron);
+		failed |= fwrite(&layer_size, sizeof(layer_size), 1, conf) != 1;
+	}
+
+	failed |= fseek(conf, header.neurons_offset, SEEK_SET) != 0;
+	memset(&record, 0, sizeof(record));
+	for(neuron_it = first_neuron; neuron_it != last_neuron; neuron_it++)
+	{
+		record.num_inputs = neuron_it->last_con - neuron_it->first_con;
+		record.activation_function = neuron_it->activation_function;
+		record.activation_steepness = neuron_it->activation_steepness;
+		failed |= fwrite(&record, sizeof(record), 1, conf) != 1;
+	}
+
+	failed |= fseek(conf, header.connections_offset, SEEK_SET) != 0;
+	for(i = 0; i < ann->total_connections; i += num_sources)
+	{
+		num_sources = fann_min(ann->total_connections - i, sizeof(sources) / sizeof(sources[0]));
+		for(layer_size = 0; layer_size != num_sources; layer_size++)
+			sources[layer_size] = (unsigned int)(ann->connections[i + layer_size] - first_neuron);
+		failed |= fwrite(sources, sizeof(unsigned int), num_sources, conf) != num_sources;
+	}
+
+	failed |= fseek(conf, header.weights_offset, SEEK_SET) != 0;
+	failed |= fwrite(ann->weights, sizeof(fann_type), ann->total_connections, conf) != ann->total_connections;
+
+	failed |= fseek(conf, header.cascade_offset, SEEK_SET) != 0;
+	for(i = 0; i < ann->cascade_activation_functions_count; i++)
+	{
+		layer_size = ann->cascade_activation_functions[i];
+		failed |= fwrite(&layer_size, sizeof(layer_size), 1, conf) != 1;
+	}
+	failed |= fwrite(ann->cascade_activation_steepnesses, sizeof(fann_type),
+					 ann->cascade_activation_steepnesses_count, conf) != ann->cascade_activation_steepnesses_count;
+
+	if(scale_size != 0)
+	{
+		failed |= fseek(conf, header.scale_offset, SEEK_SET) != 0;
+		failed |= fwrite(ann->scale_mean_in, sizeof(float), ann->num_input, conf) != ann->num_input;
+		failed |= fwrite(ann->scale_deviation_in, sizeof(float), ann->num_input, conf) != ann->num_input;
+		failed |= fwrite(ann->scale_new_min_in, sizeof(float), ann->num_input, conf) != ann->num_input;
+		failed |= fwrite(ann->scale_factor_in, sizeof(float), ann->num_input, conf) != ann->num_input;
+		failed |= fwrite(ann->scale_mean_out, sizeof(float), ann->num_output, conf) != ann->num_output;
+		failed |= fwrite(ann->scale_deviation_out, sizeof(float), ann->num_output, conf) != ann->num_output;
+		failed |= fwrite(ann->scale_new_min_out, sizeof(float), ann->num_output, conf) != ann->num_output;
+		failed |= fwrite(ann->scale_factor_out, sizeof(float), ann->num_output, conf) != ann->num_output;
+	}
+
+	failed |= fclose(conf) != 0;
+	if(failed)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_OPEN_CONFIG_W, configuration_file);
+		return -1;
+	}
+	return 0;
+}
+
+/* Create a network from a file saved by fann_save_binary.
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_create_from_binary(const char *configuration_file)
+{
+	const struct fann_binary_header *header;
+	const struct fann_binary_neuron *records;
+	const unsigned int *layer_sizes, *sources, *functions;
+	const fann_type *steepnesses;
+	const float *scale;
+	struct fann_neuron *first_neuron, *neuron_it;
+	struct fann_layer *layer_it;
+	struct fann *ann;
+	unsigned int i, num_input, num_output;
+	size_t size = 0;
+	char *mapping;
+
+	mapping = (char *) fann_map_file(configuration_file, &size);
+	if(mapping == NULL)
+	{
+		fann_error(NULL, FANN_E_CANT_OPEN_CONFIG_R, configuration_file);
+		return NULL;
+	}
+
+	header = (const struct fann_binary_header *) mapping;
+	if(size < sizeof(*header) || memcmp(header->magic, FANN_BINARY_MAGIC, sizeof(header->magic)) != 0 ||
+	   header->version != FANN_BINARY_VERSION || header->byte_order != FANN_BINARY_BYTE_ORDER ||
+	   header->header_size != sizeof(*header) || header->type_size != sizeof(fann_type))
+	{
+		fann_unmap_file(mapping, size);
+		fann_error(NULL, FANN_E_WRONG_CONFIG_VERSION, configuration_file);
+		return NULL;
+	}
+
+	if(header->file_size != size || header->num_layers < 2 ||
+	   !fann_binary_fits(size, header->layer_sizes_offset, header->num_layers, sizeof(unsigned int)) ||
+	   !fann_binary_fits(size, header->neurons_offset, header->total_neurons, sizeof(struct fann_binary_neuron)) ||
+	   !fann_binary_fits(size, header->connections_offset, header->total_connections, sizeof(unsigned int)) ||
+	   !fann_binary_fits(size, header->weights_offset, header->total_connections, sizeof(fann_type)) ||
+	   !fann_binary_fits(size, header->cascade_offset, header->cascade_activation_functions_count, sizeof(unsigned int)) ||
+	   !fann_binary_fits(size, header->cascade_offset + header->cascade_activation_functions_count * sizeof(unsigned int),
+						 header->cascade_activation_steepnesses_count, sizeof(fann_type)))
+	{
+		fann_unmap_file(mapping, size);
+		fann_error(NULL, FANN_E_CANT_READ_CONFIG, "sections", configuration_file);
+		return NULL;
+	}
+
+	ann = fann_allocate_structure(header->num_layers);
+	if(ann == NULL)
+	{
+		fann_unmap_file(mapping, size);
+		return NULL;
+	}
+
+	/* from here on fann_destroy unmaps the file */
+	ann->binary_mapping = mapping;
+	ann->binary_mapping_size = size;
+
+	ann->learning_rate = header->learning_rate;
+	ann->connection_rate = header->connection_rate;
+	ann->network_type = (enum fann_nettype_enum)header->network_type;
+	ann->learning_momentum = header->learning_momentum;
+	ann->training_algorithm = (enum fann_train_enum)header->training_algorithm;
+	ann->train_error_function = (enum fann_errorfunc_enum)header->train_error_function;
+	ann->train_stop_function = (enum fann_stopfunc_enum)header->train_stop_function;
+	ann->cascade_output_change_fraction = header->cascade_output_change_fraction;
+	ann->quickprop_decay = header->quickprop_decay;
+	ann->quickprop_mu = header->quickprop_mu;
+	ann->rprop_increase_factor = header->rprop_increase_factor;
+	ann->rprop_decrease_factor = header->rprop_decrease_factor;
+	ann->rprop_delta_min = header->rprop_delta_min;
+	ann->rprop_delta_max = header->rprop_delta_max;
+	ann->rprop_delta_zero = header->rprop_delta_zero;
+	ann->cascade_output_stagnation_epochs = header->cascade_output_stagnation_epochs;
+	ann->cascade_candidate_change_fraction = header->cascade_candidate_change_fraction;
+	ann->cascade_candidate_stagnation_epochs = header->cascade_candidate_stagnation_epochs;
+	ann->cascade_max_out_epochs = header->cascade_max_out_epochs;
+	ann->cascade_min_out_epochs = header->cascade_min_out_epochs;
+	ann->cascade_max_cand_epochs = header->cascade_max_cand_epochs;
+	ann->cascade_min_cand_epochs = header->cascade_min_cand_epochs;
+	ann->cascade_num_candidate_groups = header->cascade_num_candidate_groups;
+	ann->bit_fail_limit = header->bit_fail_limit;
+	ann->cascade_candidate_limit = header->cascade_candidate_limit;
+	ann->cascade_weight_multiplier = header->cascade_weight_multiplier;
+
+	/* cascade activations, an empty list keeps the allocation of the defaults */
+	functions = (const unsigned int *)(mapping + header->cascade_offset);
+	steepnesses = (const fann_type *)(functions + header->cascade_activation_functions_count);
+	if(header->cascade_activation_functions_count != 0)
+	{
+		ann->cascade_activation_functions =
+			(enum fann_activationfunc_enum *)realloc(ann->cascade_activation_functions,
+			header->cascade_activation_functions_count * sizeof(enum fann_activationfunc_enum));
+		if(ann->cascade_activation_functions == NULL)
+		{
+			fann_error((struct fann_error*)ann, FANN_E_CANT_ALLOCATE_MEM);
+			fann_destroy(ann);
+			return NULL;
+		}
+	}
+	ann->cascade_activation_functions_count = header->cascade_activation_functions_count;
+	for(i = 0; i < ann->cascade_activation_functions_count; i++)
+		ann->cascade_activation_functions[i] = (enum fann_activationfunc_enum)functions[i];
+
+	if(header->cascade_activation_steepnesses_count != 0)
+	{
+		ann->cascade_activation_steepnesses =
+			(fann_type *)realloc(ann->cascade_activation_steepnesses,
+			header->cascade_activation_steepnesses_count * sizeof(fann_type));
+		if(ann->cascade_activation_steepnesses == NULL)
+		{
+			fann_error((struct fann_error*)ann, FANN_E_CANT_ALLOCATE_MEM);
+			fann_destroy(ann);
+			return NULL;
+		}
+	}
+	ann->cascade_activation_steepnesses_count = header->cascade_activation_steepnesses_count;
+	memcpy(ann->cascade_activation_steepnesses, steepnesses, ann->cascade_activation_steepnesses_count * sizeof(fann_type));
+
+	/* as in fann_create_from_fd, last_neuron - first_neuron is the size until the neurons are allocated */
+	layer_sizes = (const unsigned int *)(mapping + header->layer_sizes_offset);
+	for(layer_it = ann->first_layer, i = 0; layer_it != ann->last_layer; layer_it++, i++)
+	{
+		if(layer_sizes[i] == 0 || layer_sizes[i] > header->total_neurons - ann->total_neurons)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_READ_CONFIG, "layer_sizes", configuration_file);
+			fann_destroy(ann);
+			return NULL;
+		}
+		layer_it->first_neuron = NULL;
+		layer_it->last_neuron = layer_it->first_neuron + layer_sizes[i];
+		ann->total_neurons += layer_sizes[i];
+	}
+	if(ann->total_neurons != header->total_neurons)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_READ_CONFIG, "layer_sizes", configuration_file);
+		fann_destroy(ann);
+		return NULL;
+	}
+
+	ann->num_input = (unsigned int)(ann->first_layer->last_neuron - ann->first_layer->first_neuron - 1);
+	ann->num_output = (unsigned int)((ann->last_layer - 1)->last_neuron - (ann->last_layer - 1)->first_neuron);
+	if(ann->network_type == FANN_NETTYPE_LAYER)
+	{
+		/* one too many (bias) in the output layer */
+		ann->num_output--;
+	}
+
+	if(header->scale_included)
+	{
+		num_input = ann->num_input;
+		num_output = ann->num_output;
+		if(!fann_binary_fits(size, header->scale_offset, 4 * ((size_t) num_input + num_output), sizeof(float)) ||
+		   fann_allocate_scale(ann) != 0)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_READ_CONFIG, "scale", configuration_file);
+			fann_destroy(ann);
+			return NULL;
+		}
+
+		scale = (const float *)(mapping + header->scale_offset);
+		memcpy(ann->scale_mean_in, scale, num_input * sizeof(float));
+		memcpy(ann->scale_deviation_in, scale += num_input, num_input * sizeof(float));
+		memcpy(ann->scale_new_min_in, scale += num_input, num_input * sizeof(float));
+		memcpy(ann->scale_factor_in, scale += num_input, num_input * sizeof(float));
+		memcpy(ann->scale_mean_out, scale += num_input, num_output * sizeof(float));
+		memcpy(ann->scale_deviation_out, scale += num_output, num_output * sizeof(float));
+		memcpy(ann->scale_new_min_out, scale += num_output, num_output * sizeof(float));
+		memcpy(ann->scale_factor_out, scale += num_output, num_output * sizeof(float));
+	}
+
+	fann_allocate_neurons(ann);
+	if(ann->errno_f == FANN_E_CANT_ALLOCATE_MEM)
+	{
+		fann_destroy(ann);
+		return NULL;
+	}
+
+	records = (const struct fann_binary_neuron *)(mapping + header->neurons_offset);
+	first_neuron = ann->first_layer->first_neuron;
+	for(neuron_it = first_neuron, i = 0; i != ann->total_neurons; neuron_it++, i++)
+	{
+		if(records[i].num_inputs > header->total_connections - ann->total_connections)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_READ_NEURON, configuration_file);
+			fann_destroy(ann);
+			return NULL;
+		}
+		neuron_it->activation_function = (enum fann_activationfunc_enum)records[i].activation_function;
+		neuron_it->activation_steepness = records[i].activation_steepness;
+		neuron_it->first_con = ann->total_connections;
+		ann->total_connections += records[i].num_inputs;
+		neuron_it->last_con = ann->total_connections;
+	}
+	if(ann->total_connections != header->total_connections)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_READ_NEURON, configuration_file);
+		fann_destroy(ann);
+		return NULL;
+	}
+
+	/* struct fann points at the source neurons, only the weights are used in place */
+	ann->connections = (struct fann_neuron **) calloc(fann_max(ann->total_connections, 1), sizeof(struct fann_neuron *));
+	if(ann->connections == NULL)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+		fann_destroy(ann);
+		return NULL;
+	}
+	ann->total_connections_allocated = ann->total_connections;
+
+	sources = (const unsigned int *)(mapping + header->connections_offset);
+	for(i = 0; i != ann->total_connections; i++)
+	{
+		if(sources[i] >= ann->total_neurons)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_READ_CONNECTIONS, configuration_file);
+			fann_destroy(ann);
+			return NULL;
+		}
+		ann->connections[i] = first_neuron + sources[i];
+	}
+
+	ann->weights = (fann_type *)(mapping + header->weights_offset);
+	return ann;
+}
+
+#endif /* FIXEDFANN */
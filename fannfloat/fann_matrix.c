@@ -0,0 +1,480 @@
+/*
+  Fast Artificial Neural Network Library (fann)
+  Copyright (C) 2003-2016 Steffen Nissen (steffen.fann@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Matrix-form training and testing.
+ *
+ * In a fully connected network the weights of a layer are one dense row-major
+ * matrix, a row per neuron, so a block of patterns is evaluated layer by layer
+ * with matrix products: the sums of a layer are the values of its sources times
+ * the transposed weights, the errors of the sources are the errors of the layer
+ * times the weights and the slopes the transposed errors times the source values.
+ * The batch epochs, the mini-batch epoch and fann_test_data run on it, other
+ * networks run one pattern at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "config.h"
+#include "fann.h"
+
+#ifndef FIXEDFANN
+
+/* patterns evaluated together, bounds the scratch memory of large data sets */
+#define FANN_MATRIX_BLOCK 256
+
+/* neurons of a layer without its bias, shortcut networks only have one in the input layer */
+static unsigned int fann_matrix_num_neurons(struct fann_layer *layer)
+{
+	struct fann_neuron *last_neuron = layer->last_neuron - 1;
+	return (unsigned int)(layer->last_neuron - layer->first_neuron) - (last_neuron->first_con == last_neuron->last_con ? 1 : 0);
+}
+
+/* Whether the weights of every layer, without its bias neuron, form one dense
+ * matrix over all the source neurons.
+ */
+static int fann_matrix_dense(struct fann *ann)
+{
+	struct fann_neuron *first_neuron = ann->first_layer->first_neuron;
+	struct fann_neuron *neuron_it, *last_neuron;
+	struct fann_layer *layer_it;
+	unsigned int num_inputs, first_con;
+
+	if(ann->connection_rate < 1)
+		return 0;
+
+	for(layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++)
+	{
+		/* the previous layer, or every earlier neuron with shortcut connections */
+		if(ann->network_type == FANN_NETTYPE_SHORTCUT)
+			num_inputs = (unsigned int)(layer_it->first_neuron - first_neuron);
+		else
+			num_inputs = (unsigned int)((layer_it - 1)->last_neuron - (layer_it - 1)->first_neuron);
+
+		last_neuron = layer_it->first_neuron + fann_matrix_num_neurons(layer_it);
+		first_con = layer_it->first_neuron->first_con;
+		for(neuron_it = layer_it->first_neuron; neuron_it != last_neuron; neuron_it++)
+		{
+			if(neuron_it->first_con != first_con || neuron_it->last_con != first_con + num_inputs)
+				return 0;
+			first_con += num_inputs;
+		}
+	}
+	return 1;
+}
+
+/* the transposed weights, followed by num_matrices of num_rows patterns times every neuron */
+static fann_type *fann_matrix_scratch(struct fann *ann, unsigned int num_matrices, unsigned int num_rows)
+{
+	fann_type *scratch;
+	unsigned int scratch_size = ann->total_connections + num_matrices * num_rows * ann->total_neurons;
+
+	if(ann->matrix_scratch_size < scratch_size)
+	{
+		scratch = (fann_type *) realloc(ann->matrix_scratch, scratch_size * sizeof(fann_type));
+		if(scratch == NULL)
+			return NULL;
+		ann->matrix_scratch = scratch;
+		ann->matrix_scratch_size = scratch_size;
+	}
+	return ann->matrix_scratch;
+}
+
+/* The weights of each layer transposed into a column per neuron, at the same
+ * offsets, so that a row of sums is accumulated from whole rows of weights.
+ */
+static void fann_matrix_transpose(struct fann *ann, fann_type *transposed)
+{
+	struct fann_layer *layer_it;
+	fann_type *weights, *columns;
+	unsigned int i, k, num_neurons, num_inputs;
+
+	for(layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++)
+	{
+		num_neurons = fann_matrix_num_neurons(layer_it);
+		num_inputs = layer_it->first_neuron->last_con - layer_it->first_neuron->first_con;
+		weights = ann->weights + layer_it->first_neuron->first_con;
+		columns = transposed + layer_it->first_neuron->first_con;
+		for(k = 0; k != num_inputs; k++)
+		{
+			for(i = 0; i != num_neurons; i++)
+				columns[(size_t) k * num_neurons + i] = weights[(size_t) i * num_inputs + k];
+		}
+	}
+}
+
+/* Same sums and values as fann_run for each pattern, row r of both matrices holds
+ * every neuron of the pattern order[r], or first + r without an order.
+ */
+static void fann_matrix_forward(struct fann *ann, struct fann_train_data *data, const unsigned int *order,
+								unsigned int first, unsigned int num_rows, fann_type *transposed,
+								fann_type *values, fann_type *sums)
+{
+	const unsigned int total_neurons = ann->total_neurons;
+	const unsigned int num_input = ann->num_input;
+	struct fann_neuron *first_neuron = ann->first_layer->first_neuron;
+	struct fann_layer *layer_it;
+	struct fann_neuron *neuron_it;
+	fann_type *value_row, *sum_row;
+	fann_type neuron_sum, max_sum, steepness;
+	unsigned int r, i, offset, num_neurons, first_input, num_inputs;
+	int sigmoid_symmetric, same_steepness;
+
+	/* input layer and its bias */
+	for(r = 0; r != num_rows; r++)
+	{
+		value_row = values + (size_t) r * total_neurons;
+		memcpy(value_row, data->input[order != NULL ? order[r] : first + r], num_input * sizeof(fann_type));
+		value_row[num_input] = 1;
+	}
+
+	for(layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++)
+	{
+		offset = (unsigned int)(layer_it->first_neuron - first_neuron);
+		num_neurons = fann_matrix_num_neurons(layer_it);
+		first_input = ann->network_type == FANN_NETTYPE_SHORTCUT ? 0 : (unsigned int)((layer_it - 1)->first_neuron - first_neuron);
+		num_inputs = layer_it->first_neuron->last_con - layer_it->first_neuron->first_con;
+
+		for(r = 0; r != num_rows; r++)
+			memset(sums + (size_t) r * total_neurons + offset, 0, num_neurons * sizeof(fann_type));
+		fann_gemm_nn(num_rows, num_neurons, num_inputs, values + first_input, total_neurons,
+					 transposed + layer_it->first_neuron->first_con, num_neurons, sums + offset, total_neurons);
+
+		/* the usual activation of the hidden layers has a vector kernel, and the
+		   clamp of a layer with a single steepness is a single division */
+		sigmoid_symmetric = 1;
+		same_steepness = 1;
+		for(i = 0, neuron_it = layer_it->first_neuron; i != num_neurons; i++, neuron_it++)
+		{
+			if(neuron_it->activation_function != FANN_SIGMOID_SYMMETRIC)
+				sigmoid_symmetric = 0;
+			if(neuron_it->activation_steepness != layer_it->first_neuron->activation_steepness)
+				same_steepness = 0;
+		}
+		steepness = layer_it->first_neuron->activation_steepness;
+		max_sum = 150/steepness;
+
+		/* steepness, clamping and activation as in fann_run */
+		for(r = 0; r != num_rows; r++)
+		{
+			value_row = values + (size_t) r * total_neurons + offset;
+			sum_row = sums + (size_t) r * total_neurons + offset;
+			for(i = 0, neuron_it = layer_it->first_neuron; i != num_neurons; i++, neuron_it++)
+			{
+				if(!same_steepness)
+				{
+					steepness = neuron_it->activation_steepness;
+					max_sum = 150/steepness;
+				}
+				neuron_sum = fann_mult(steepness, sum_row[i]);
+
+				if(neuron_sum > max_sum)
+					neuron_sum = max_sum;
+				else if(neuron_sum < -max_sum)
+					neuron_sum = -max_sum;
+
+				sum_row[i] = neuron_sum;
+				value_row[i] = neuron_sum;
+			}
+
+			if(!sigmoid_symmetric || !fann_sigmoid_symmetric_simd(value_row, num_neurons))
+			{
+				for(i = 0, neuron_it = layer_it->first_neuron; i != num_neurons; i++, neuron_it++)
+					fann_activation_switch(neuron_it->activation_function, sum_row[i], value_row[i]);
+			}
+			if(layer_it->first_neuron + num_neurons != layer_it->last_neuron)
+			{
+				value_row[num_neurons] = 1;
+				sum_row[num_neurons] = 0;
+			}
+		}
+	}
+}
+
+/* Same slopes, MSE and bit fails as fann_run, fann_compute_MSE, fann_backpropagate_MSE
+ * and fann_update_slopes_batch for each pattern, one layer of all the patterns at a time.
+ */
+static void fann_matrix_train_block(struct fann *ann, struct fann_train_data *data, const unsigned int *order,
+									unsigned int first, unsigned int num_rows, fann_type *scratch)
+{
+	const unsigned int total_neurons = ann->total_neurons;
+	const unsigned int num_output = ann->num_output;
+	fann_type *values = scratch + ann->total_connections;
+	fann_type *sums = values + (size_t) num_rows * total_neurons;
+	fann_type *errors = sums + (size_t) num_rows * total_neurons;
+	struct fann_neuron *first_neuron = ann->first_layer->first_neuron;
+	struct fann_layer *second_layer = ann->first_layer + 1;
+	struct fann_layer *last_layer = ann->last_layer;
+	struct fann_layer *layer_it;
+	struct fann_neuron *neuron_it, *output_neurons;
+	fann_type *value_row, *sum_row, *error_row, *desired_output;
+	fann_type neuron_value, neuron_diff;
+	unsigned int r, i, offset, num_neurons, first_input, num_inputs;
+
+	fann_matrix_forward(ann, data, order, first, num_rows, scratch, values, sums);
+
+	memset(errors, 0, (size_t) num_rows * total_neurons * sizeof(fann_type));
+
+	/* output errors as in fann_compute_MSE */
+	output_neurons = (last_layer - 1)->first_neuron;
+	offset = (unsigned int)(output_neurons - first_neuron);
+	for(r = 0; r != num_rows; r++)
+	{
+		desired_output = data->output[order != NULL ? order[r] : first + r];
+		value_row = values + (size_t) r * total_neurons + offset;
+		sum_row = sums + (size_t) r * total_neurons + offset;
+		error_row = errors + (size_t) r * total_neurons + offset;
+		for(i = 0; i != num_output; i++)
+		{
+			neuron_value = value_row[i];
+			neuron_diff = fann_update_MSE(ann, output_neurons + i, desired_output[i] - neuron_value);
+
+			if(ann->train_error_function)
+			{
+				if(neuron_diff < -.9999999)
+					neuron_diff = -17.0;
+				else if(neuron_diff > .9999999)
+					neuron_diff = 17.0;
+				else
+					neuron_diff = (fann_type) log((1.0 + neuron_diff) / (1.0 - neuron_diff));
+			}
+
+			error_row[i] = fann_activation_derived(output_neurons[i].activation_function,
+												   output_neurons[i].activation_steepness, neuron_value,
+												   sum_row[i]) * neuron_diff;
+			ann->num_MSE++;
+		}
+	}
+
+	/* backpropagation as in fann_backpropagate_MSE */
+	for(layer_it = last_layer - 1; layer_it > second_layer; --layer_it)
+	{
+		offset = (unsigned int)(layer_it->first_neuron - first_neuron);
+		num_neurons = fann_matrix_num_neurons(layer_it);
+		first_input = ann->network_type == FANN_NETTYPE_SHORTCUT ? 0 : (unsigned int)((layer_it - 1)->first_neuron - first_neuron);
+		num_inputs = layer_it->first_neuron->last_con - layer_it->first_neuron->first_con;
+
+		fann_gemm_nn(num_rows, num_inputs, num_neurons, errors + offset, total_neurons,
+					 ann->weights + layer_it->first_neuron->first_con, num_inputs, errors + first_input, total_neurons);
+
+		offset = (unsigned int)((layer_it - 1)->first_neuron - first_neuron);
+		num_neurons = fann_matrix_num_neurons(layer_it - 1);
+		for(r = 0; r != num_rows; r++)
+		{
+			value_row = values + (size_t) r * total_neurons + offset;
+			sum_row = sums + (size_t) r * total_neurons + offset;
+			error_row = errors + (size_t) r * total_neurons + offset;
+			for(i = 0, neuron_it = (layer_it - 1)->first_neuron; i != num_neurons; i++, neuron_it++)
+			{
+				error_row[i] *= fann_activation_derived(neuron_it->activation_function,
+														neuron_it->activation_steepness, value_row[i], sum_row[i]);
+			}
+		}
+	}
+
+	/* slopes as in fann_update_slopes_batch */
+	for(layer_it = second_layer; layer_it != last_layer; layer_it++)
+	{
+		offset = (unsigned int)(layer_it->first_neuron - first_neuron);
+		num_neurons = fann_matrix_num_neurons(layer_it);
+		first_input = ann->network_type == FANN_NETTYPE_SHORTCUT ? 0 : (unsigned int)((layer_it - 1)->first_neuron - first_neuron);
+		num_inputs = layer_it->first_neuron->last_con - layer_it->first_neuron->first_con;
+
+		fann_gemm_tn(num_neurons, num_inputs, num_rows, errors + offset, total_neurons,
+					 values + first_input, total_neurons, ann->train_slopes + layer_it->first_neuron->first_con, num_inputs);
+	}
+}
+
+/* INTERNAL FUNCTION
+   The order a mini-batch epoch visits the patterns in, shuffled again on every call
+   when minibatch_shuffle is set and the order of the data otherwise.
+ */
+unsigned int *fann_minibatch_order(struct fann *ann, unsigned int num_data)
+{
+	unsigned int *order;
+	unsigned int i, swap, temp;
+
+	if(ann->minibatch_order_size != num_data)
+	{
+		order = (unsigned int *) realloc(ann->minibatch_order, num_data * sizeof(unsigned int));
+		if(order == NULL)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+			return NULL;
+		}
+		ann->minibatch_order = order;
+		ann->minibatch_order_size = num_data;
+
+		for(i = 0; i != num_data; i++)
+			order[i] = i;
+	}
+
+	order = ann->minibatch_order;
+	if(!ann->minibatch_shuffle)
+	{
+		/* an earlier epoch may have shuffled it */
+		for(i = 0; i != num_data; i++)
+			order[i] = i;
+	}
+	else
+	{
+		/* Fisher-Yates, two calls since RAND_MAX may be as small as 32767 */
+		for(i = num_data; i > 1; i--)
+		{
+			swap = (unsigned int)((((unsigned long) rand() << 15) ^ (unsigned long) rand()) % i);
+			temp = order[i - 1];
+			order[i - 1] = order[swap];
+			order[swap] = temp;
+		}
+	}
+	return order;
+}
+
+/* INTERNAL FUNCTION
+   Adds the slopes of the patterns order[0, num_data), or [first, first + num_data)
+   without an order, to train_slopes and their errors to the MSE.
+ */
+void fann_matrix_slopes(struct fann *ann, struct fann_train_data *data, const unsigned int *order,
+						unsigned int first, unsigned int num_data)
+{
+	fann_type *scratch = NULL;
+	unsigned int i, pattern, num_rows;
+
+	if(ann->train_slopes == NULL)
+	{
+		ann->train_slopes = (fann_type *) calloc(ann->total_connections_allocated, sizeof(fann_type));
+		if(ann->train_slopes == NULL)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+			return;
+		}
+	}
+
+	/* without vector kernels the products are no faster than fann_run */
+	if(fann_get_simd_level() != FANN_SIMD_NONE && fann_matrix_dense(ann))
+		scratch = fann_matrix_scratch(ann, 3, fann_min(num_data, FANN_MATRIX_BLOCK));
+
+	if(scratch == NULL)
+	{
+		/* sparse networks, or no memory for the matrices */
+		for(i = 0; i != num_data; i++)
+		{
+			pattern = order != NULL ? order[i] : first + i;
+			fann_run(ann, data->input[pattern]);
+			fann_compute_MSE(ann, data->output[pattern]);
+			fann_backpropagate_MSE(ann);
+			fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
+		}
+		return;
+	}
+
+	fann_matrix_transpose(ann, scratch);
+	for(i = 0; i != num_data; i += num_rows)
+	{
+		num_rows = fann_min(num_data - i, FANN_MATRIX_BLOCK);
+		fann_matrix_train_block(ann, data, order != NULL ? order + i : NULL, first + i, num_rows, scratch);
+	}
+}
+
+/* INTERNAL FUNCTION
+   Adds the errors of every pattern to the MSE, as fann_test does. Returns 0 without
+   touching the MSE when there are no vector kernels, the network is not dense or the
+   matrices can not be allocated.
+ */
+int fann_matrix_test(struct fann *ann, struct fann_train_data *data)
+{
+	const unsigned int total_neurons = ann->total_neurons;
+	const unsigned int num_output = ann->num_output;
+	struct fann_neuron *output_neurons = (ann->last_layer - 1)->first_neuron;
+	const unsigned int offset = (unsigned int)(output_neurons - ann->first_layer->first_neuron);
+	fann_type *scratch, *values, *sums, *value_row, *desired_output;
+	unsigned int first, num_rows, r, i;
+
+	if(data->num_data == 0 || fann_get_simd_level() == FANN_SIMD_NONE || !fann_matrix_dense(ann))
+		return 0;
+
+	num_rows = fann_min(data->num_data, FANN_MATRIX_BLOCK);
+	scratch = fann_matrix_scratch(ann, 2, num_rows);
+	if(scratch == NULL)
+		return 0;
+	values = scratch + ann->total_connections;
+	sums = values + (size_t) num_rows * total_neurons;
+
+	fann_matrix_transpose(ann, scratch);
+	for(first = 0; first != data->num_data; first += num_rows)
+	{
+		num_rows = fann_min(data->num_data - first, FANN_MATRIX_BLOCK);
+		fann_matrix_forward(ann, data, NULL, first, num_rows, scratch, values, sums);
+
+		for(r = 0; r != num_rows; r++)
+		{
+			desired_output = data->output[first + r];
+			value_row = values + (size_t) r * total_neurons + offset;
+			for(i = 0; i != num_output; i++)
+			{
+				fann_update_MSE(ann, output_neurons + i, desired_output[i] - value_row[i]);
+				ann->num_MSE++;
+			}
+		}
+	}
+	return 1;
+}
+
+/*
+ * Internal train function
+ */
+float fann_train_epoch_minibatch(struct fann *ann, struct fann_train_data *data)
+{
+	const unsigned int batch_size = fann_max(ann->minibatch_size, 1);
+	unsigned int *order;
+	unsigned int first, num_rows;
+
+	fann_reset_MSE(ann);
+	if(data->num_data == 0)
+		return 0;
+
+	if(ann->prev_weights_deltas == NULL)
+	{
+		ann->prev_weights_deltas = (fann_type *) calloc(ann->total_connections_allocated, sizeof(fann_type));
+		if(ann->prev_weights_deltas == NULL)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+			return 0;
+		}
+	}
+
+	order = fann_minibatch_order(ann, data->num_data);
+	if(order == NULL)
+		return 0;
+
+	for(first = 0; first != data->num_data; first += num_rows)
+	{
+		num_rows = fann_min(data->num_data - first, batch_size);
+		fann_matrix_slopes(ann, data, order + first, 0, num_rows);
+		if(ann->train_slopes == NULL)
+			break;
+		fann_update_weights_minibatch(ann, num_rows, 0, ann->total_connections);
+	}
+
+	return fann_get_MSE(ann);
+}
+
+#endif /* FIXEDFANN */
@@ -0,0 +1,719 @@
+/*
+  Fast Artificial Neural Network Library (fann)
+  Copyright (C) 2003-2016 Steffen Nissen (steffen.fann@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Vectorized forward pass and matrix products for fully connected float networks.
+ *
+ * The kernels are compiled for SSE2 and AVX2/FMA regardless of the compiler
+ * flags and selected at runtime from the cpuid bits, so the library still
+ * runs on machines without AVX2.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "config.h"
+#include "fann.h"
+
+#ifndef FIXEDFANN
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FANN_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FANN_TARGET_SSE2
+#define FANN_TARGET_AVX2
+#else
+#define FANN_TARGET_SSE2 __attribute__((target("sse2")))
+#define FANN_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+/* cephes polynomial for exp(x), x in [-ln(2)/2, ln(2)/2] */
+#define FANN_EXP_HI 88.0f
+#define FANN_EXP_LO -88.0f
+#define FANN_EXP_LOG2E 1.44269504088896341f
+#define FANN_EXP_C1 0.693359375f
+#define FANN_EXP_C2 -2.12194440e-4f
+#define FANN_EXP_P0 1.9875691500e-4f
+#define FANN_EXP_P1 1.3981999507e-3f
+#define FANN_EXP_P2 8.3334519073e-3f
+#define FANN_EXP_P3 4.1665795894e-2f
+#define FANN_EXP_P4 1.6666665459e-1f
+#define FANN_EXP_P5 5.0000001201e-1f
+
+/* below this many elements the vector setup costs more than it saves */
+#define FANN_SIMD_MIN_WIDTH 8
+
+static int fann_simd_detected = -1;
+static enum fann_simd_level_enum fann_simd_limit = FANN_SIMD_AVX2;
+
+static enum fann_simd_level_enum fann_simd_detect(void)
+{
+#ifdef FANN_SIMD_X86
+#ifdef _MSC_VER
+	int info[4];
+	int max_leaf, has_sse2, has_avx, has_fma, has_osxsave, has_avx2 = 0;
+
+	__cpuid(info, 0);
+	max_leaf = info[0];
+	__cpuid(info, 1);
+	has_sse2 = (info[3] >> 26) & 1;
+	has_fma = (info[2] >> 12) & 1;
+	has_osxsave = (info[2] >> 27) & 1;
+	has_avx = (info[2] >> 28) & 1;
+	if(max_leaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		has_avx2 = (info[1] >> 5) & 1;
+	}
+
+	/* the os has to save the ymm registers as well */
+	if(has_avx && has_fma && has_avx2 && has_osxsave && (_xgetbv(0) & 6) == 6)
+		return FANN_SIMD_AVX2;
+	if(has_sse2)
+		return FANN_SIMD_SSE2;
+#else
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return FANN_SIMD_AVX2;
+	if(__builtin_cpu_supports("sse2"))
+		return FANN_SIMD_SSE2;
+#endif
+#endif
+	return FANN_SIMD_NONE;
+}
+
+FANN_EXTERNAL enum fann_simd_level_enum FANN_API fann_get_simd_level(void)
+{
+	if(fann_simd_detected < 0)
+		fann_simd_detected = (int)fann_simd_detect();
+
+	return (fann_simd_detected < (int)fann_simd_limit) ?
+		(enum fann_simd_level_enum)fann_simd_detected : fann_simd_limit;
+}
+
+FANN_EXTERNAL void FANN_API fann_set_simd_level(enum fann_simd_level_enum simd_level)
+{
+	fann_simd_limit = simd_level;
+}
+
+static fann_type fann_dot_c(const fann_type *weights, const fann_type *values,
+							unsigned int num_connections)
+{
+	fann_type neuron_sum = 0;
+	unsigned int i;
+
+	for(i = 0; i != num_connections; i++)
+		neuron_sum += fann_mult(weights[i], values[i]);
+
+	return neuron_sum;
+}
+
+#ifdef FANN_SIMD_X86
+
+FANN_TARGET_SSE2 static fann_type fann_dot_sse2(const fann_type *weights, const fann_type *values,
+												unsigned int num_connections)
+{
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+	float partial[4];
+	fann_type neuron_sum;
+	unsigned int i = 0;
+
+	for(; i + 8 <= num_connections; i += 8)
+	{
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(weights + i), _mm_loadu_ps(values + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(weights + i + 4), _mm_loadu_ps(values + i + 4)));
+	}
+	if(i + 4 <= num_connections)
+	{
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(weights + i), _mm_loadu_ps(values + i)));
+		i += 4;
+	}
+
+	_mm_storeu_ps(partial, _mm_add_ps(sum0, sum1));
+	neuron_sum = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+	for(; i != num_connections; i++)
+		neuron_sum += weights[i] * values[i];
+
+	return neuron_sum;
+}
+
+FANN_TARGET_SSE2 static __m128 fann_exp_sse2(__m128 x)
+{
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 fx, floor_fx, z, y;
+	__m128i pow2n;
+
+	x = _mm_min_ps(x, _mm_set1_ps(FANN_EXP_HI));
+	x = _mm_max_ps(x, _mm_set1_ps(FANN_EXP_LO));
+
+	/* exp(x) = 2^n * exp(r), n = round(x / ln(2)) */
+	fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(FANN_EXP_LOG2E)), _mm_set1_ps(0.5f));
+	floor_fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	fx = _mm_sub_ps(floor_fx, _mm_and_ps(_mm_cmpgt_ps(floor_fx, fx), one));
+
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(FANN_EXP_C1)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(FANN_EXP_C2)));
+	z = _mm_mul_ps(x, x);
+
+	y = _mm_set1_ps(FANN_EXP_P0);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(FANN_EXP_P1));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(FANN_EXP_P2));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(FANN_EXP_P3));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(FANN_EXP_P4));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(FANN_EXP_P5));
+	y = _mm_add_ps(_mm_mul_ps(y, z), x);
+	y = _mm_add_ps(y, one);
+
+	pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f)), 23);
+	return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+/* 2/(1+exp(-2x)) - 1, in place */
+FANN_TARGET_SSE2 static void fann_sigmoid_symmetric_sse2(fann_type *sums, unsigned int num_sums)
+{
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 two = _mm_set1_ps(2.0f);
+	__m128 x;
+	float tail[4];
+	unsigned int i = 0, j;
+
+	for(; i + 4 <= num_sums; i += 4)
+	{
+		x = fann_exp_sse2(_mm_mul_ps(_mm_loadu_ps(sums + i), _mm_set1_ps(-2.0f)));
+		_mm_storeu_ps(sums + i, _mm_sub_ps(_mm_div_ps(two, _mm_add_ps(one, x)), one));
+	}
+	if(i != num_sums)
+	{
+		for(j = 0; j != 4; j++)
+			tail[j] = (i + j < num_sums) ? sums[i + j] : 0;
+		fann_sigmoid_symmetric_sse2(tail, 4);
+		for(j = 0; i + j != num_sums; j++)
+			sums[i + j] = tail[j];
+	}
+}
+
+FANN_TARGET_AVX2 static fann_type fann_dot_avx2(const fann_type *weights, const fann_type *values,
+												unsigned int num_connections)
+{
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	__m128 sum;
+	fann_type neuron_sum;
+	unsigned int i = 0;
+
+	for(; i + 16 <= num_connections; i += 16)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i), _mm256_loadu_ps(values + i), sum0);
+		sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i + 8), _mm256_loadu_ps(values + i + 8), sum1);
+	}
+	if(i + 8 <= num_connections)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i), _mm256_loadu_ps(values + i), sum0);
+		i += 8;
+	}
+
+	sum0 = _mm256_add_ps(sum0, sum1);
+	sum = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+	if(i + 4 <= num_connections)
+	{
+		sum = _mm_fmadd_ps(_mm_loadu_ps(weights + i), _mm_loadu_ps(values + i), sum);
+		i += 4;
+	}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	neuron_sum = _mm_cvtss_f32(sum);
+
+	for(; i != num_connections; i++)
+		neuron_sum += weights[i] * values[i];
+
+	return neuron_sum;
+}
+
+FANN_TARGET_AVX2 static __m256 fann_exp_avx2(__m256 x)
+{
+	__m256 fx, z, y;
+	__m256i pow2n;
+
+	x = _mm256_min_ps(x, _mm256_set1_ps(FANN_EXP_HI));
+	x = _mm256_max_ps(x, _mm256_set1_ps(FANN_EXP_LO));
+
+	fx = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(FANN_EXP_LOG2E), _mm256_set1_ps(0.5f)));
+
+	x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(FANN_EXP_C1), x);
+	x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(FANN_EXP_C2), x);
+	z = _mm256_mul_ps(x, x);
+
+	y = _mm256_set1_ps(FANN_EXP_P0);
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(FANN_EXP_P1));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(FANN_EXP_P2));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(FANN_EXP_P3));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(FANN_EXP_P4));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(FANN_EXP_P5));
+	y = _mm256_fmadd_ps(y, z, x);
+	y = _mm256_add_ps(y, _mm256_set1_ps(1.0f));
+
+	pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(0x7f)), 23);
+	return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+FANN_TARGET_AVX2 static void fann_sigmoid_symmetric_avx2(fann_type *sums, unsigned int num_sums)
+{
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 two = _mm256_set1_ps(2.0f);
+	__m256 x;
+	float tail[8];
+	unsigned int i = 0, j;
+
+	for(; i + 8 <= num_sums; i += 8)
+	{
+		x = fann_exp_avx2(_mm256_mul_ps(_mm256_loadu_ps(sums + i), _mm256_set1_ps(-2.0f)));
+		_mm256_storeu_ps(sums + i, _mm256_sub_ps(_mm256_div_ps(two, _mm256_add_ps(one, x)), one));
+	}
+	if(i != num_sums)
+	{
+		for(j = 0; j != 8; j++)
+			tail[j] = (i + j < num_sums) ? sums[i + j] : 0;
+		fann_sigmoid_symmetric_avx2(tail, 8);
+		for(j = 0; i + j != num_sums; j++)
+			sums[i + j] = tail[j];
+	}
+}
+
+#endif /* FANN_SIMD_X86 */
+
+/* Applies steepness, clamping and the activation function to the sums of the
+ * neurons [first, last), which all share activation function and steepness.
+ */
+static void fann_simd_activate(enum fann_simd_level_enum level, struct fann_neuron *first,
+							   struct fann_neuron *last, fann_type *sums)
+{
+	unsigned int activation_function = first->activation_function;
+	fann_type steepness = first->activation_steepness;
+	fann_type max_sum = 150/steepness;
+	fann_type neuron_sum;
+	unsigned int i, num_sums = (unsigned int)(last - first);
+
+	for(i = 0; i != num_sums; i++)
+	{
+		neuron_sum = fann_mult(steepness, sums[i]);
+		if(neuron_sum > max_sum)
+			neuron_sum = max_sum;
+		else if(neuron_sum < -max_sum)
+			neuron_sum = -max_sum;
+
+		first[i].sum = neuron_sum;
+		sums[i] = neuron_sum;
+	}
+
+#ifdef FANN_SIMD_X86
+	if(activation_function == FANN_SIGMOID_SYMMETRIC && num_sums >= FANN_SIMD_MIN_WIDTH)
+	{
+		if(level == FANN_SIMD_AVX2)
+			fann_sigmoid_symmetric_avx2(sums, num_sums);
+		else
+			fann_sigmoid_symmetric_sse2(sums, num_sums);
+
+		for(i = 0; i != num_sums; i++)
+			first[i].value = sums[i];
+		return;
+	}
+#endif
+
+	for(i = 0; i != num_sums; i++)
+	{
+		fann_activation_switch(activation_function, sums[i], first[i].value);
+	}
+}
+
+/* INTERNAL FUNCTION
+   The symmetric sigmoid of num_values sums in place. Returns 0 without touching
+   them when no kernel is available.
+ */
+int fann_sigmoid_symmetric_simd(fann_type *values, unsigned int num_values)
+{
+#ifdef FANN_SIMD_X86
+	enum fann_simd_level_enum level = fann_get_simd_level();
+
+	if(level == FANN_SIMD_AVX2)
+	{
+		fann_sigmoid_symmetric_avx2(values, num_values);
+		return 1;
+	}
+	if(level == FANN_SIMD_SSE2)
+	{
+		fann_sigmoid_symmetric_sse2(values, num_values);
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+/* Same result as the fully connected path of fann_run. The values of the source
+ * neurons are gathered into one contiguous array so that both the weights and the
+ * values can be streamed with vector loads. Returns NULL if no kernel is available,
+ * the network is too narrow to benefit or the scratch memory could not be allocated,
+ * fann_run then falls back to the C code.
+ */
+fann_type *fann_run_simd(struct fann *ann)
+{
+	struct fann_neuron *neuron_it, *last_neuron, *neurons, *group_first;
+	struct fann_layer *layer_it, *last_layer;
+	fann_type *values, *sums, *output;
+	unsigned int i, num_connections, num_gathered, num_output, scratch_size;
+	enum fann_simd_level_enum level = fann_get_simd_level();
+
+#ifndef FANN_SIMD_X86
+	return NULL;
+#else
+	/* narrow networks are faster in the C code */
+	if(ann->total_connections < FANN_SIMD_MIN_WIDTH * ann->total_neurons)
+		return NULL;
+
+	/* source values plus one sum per neuron, a layer never exceeds the whole network */
+	scratch_size = 2 * ann->total_neurons;
+	if(ann->simd_scratch_size < scratch_size)
+	{
+		values = (fann_type *) realloc(ann->simd_scratch, scratch_size * sizeof(fann_type));
+		if(values == NULL)
+			return NULL;
+		ann->simd_scratch = values;
+		ann->simd_scratch_size = scratch_size;
+	}
+	values = ann->simd_scratch;
+	sums = ann->simd_scratch + ann->total_neurons;
+
+	last_layer = ann->last_layer;
+	for(layer_it = ann->first_layer + 1; layer_it != last_layer; layer_it++)
+	{
+		if(ann->network_type == FANN_NETTYPE_SHORTCUT)
+		{
+			neurons = ann->first_layer->first_neuron;
+		}
+		else
+		{
+			neurons = (layer_it - 1)->first_neuron;
+		}
+
+		/* the source neurons never belong to the current layer, gather them once */
+		num_gathered = 0;
+		last_neuron = layer_it->last_neuron;
+		for(neuron_it = layer_it->first_neuron; neuron_it != last_neuron; neuron_it++)
+		{
+			if(neuron_it->first_con == neuron_it->last_con)
+				continue;
+
+			num_connections = neuron_it->last_con - neuron_it->first_con;
+			for(; num_gathered < num_connections; num_gathered++)
+				values[num_gathered] = neurons[num_gathered].value;
+
+			i = (unsigned int)(neuron_it - layer_it->first_neuron);
+			if(num_connections < FANN_SIMD_MIN_WIDTH)
+				sums[i] = fann_dot_c(ann->weights + neuron_it->first_con, values, num_connections);
+			else if(level == FANN_SIMD_AVX2)
+				sums[i] = fann_dot_avx2(ann->weights + neuron_it->first_con, values, num_connections);
+			else
+				sums[i] = fann_dot_sse2(ann->weights + neuron_it->first_con, values, num_connections);
+		}
+
+		/* activate runs of neurons sharing activation function and steepness */
+		group_first = layer_it->first_neuron;
+		for(neuron_it = layer_it->first_neuron;; neuron_it++)
+		{
+			if(neuron_it != last_neuron && neuron_it->first_con != neuron_it->last_con &&
+			   neuron_it->activation_function == group_first->activation_function &&
+			   neuron_it->activation_steepness == group_first->activation_steepness)
+				continue;
+
+			if(group_first != neuron_it)
+			{
+				fann_simd_activate(level, group_first, neuron_it,
+								   sums + (group_first - layer_it->first_neuron));
+			}
+
+			if(neuron_it == last_neuron)
+				break;
+
+			if(neuron_it->first_con == neuron_it->last_con)
+			{
+				/* bias neurons */
+				neuron_it->value = 1;
+				group_first = neuron_it + 1;
+			}
+			else
+			{
+				group_first = neuron_it;
+			}
+		}
+	}
+
+	/* set the output */
+	output = ann->output;
+	num_output = ann->num_output;
+	neurons = (ann->last_layer - 1)->first_neuron;
+	for(i = 0; i != num_output; i++)
+	{
+		output[i] = neurons[i].value;
+	}
+	return ann->output;
+#endif
+}
+
+/* Matrix products of the matrix-form passes, all matrices row-major with a
+ * leading dimension each. A product is cut into panels of at most FANN_GEMM_NC
+ * columns and FANN_GEMM_KC steps of depth, which stay in cache while blocks of
+ * 4 rows of C are accumulated in registers from broadcasts of A and rows of B.
+ */
+
+/* C[m][n] += sum_k A[m * sam + k * sak] * B[k][n], a transposed A is a swap of the strides */
+static void fann_gemm_acc_c(unsigned int M, unsigned int N, unsigned int K, const fann_type *A,
+							unsigned int sam, unsigned int sak, const fann_type *B, unsigned int ldb,
+							fann_type *C, unsigned int ldc)
+{
+	const fann_type *b;
+	fann_type *c, a;
+	unsigned int m, n, k;
+
+	for(m = 0; m != M; m++)
+	{
+		c = C + (size_t) m * ldc;
+		for(k = 0; k != K; k++)
+		{
+			a = A[(size_t) m * sam + (size_t) k * sak];
+			b = B + (size_t) k * ldb;
+			for(n = 0; n != N; n++)
+				c[n] += a * b[n];
+		}
+	}
+}
+
+#ifdef FANN_SIMD_X86
+
+#define FANN_GEMM_NC 64
+#define FANN_GEMM_KC 256
+
+/* C[m][n] += a(m, k) * B[k][n] for the columns [n, N) that did not fill a vector */
+static void fann_gemm_acc_tail(const fann_type **a, unsigned int sak, unsigned int rows, unsigned int K,
+							   const fann_type *B, unsigned int ldb, unsigned int n, unsigned int N,
+							   fann_type *C, unsigned int ldc)
+{
+	fann_type *c, sum;
+	unsigned int i, j, k;
+
+	for(i = 0; i != rows; i++)
+	{
+		c = C + (size_t) i * ldc;
+		for(j = n; j != N; j++)
+		{
+			sum = c[j];
+			for(k = 0; k != K; k++)
+				sum += a[i][(size_t) k * sak] * B[(size_t) k * ldb + j];
+			c[j] = sum;
+		}
+	}
+}
+
+FANN_TARGET_SSE2 static void fann_gemm_acc_sse2(unsigned int M, unsigned int N, unsigned int K, const fann_type *A,
+												unsigned int sam, unsigned int sak, const fann_type *B, unsigned int ldb,
+												fann_type *C, unsigned int ldc)
+{
+	const fann_type *a[4], *b;
+	fann_type *c[4];
+	__m128 c0a, c0b, c1a, c1b, c2a, c2b, c3a, c3b, va, vb0, vb1;
+	unsigned int n0, n1, k0, k1, m, n, k, i, rows;
+
+	for(n0 = 0; n0 < N; n0 = n1)
+	{
+		n1 = fann_min(n0 + FANN_GEMM_NC, N);
+		for(k0 = 0; k0 < K; k0 = k1)
+		{
+			k1 = fann_min(k0 + FANN_GEMM_KC, K);
+			for(m = 0; m < M; m += 4)
+			{
+				rows = fann_min(M - m, 4);
+				for(i = 0; i != 4; i++)
+				{
+					a[i] = A + (size_t)(i < rows ? m + i : m) * sam + (size_t) k0 * sak;
+					c[i] = C + (size_t)(i < rows ? m + i : m) * ldc;
+				}
+
+				for(n = n0; n + 8 <= n1; n += 8)
+				{
+					c0a = _mm_loadu_ps(c[0] + n); c0b = _mm_loadu_ps(c[0] + n + 4);
+					c1a = _mm_loadu_ps(c[1] + n); c1b = _mm_loadu_ps(c[1] + n + 4);
+					c2a = _mm_loadu_ps(c[2] + n); c2b = _mm_loadu_ps(c[2] + n + 4);
+					c3a = _mm_loadu_ps(c[3] + n); c3b = _mm_loadu_ps(c[3] + n + 4);
+					for(k = 0; k != k1 - k0; k++)
+					{
+						b = B + (size_t)(k0 + k) * ldb + n;
+						vb0 = _mm_loadu_ps(b);
+						vb1 = _mm_loadu_ps(b + 4);
+						va = _mm_set1_ps(a[0][(size_t) k * sak]);
+						c0a = _mm_add_ps(c0a, _mm_mul_ps(va, vb0));
+						c0b = _mm_add_ps(c0b, _mm_mul_ps(va, vb1));
+						va = _mm_set1_ps(a[1][(size_t) k * sak]);
+						c1a = _mm_add_ps(c1a, _mm_mul_ps(va, vb0));
+						c1b = _mm_add_ps(c1b, _mm_mul_ps(va, vb1));
+						va = _mm_set1_ps(a[2][(size_t) k * sak]);
+						c2a = _mm_add_ps(c2a, _mm_mul_ps(va, vb0));
+						c2b = _mm_add_ps(c2b, _mm_mul_ps(va, vb1));
+						va = _mm_set1_ps(a[3][(size_t) k * sak]);
+						c3a = _mm_add_ps(c3a, _mm_mul_ps(va, vb0));
+						c3b = _mm_add_ps(c3b, _mm_mul_ps(va, vb1));
+					}
+
+					/* the duplicated rows are stored first, so the real ones win */
+					_mm_storeu_ps(c[3] + n, c3a); _mm_storeu_ps(c[3] + n + 4, c3b);
+					_mm_storeu_ps(c[2] + n, c2a); _mm_storeu_ps(c[2] + n + 4, c2b);
+					_mm_storeu_ps(c[1] + n, c1a); _mm_storeu_ps(c[1] + n + 4, c1b);
+					_mm_storeu_ps(c[0] + n, c0a); _mm_storeu_ps(c[0] + n + 4, c0b);
+				}
+
+				fann_gemm_acc_tail(a, sak, rows, k1 - k0, B + (size_t) k0 * ldb, ldb, n, n1,
+								   C + (size_t) m * ldc, ldc);
+			}
+		}
+	}
+}
+
+FANN_TARGET_AVX2 static void fann_gemm_acc_avx2(unsigned int M, unsigned int N, unsigned int K, const fann_type *A,
+												unsigned int sam, unsigned int sak, const fann_type *B, unsigned int ldb,
+												fann_type *C, unsigned int ldc)
+{
+	const fann_type *a[4], *b;
+	fann_type *c[4];
+	__m256 c0a, c0b, c1a, c1b, c2a, c2b, c3a, c3b, va, vb0, vb1;
+	unsigned int n0, n1, k0, k1, m, n, k, i, rows;
+
+	for(n0 = 0; n0 < N; n0 = n1)
+	{
+		n1 = fann_min(n0 + FANN_GEMM_NC, N);
+		for(k0 = 0; k0 < K; k0 = k1)
+		{
+			k1 = fann_min(k0 + FANN_GEMM_KC, K);
+			for(m = 0; m < M; m += 4)
+			{
+				rows = fann_min(M - m, 4);
+				for(i = 0; i != 4; i++)
+				{
+					a[i] = A + (size_t)(i < rows ? m + i : m) * sam + (size_t) k0 * sak;
+					c[i] = C + (size_t)(i < rows ? m + i : m) * ldc;
+				}
+
+				for(n = n0; n + 16 <= n1; n += 16)
+				{
+					c0a = _mm256_loadu_ps(c[0] + n); c0b = _mm256_loadu_ps(c[0] + n + 8);
+					c1a = _mm256_loadu_ps(c[1] + n); c1b = _mm256_loadu_ps(c[1] + n + 8);
+					c2a = _mm256_loadu_ps(c[2] + n); c2b = _mm256_loadu_ps(c[2] + n + 8);
+					c3a = _mm256_loadu_ps(c[3] + n); c3b = _mm256_loadu_ps(c[3] + n + 8);
+					for(k = 0; k != k1 - k0; k++)
+					{
+						b = B + (size_t)(k0 + k) * ldb + n;
+						vb0 = _mm256_loadu_ps(b);
+						vb1 = _mm256_loadu_ps(b + 8);
+						va = _mm256_set1_ps(a[0][(size_t) k * sak]);
+						c0a = _mm256_fmadd_ps(va, vb0, c0a);
+						c0b = _mm256_fmadd_ps(va, vb1, c0b);
+						va = _mm256_set1_ps(a[1][(size_t) k * sak]);
+						c1a = _mm256_fmadd_ps(va, vb0, c1a);
+						c1b = _mm256_fmadd_ps(va, vb1, c1b);
+						va = _mm256_set1_ps(a[2][(size_t) k * sak]);
+						c2a = _mm256_fmadd_ps(va, vb0, c2a);
+						c2b = _mm256_fmadd_ps(va, vb1, c2b);
+						va = _mm256_set1_ps(a[3][(size_t) k * sak]);
+						c3a = _mm256_fmadd_ps(va, vb0, c3a);
+						c3b = _mm256_fmadd_ps(va, vb1, c3b);
+					}
+
+					_mm256_storeu_ps(c[3] + n, c3a); _mm256_storeu_ps(c[3] + n + 8, c3b);
+					_mm256_storeu_ps(c[2] + n, c2a); _mm256_storeu_ps(c[2] + n + 8, c2b);
+					_mm256_storeu_ps(c[1] + n, c1a); _mm256_storeu_ps(c[1] + n + 8, c1b);
+					_mm256_storeu_ps(c[0] + n, c0a); _mm256_storeu_ps(c[0] + n + 8, c0b);
+				}
+
+				for(; n + 8 <= n1; n += 8)
+				{
+					c0a = _mm256_loadu_ps(c[0] + n);
+					c1a = _mm256_loadu_ps(c[1] + n);
+					c2a = _mm256_loadu_ps(c[2] + n);
+					c3a = _mm256_loadu_ps(c[3] + n);
+					for(k = 0; k != k1 - k0; k++)
+					{
+						vb0 = _mm256_loadu_ps(B + (size_t)(k0 + k) * ldb + n);
+						c0a = _mm256_fmadd_ps(_mm256_set1_ps(a[0][(size_t) k * sak]), vb0, c0a);
+						c1a = _mm256_fmadd_ps(_mm256_set1_ps(a[1][(size_t) k * sak]), vb0, c1a);
+						c2a = _mm256_fmadd_ps(_mm256_set1_ps(a[2][(size_t) k * sak]), vb0, c2a);
+						c3a = _mm256_fmadd_ps(_mm256_set1_ps(a[3][(size_t) k * sak]), vb0, c3a);
+					}
+
+					_mm256_storeu_ps(c[3] + n, c3a);
+					_mm256_storeu_ps(c[2] + n, c2a);
+					_mm256_storeu_ps(c[1] + n, c1a);
+					_mm256_storeu_ps(c[0] + n, c0a);
+				}
+
+				/* the tail is sse code, which stalls on a dirty upper half of the ymm registers */
+				_mm256_zeroupper();
+				fann_gemm_acc_tail(a, sak, rows, k1 - k0, B + (size_t) k0 * ldb, ldb, n, n1,
+								   C + (size_t) m * ldc, ldc);
+			}
+		}
+	}
+}
+
+#endif /* FANN_SIMD_X86 */
+
+static void fann_gemm_acc(unsigned int M, unsigned int N, unsigned int K, const fann_type *A,
+						  unsigned int sam, unsigned int sak, const fann_type *B, unsigned int ldb,
+						  fann_type *C, unsigned int ldc)
+{
+#ifdef FANN_SIMD_X86
+	enum fann_simd_level_enum level = fann_get_simd_level();
+
+	if(level == FANN_SIMD_AVX2)
+		fann_gemm_acc_avx2(M, N, K, A, sam, sak, B, ldb, C, ldc);
+	else if(level == FANN_SIMD_SSE2)
+		fann_gemm_acc_sse2(M, N, K, A, sam, sak, B, ldb, C, ldc);
+	else
+#endif
+		fann_gemm_acc_c(M, N, K, A, sam, sak, B, ldb, C, ldc);
+}
+
+/* INTERNAL FUNCTION
+   C[m][n] += sum_k A[m][k] * B[k][n], the errors of the sources from the errors of a layer.
+ */
+void fann_gemm_nn(unsigned int M, unsigned int N, unsigned int K, const fann_type *A, unsigned int lda,
+				  const fann_type *B, unsigned int ldb, fann_type *C, unsigned int ldc)
+{
+	fann_gemm_acc(M, N, K, A, lda, 1, B, ldb, C, ldc);
+}
+
+/* INTERNAL FUNCTION
+   C[m][n] += sum_k A[k][m] * B[k][n], the slopes of a layer from its errors and the source values.
+ */
+void fann_gemm_tn(unsigned int M, unsigned int N, unsigned int K, const fann_type *A, unsigned int lda,
+				  const fann_type *B, unsigned int ldb, fann_type *C, unsigned int ldc)
+{
+	fann_gemm_acc(M, N, K, A, 1, lda, B, ldb, C, ldc);
+}
+
+#endif /* FIXEDFANN */
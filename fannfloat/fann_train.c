@@ -601,6 +601,30 @@ void fann_clear_train_arrays(struct fann *ann)
 	}
 }
 
+/* INTERNAL FUNCTION
+   Update weights for mini-batch training, the mean slope of the mini-batch
+   plus momentum. Shares prev_weights_deltas with incremental training.
+ */
+void fann_update_weights_minibatch(struct fann *ann, unsigned int num_data, unsigned int first_weight,
+								   unsigned int past_end)
+{
+	fann_type *train_slopes = ann->train_slopes;
+	fann_type *weights = ann->weights;
+	fann_type *weights_deltas = ann->prev_weights_deltas;
+	const float epsilon = ann->learning_rate / num_data;
+	const float learning_momentum = ann->learning_momentum;
+	fann_type delta_w;
+	unsigned int i = first_weight;
+
+	for(; i != past_end; i++)
+	{
+		delta_w = train_slopes[i] * epsilon + learning_momentum * weights_deltas[i];
+		weights[i] += delta_w;
+		weights_deltas[i] = delta_w;
+		train_slopes[i] = 0.0;
+	}
+}
+
 /* INTERNAL FUNCTION
    Update weights for batch training
  */
@@ -1045,3 +1069,5 @@ FANN_GET_SET(float, sarprop_temperature)
 FANN_GET_SET(enum fann_stopfunc_enum, train_stop_function)
 FANN_GET_SET(fann_type, bit_fail_limit)
 FANN_GET_SET(float, learning_momentum)
+FANN_GET_SET(unsigned int, minibatch_size)
+FANN_GET_SET(int, minibatch_shuffle)
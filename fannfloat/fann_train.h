@@ -219,6 +219,9 @@ FANN_EXTERNAL float FANN_API fann_train_epoch(struct fann *ann, struct fann_trai
    Test a set of training data and calculates the MSE for the training data. 
    
    This function updates the MSE and the bit fail values.
+
+   Fully connected float networks are evaluated a block of patterns at a time with
+   matrix products instead of a <fann_run> per pattern.
    
    See also:
  	<fann_test>, <fann_get_MSE>, <fann_get_bit_fail>
@@ -830,6 +833,51 @@ FANN_EXTERNAL float FANN_API fann_get_learning_momentum(struct fann *ann);
 FANN_EXTERNAL void FANN_API fann_set_learning_momentum(struct fann *ann, float learning_momentum);
 
 
+/* Function: fann_get_minibatch_size
+
+   Get the number of patterns FANN_TRAIN_MINIBATCH presents to the network between two
+   weight updates. The last mini-batch of an epoch may be smaller. A size of 1 is the same
+   as incremental training, a size of the whole training set the same as batch training.
+
+   The default size is 32.
+
+   See also:
+   <fann_set_minibatch_size>, <fann_get_minibatch_shuffle>, <fann_set_training_algorithm>
+ */
+FANN_EXTERNAL unsigned int FANN_API fann_get_minibatch_size(struct fann *ann);
+
+
+/* Function: fann_set_minibatch_size
+
+   Set the number of patterns per weight update of FANN_TRAIN_MINIBATCH, 0 is used as 1.
+
+   More info available in <fann_get_minibatch_size>
+ */
+FANN_EXTERNAL void FANN_API fann_set_minibatch_size(struct fann *ann, unsigned int minibatch_size);
+
+
+/* Function: fann_get_minibatch_shuffle
+
+   Get whether FANN_TRAIN_MINIBATCH visits the training patterns in a new random order
+   every epoch (using rand), the training data itself is not modified.
+
+   The default is 1.
+
+   See also:
+   <fann_set_minibatch_shuffle>, <fann_get_minibatch_size>
+ */
+FANN_EXTERNAL int FANN_API fann_get_minibatch_shuffle(struct fann *ann);
+
+
+/* Function: fann_set_minibatch_shuffle
+
+   Set whether FANN_TRAIN_MINIBATCH shuffles the patterns every epoch.
+
+   More info available in <fann_get_minibatch_shuffle>
+ */
+FANN_EXTERNAL void FANN_API fann_set_minibatch_shuffle(struct fann *ann, int minibatch_shuffle);
+
+
 /* Function: fann_get_activation_function
 
    Get the activation function for neuron number *neuron* in layer number *layer*, 
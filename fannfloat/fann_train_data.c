@@ -89,6 +89,11 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_train_
 	
 	fann_reset_MSE(ann);
 
+#ifndef FIXEDFANN
+	if(fann_matrix_test(ann, data))
+		return fann_get_MSE(ann);
+#endif
+
 	for(i = 0; i != data->num_data; i++)
 	{
 		fann_test(ann, data->input[i], data->output[i]);
@@ -104,8 +109,6 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_train_
  */
 float fann_train_epoch_quickprop(struct fann *ann, struct fann_train_data *data)
 {
-	unsigned int i;
-
 	if(ann->prev_train_slopes == NULL)
 	{
 		fann_clear_train_arrays(ann);
@@ -113,13 +116,7 @@ float fann_train_epoch_quickprop(struct fann *ann, struct fann_train_data *data)
 
 	fann_reset_MSE(ann);
 
-	for(i = 0; i < data->num_data; i++)
-	{
-		fann_run(ann, data->input[i]);
-		fann_compute_MSE(ann, data->output[i]);
-		fann_backpropagate_MSE(ann);
-		fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
-	}
+	fann_matrix_slopes(ann, data, NULL, 0, data->num_data);
 	fann_update_weights_quickprop(ann, data->num_data, 0, ann->total_connections);
 
 	return fann_get_MSE(ann);
@@ -130,8 +127,6 @@ float fann_train_epoch_quickprop(struct fann *ann, struct fann_train_data *data)
  */
 float fann_train_epoch_irpropm(struct fann *ann, struct fann_train_data *data)
 {
-	unsigned int i;
-
 	if(ann->prev_train_slopes == NULL)
 	{
 		fann_clear_train_arrays(ann);
@@ -139,13 +134,7 @@ float fann_train_epoch_irpropm(struct fann *ann, struct fann_train_data *data)
 
 	fann_reset_MSE(ann);
 
-	for(i = 0; i < data->num_data; i++)
-	{
-		fann_run(ann, data->input[i]);
-		fann_compute_MSE(ann, data->output[i]);
-		fann_backpropagate_MSE(ann);
-		fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
-	}
+	fann_matrix_slopes(ann, data, NULL, 0, data->num_data);
 
 	fann_update_weights_irpropm(ann, 0, ann->total_connections);
 
@@ -157,8 +146,6 @@ float fann_train_epoch_irpropm(struct fann *ann, struct fann_train_data *data)
  */
 float fann_train_epoch_sarprop(struct fann *ann, struct fann_train_data *data)
 {
-	unsigned int i;
-
 	if(ann->prev_train_slopes == NULL)
 	{
 		fann_clear_train_arrays(ann);
@@ -166,13 +153,7 @@ float fann_train_epoch_sarprop(struct fann *ann, struct fann_train_data *data)
 
 	fann_reset_MSE(ann);
 
-	for(i = 0; i < data->num_data; i++)
-	{
-		fann_run(ann, data->input[i]);
-		fann_compute_MSE(ann, data->output[i]);
-		fann_backpropagate_MSE(ann);
-		fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
-	}
+	fann_matrix_slopes(ann, data, NULL, 0, data->num_data);
 
 	fann_update_weights_sarprop(ann, ann->sarprop_epoch, 0, ann->total_connections);
 
@@ -186,17 +167,9 @@ float fann_train_epoch_sarprop(struct fann *ann, struct fann_train_data *data)
  */
 float fann_train_epoch_batch(struct fann *ann, struct fann_train_data *data)
 {
-	unsigned int i;
-
 	fann_reset_MSE(ann);
 
-	for(i = 0; i < data->num_data; i++)
-	{
-		fann_run(ann, data->input[i]);
-		fann_compute_MSE(ann, data->output[i]);
-		fann_backpropagate_MSE(ann);
-		fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
-	}
+	fann_matrix_slopes(ann, data, NULL, 0, data->num_data);
 
 	fann_update_weights_batch(ann, data->num_data, 0, ann->total_connections);
 
@@ -240,6 +213,8 @@ FANN_EXTERNAL float FANN_API fann_train_epoch(struct fann *ann, struct fann_trai
 		return fann_train_epoch_batch(ann, data);
 	case FANN_TRAIN_INCREMENTAL:
 		return fann_train_epoch_incremental(ann, data);
+	case FANN_TRAIN_MINIBATCH:
+		return fann_train_epoch_minibatch(ann, data);
 	}
 	return 0;
 }
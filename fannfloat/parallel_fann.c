@@ -4,494 +4,465 @@
  */
 #ifndef DISABLE_PARALLEL_FANN
 #include <omp.h>
+#include <string.h>
 #include "parallel_fann.h"
 #include "config.h"
 #include "fann.h"
 
-FANN_EXTERNAL float FANN_API fann_train_epoch_batch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+/* weights summed and updated together by one thread, a multiple of the cache line */
+#define FANN_PARALLEL_CHUNK 1024
+#define FANN_PARALLEL_ALIGNMENT 64
+
+struct fann_parallel_trainer
 {
-	/*vector<struct fann *> ann_vect(threadnumb);*/
-	struct fann** ann_vect= (struct fann**) malloc(threadnumb * sizeof(struct fann*));
-	int i=0,j=0;
-	fann_reset_MSE(ann);
+	struct fann *ann;
+	unsigned int threadnumb;
+	/* one network per thread, replicas[0] is ann itself */
+	struct fann **replicas;
+	/* train_slopes of the other replicas, cache aligned and padded to whole chunks */
+	void *slopes_memory;
+	unsigned int slopes_stride;
+};
+
+static fann_type *fann_parallel_slopes(struct fann_parallel_trainer *trainer, unsigned int thread)
+{
+	return thread == 0 ? trainer->ann->train_slopes : trainer->replicas[thread]->train_slopes;
+}
 
-	//generate copies of the ann
-	omp_set_dynamic(0);
-	omp_set_num_threads(threadnumb);
-	#pragma omp parallel private(j)
+static void fann_parallel_destroy_replicas(struct fann_parallel_trainer *trainer)
+{
+	unsigned int i;
+	for(i = 1; i < trainer->threadnumb; i++)
 	{
-
-		#pragma omp for schedule(static)
-		for(i=0; i<(int)threadnumb; i++)
+		if(trainer->replicas[i] != NULL)
 		{
-			ann_vect[i]=fann_copy(ann);
+			/* the slopes belong to the trainer */
+			trainer->replicas[i]->train_slopes = NULL;
+			fann_destroy(trainer->replicas[i]);
+			trainer->replicas[i] = NULL;
 		}
+	}
+	fann_safe_free(trainer->slopes_memory);
+}
+
+static int fann_parallel_create_replicas(struct fann_parallel_trainer *trainer)
+{
+	unsigned int i;
+	fann_type *slopes;
+
+	trainer->replicas[0] = trainer->ann;
+	if(trainer->threadnumb == 1)
+		return 0;
 
-    //parallel computing of the updates
+	/* one block for all the buffers, no two threads ever write the same cache line */
+	trainer->slopes_stride = (trainer->ann->total_connections_allocated + FANN_PARALLEL_CHUNK - 1) / FANN_PARALLEL_CHUNK * FANN_PARALLEL_CHUNK;
+	trainer->slopes_memory = calloc((size_t) trainer->slopes_stride * (trainer->threadnumb - 1) * sizeof(fann_type) + FANN_PARALLEL_ALIGNMENT, 1);
+	if(trainer->slopes_memory == NULL)
+		return -1;
+	slopes = (fann_type *) (((size_t) trainer->slopes_memory + FANN_PARALLEL_ALIGNMENT - 1) & ~(size_t) (FANN_PARALLEL_ALIGNMENT - 1));
 
-        #pragma omp for schedule(static)
-		for(i = 0; i < (int)data->num_data; i++)
+	for(i = 1; i < trainer->threadnumb; i++)
+	{
+		trainer->replicas[i] = fann_copy(trainer->ann);
+		if(trainer->replicas[i] == NULL)
 		{
-			j=omp_get_thread_num();
-			fann_run(ann_vect[j], data->input[i]);
-			fann_compute_MSE(ann_vect[j], data->output[i]);
-			fann_backpropagate_MSE(ann_vect[j]);
-			fann_update_slopes_batch(ann_vect[j], ann_vect[j]->first_layer + 1, ann_vect[j]->last_layer - 1);
+			fann_parallel_destroy_replicas(trainer);
+			return -1;
 		}
+		fann_safe_free(trainer->replicas[i]->train_slopes);
+		trainer->replicas[i]->train_slopes = slopes + (size_t) trainer->slopes_stride * (i - 1);
 	}
+	return 0;
+}
+
+static int fann_parallel_replica_matches(struct fann *ann, struct fann *replica)
+{
+	return replica->total_connections == ann->total_connections &&
+		replica->total_connections_allocated == ann->total_connections_allocated &&
+		replica->total_neurons == ann->total_neurons &&
+		(replica->last_layer - replica->first_layer) == (ann->last_layer - ann->first_layer);
+}
 
-    //parallel update of the weights
+/* copies what the slopes depend on: the weights, the activations and the error function */
+static void fann_parallel_sync_replica(struct fann *ann, struct fann *replica)
+{
+	struct fann_neuron *neuron_it = ann->first_layer->first_neuron;
+	struct fann_neuron *last_neuron = (ann->last_layer - 1)->last_neuron;
+	struct fann_neuron *replica_it = replica->first_layer->first_neuron;
+
+	memcpy(replica->weights, ann->weights, ann->total_connections * sizeof(fann_type));
+	for(; neuron_it != last_neuron; neuron_it++, replica_it++)
 	{
-		const unsigned int num_data=data->num_data;
-		const unsigned int first_weight=0;
-		const unsigned int past_end=ann->total_connections;
-		fann_type *weights = ann->weights;
-		const fann_type epsilon = ann->learning_rate / num_data;
-		omp_set_dynamic(0);
-		omp_set_num_threads(threadnumb);
-		#pragma omp parallel
-		{
-			#pragma omp for schedule(static)
-				for(i=first_weight; i < (int)past_end; i++)
-				{
-					fann_type temp_slopes=0.0;
-					unsigned int k;
-					fann_type *train_slopes;
-					for(k=0;k<threadnumb;++k)
-					{
-						train_slopes=ann_vect[k]->train_slopes;
-						temp_slopes+= train_slopes[i];
-						train_slopes[i]=0.0;
-					}
-					weights[i] += temp_slopes*epsilon;
-				}
-			}
+		replica_it->activation_function = neuron_it->activation_function;
+		replica_it->activation_steepness = neuron_it->activation_steepness;
 	}
-	//merge of MSEs
-	for(i=0;i<(int)threadnumb;++i)
+
+	replica->train_error_function = ann->train_error_function;
+	replica->bit_fail_limit = ann->bit_fail_limit;
+	fann_reset_MSE(replica);
+}
+
+/* adds the slopes of one thread to the ones of another and clears them */
+static void fann_parallel_add_slopes(fann_type *slopes, fann_type *other_slopes, unsigned int first_weight, unsigned int past_end)
+{
+	unsigned int i;
+	for(i = first_weight; i != past_end; i++)
 	{
-		ann->MSE_value+= ann_vect[i]->MSE_value;
-		ann->num_MSE+=ann_vect[i]->num_MSE;
-		fann_destroy(ann_vect[i]);
+		slopes[i] += other_slopes[i];
+		other_slopes[i] = 0.0;
 	}
-	free(ann_vect);
-	return fann_get_MSE(ann);
 }
 
-
-FANN_EXTERNAL float FANN_API fann_train_epoch_irpropm_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+/* brings the replicas up to date with ann before an epoch */
+static int fann_parallel_prepare(struct fann_parallel_trainer *trainer)
 {
-	struct fann** ann_vect= (struct fann**) malloc(threadnumb * sizeof(struct fann*));
-	int i=0,j=0;
+	struct fann *ann = trainer->ann;
+	unsigned int k;
 
-	if(ann->prev_train_slopes == NULL)
+	/* the network may have been rebuilt since the replicas were made,
+	 * or a rebuild failed the epoch before and left no replicas */
+	for(k = 1; k < trainer->threadnumb; k++)
 	{
-		fann_clear_train_arrays(ann);
+		if(trainer->replicas[k] == NULL || !fann_parallel_replica_matches(ann, trainer->replicas[k]))
+		{
+			fann_parallel_destroy_replicas(trainer);
+			if(fann_parallel_create_replicas(trainer) != 0)
+			{
+				fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+				return -1;
+			}
+			break;
+		}
+	}
+
+	if(ann->train_slopes == NULL)
+	{
+		ann->train_slopes = (fann_type *) calloc(ann->total_connections_allocated, sizeof(fann_type));
+		if(ann->train_slopes == NULL)
+		{
+			fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+			return -1;
+		}
 	}
 
-	//#define THREADNUM 1
 	fann_reset_MSE(ann);
+	for(k = 1; k < trainer->threadnumb; k++)
+	{
+		fann_parallel_sync_replica(ann, trainer->replicas[k]);
+	}
+	return 0;
+}
 
-	/*vector<struct fann *> ann_vect(threadnumb);*/
+/* Called by every thread of the parallel region. Tree reduction of the slopes into
+ * the ones of ann, each level halves the buffers and splits the pairs to add in
+ * chunks so every thread has work on wide networks.
+ */
+static void fann_parallel_reduce_slopes(struct fann_parallel_trainer *trainer, int num_chunks)
+{
+	const unsigned int threadnumb = trainer->threadnumb;
+	const unsigned int total_connections = trainer->ann->total_connections;
+	unsigned int step;
+	int i;
 
-	//generate copies of the ann
-	omp_set_dynamic(0);
-	omp_set_num_threads(threadnumb);
-	#pragma omp parallel private(j)
+	for(step = 1; step < threadnumb; step <<= 1)
 	{
+		const int num_pairs = (int)((threadnumb + step - 1) / (2 * step));
 
 		#pragma omp for schedule(static)
-		for(i=0; i<(int)threadnumb; i++)
+		for(i = 0; i < num_pairs * num_chunks; i++)
 		{
-			ann_vect[i]=fann_copy(ann);
+			const unsigned int thread = (unsigned int)(i / num_chunks) * 2 * step;
+			const unsigned int first_weight = (unsigned int)(i % num_chunks) * FANN_PARALLEL_CHUNK;
+			const unsigned int past_end = fann_min(first_weight + FANN_PARALLEL_CHUNK, total_connections);
+
+			fann_parallel_add_slopes(fann_parallel_slopes(trainer, thread), fann_parallel_slopes(trainer, thread + step), first_weight, past_end);
 		}
+	}
+}
 
-    //parallel computing of the updates
+/* the merged MSE of the replicas */
+static void fann_parallel_merge_MSE(struct fann_parallel_trainer *trainer)
+{
+	struct fann *ann = trainer->ann;
+	unsigned int k;
 
+	for(k = 1; k < trainer->threadnumb; k++)
+	{
+		ann->MSE_value += trainer->replicas[k]->MSE_value;
+		ann->num_MSE += trainer->replicas[k]->num_MSE;
+		ann->num_bit_fail += trainer->replicas[k]->num_bit_fail;
+	}
+}
 
-        #pragma omp for schedule(static)
-		for(i = 0; i < (int)data->num_data; i++)
+/* slopes of patterns [begin, end) one at a time, keeping the output of each pattern in outputs */
+static void fann_parallel_slopes_outputs(struct fann *replica, struct fann_train_data *data, unsigned int begin, unsigned int end, fann_type *outputs)
+{
+	unsigned int i;
+	for(i = begin; i != end; i++)
+	{
+		memcpy(outputs + (size_t) i * data->num_output, fann_run(replica, data->input[i]), data->num_output * sizeof(fann_type));
+		fann_compute_MSE(replica, data->output[i]);
+		fann_backpropagate_MSE(replica);
+		fann_update_slopes_batch(replica, replica->first_layer + 1, replica->last_layer - 1);
+	}
+}
+
+/* mini-batches one after the other, the patterns of each one split between the replicas */
+static float fann_parallel_train_epoch_minibatch(struct fann_parallel_trainer *trainer, struct fann_train_data *data)
+{
+	struct fann *ann = trainer->ann;
+	const unsigned int threadnumb = trainer->threadnumb;
+	const unsigned int batch_size = fann_max(ann->minibatch_size, 1);
+	const int num_chunks = (int)((ann->total_connections + FANN_PARALLEL_CHUNK - 1) / FANN_PARALLEL_CHUNK);
+	const unsigned int *order;
+
+	if(ann->prev_weights_deltas == NULL)
+	{
+		ann->prev_weights_deltas = (fann_type *) calloc(ann->total_connections_allocated, sizeof(fann_type));
+		if(ann->prev_weights_deltas == NULL)
 		{
-			j=omp_get_thread_num();
-			fann_run(ann_vect[j], data->input[i]);
-			fann_compute_MSE(ann_vect[j], data->output[i]);
-			fann_backpropagate_MSE(ann_vect[j]);
-			fann_update_slopes_batch(ann_vect[j], ann_vect[j]->first_layer + 1, ann_vect[j]->last_layer - 1);
+			fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+			return fann_get_MSE(ann);
 		}
 	}
 
+	if(fann_parallel_prepare(trainer) != 0 || data->num_data == 0)
 	{
-    	fann_type *weights = ann->weights;
-    	fann_type *prev_steps = ann->prev_steps;
-    	fann_type *prev_train_slopes = ann->prev_train_slopes;
-
-    	fann_type next_step;
-
-    	const float increase_factor = ann->rprop_increase_factor;	//1.2;
-    	const float decrease_factor = ann->rprop_decrease_factor;	//0.5;
-    	const float delta_min = ann->rprop_delta_min;	//0.0;
-    	const float delta_max = ann->rprop_delta_max;	//50.0;
-		const unsigned int first_weight=0;
-		const unsigned int past_end=ann->total_connections;
-
-		omp_set_dynamic(0);
-		omp_set_num_threads(threadnumb);
-		#pragma omp parallel private(next_step)
+		return fann_get_MSE(ann);
+	}
+
+	order = fann_minibatch_order(ann, data->num_data);
+	if(order == NULL)
+	{
+		return fann_get_MSE(ann);
+	}
+
+	#pragma omp parallel num_threads(threadnumb)
+	{
+		unsigned int first, num_rows;
+		int i;
+
+		for(first = 0; first != data->num_data; first += num_rows)
 		{
+			num_rows = fann_min(data->num_data - first, batch_size);
+
 			#pragma omp for schedule(static)
-				for(i=first_weight; i < (int)past_end; i++)
+			for(i = 0; i < (int)threadnumb; i++)
+			{
+				const unsigned int begin = num_rows * i / threadnumb;
+				const unsigned int end = num_rows * (i + 1) / threadnumb;
+				if(begin != end)
 				{
-					fann_type prev_slope, same_sign;
-		    		const fann_type prev_step = fann_max(prev_steps[i], (fann_type) 0.0001);	// prev_step may not be zero because then the training will stop
-
-		    		fann_type temp_slopes=0.0;
-					unsigned int k;
-					fann_type *train_slopes;
-					for(k=0;k<threadnumb;++k)
-					{
-						train_slopes=ann_vect[k]->train_slopes;
-						temp_slopes+= train_slopes[i];
-						train_slopes[i]=0.0;
-					}
-
-		    		prev_slope = prev_train_slopes[i];
-
-		    		same_sign = prev_slope * temp_slopes;
-
-		    		if(same_sign >= 0.0)
-		    			next_step = fann_min(prev_step * increase_factor, delta_max);
-		    		else
-		    		{
-		    			next_step = fann_max(prev_step * decrease_factor, delta_min);
-		    			temp_slopes = 0;
-		    		}
-
-		    		if(temp_slopes < 0)
-		    		{
-		    			weights[i] -= next_step;
-		    			if(weights[i] < -1500)
-		    				weights[i] = -1500;
-		    		}
-		    		else
-		    		{
-		    			weights[i] += next_step;
-		    			if(weights[i] > 1500)
-		    				weights[i] = 1500;
-		    		}
-
-		    		// update global data arrays
-		    		prev_steps[i] = next_step;
-		    		prev_train_slopes[i] = temp_slopes;
-
+					fann_matrix_slopes(trainer->replicas[i], data, order + first + begin, 0, end - begin);
 				}
 			}
-	}
 
-	//merge of MSEs
-	for(i=0;i<(int)threadnumb;++i)
-	{
-		ann->MSE_value+= ann_vect[i]->MSE_value;
-		ann->num_MSE+=ann_vect[i]->num_MSE;
-		fann_destroy(ann_vect[i]);
+			fann_parallel_reduce_slopes(trainer, num_chunks);
+
+			#pragma omp for schedule(static)
+			for(i = 0; i < num_chunks; i++)
+			{
+				const unsigned int first_weight = (unsigned int)i * FANN_PARALLEL_CHUNK;
+				const unsigned int past_end = fann_min(first_weight + FANN_PARALLEL_CHUNK, ann->total_connections);
+
+				fann_update_weights_minibatch(ann, num_rows, first_weight, past_end);
+			}
+
+			//the next mini-batch starts from the new weights
+			#pragma omp for schedule(static)
+			for(i = 1; i < (int)threadnumb; i++)
+			{
+				memcpy(trainer->replicas[i]->weights, ann->weights, ann->total_connections * sizeof(fann_type));
+			}
+		}
 	}
-	free(ann_vect);
+
+	fann_parallel_merge_MSE(trainer);
 	return fann_get_MSE(ann);
 }
 
-
-FANN_EXTERNAL float FANN_API fann_train_epoch_quickprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+/* outputs, if not NULL, receives the output of every pattern before the update (batch algorithms only) */
+static float fann_parallel_train_epoch(struct fann_parallel_trainer *trainer, struct fann_train_data *data, enum fann_train_enum algorithm, fann_type *outputs)
 {
-	struct fann** ann_vect= (struct fann**) malloc(threadnumb * sizeof(struct fann*));
-	int i=0,j=0;
+	struct fann *ann = trainer->ann;
+	const unsigned int threadnumb = trainer->threadnumb;
+	const int num_chunks = (int)((ann->total_connections + FANN_PARALLEL_CHUNK - 1) / FANN_PARALLEL_CHUNK);
 
-	if(ann->prev_train_slopes == NULL)
+	/* one sample at a time, nothing to split */
+	if(algorithm == FANN_TRAIN_INCREMENTAL)
 	{
-		fann_clear_train_arrays(ann);
+		return fann_train_epoch_incremental_mod(ann, data);
+	}
+	if(algorithm == FANN_TRAIN_MINIBATCH)
+	{
+		return fann_parallel_train_epoch_minibatch(trainer, data);
 	}
 
-	//#define THREADNUM 1
-	fann_reset_MSE(ann);
-
-	/*vector<struct fann *> ann_vect(threadnumb);*/
+	if(algorithm != FANN_TRAIN_BATCH && ann->prev_train_slopes == NULL)
+	{
+		fann_clear_train_arrays(ann);
+	}
+	if(fann_parallel_prepare(trainer) != 0)
+	{
+		return fann_get_MSE(ann);
+	}
 
-	//generate copies of the ann
-	omp_set_dynamic(0);
-	omp_set_num_threads(threadnumb);
-	#pragma omp parallel private(j)
+	/* a single parallel region per epoch, the threads of the omp pool stay alive in between */
+	#pragma omp parallel num_threads(threadnumb)
 	{
+		int i;
 
+		//each replica evaluates a contiguous slice of the patterns, in matrix form unless the outputs are kept
 		#pragma omp for schedule(static)
-		for(i=0; i<(int)threadnumb; i++)
+		for(i = 0; i < (int)threadnumb; i++)
 		{
-			ann_vect[i]=fann_copy(ann);
+			const unsigned int begin = (unsigned int)((unsigned long long) data->num_data * i / threadnumb);
+			const unsigned int end = (unsigned int)((unsigned long long) data->num_data * (i + 1) / threadnumb);
+			if(outputs != NULL)
+			{
+				fann_parallel_slopes_outputs(trainer->replicas[i], data, begin, end, outputs);
+			}
+			else if(begin != end)
+			{
+				fann_matrix_slopes(trainer->replicas[i], data, NULL, begin, end - begin);
+			}
 		}
 
-    //parallel computing of the updates
-
-        #pragma omp for schedule(static)
-		for(i = 0; i < (int)data->num_data; i++)
+		//merge of MSEs, sarprop steps depend on the error of the whole epoch
+		#pragma omp single
 		{
-			j=omp_get_thread_num();
-			fann_run(ann_vect[j], data->input[i]);
-			fann_compute_MSE(ann_vect[j], data->output[i]);
-			fann_backpropagate_MSE(ann_vect[j]);
-			fann_update_slopes_batch(ann_vect[j], ann_vect[j]->first_layer + 1, ann_vect[j]->last_layer - 1);
+			fann_parallel_merge_MSE(trainer);
 		}
-	}
-
-    {
-    	fann_type *weights = ann->weights;
-    	fann_type *prev_steps = ann->prev_steps;
-    	fann_type *prev_train_slopes = ann->prev_train_slopes;
-		const unsigned int first_weight=0;
-		const unsigned int past_end=ann->total_connections;
-
-    	fann_type w=0.0, next_step;
 
-    	const float epsilon = ann->learning_rate / data->num_data;
-    	const float decay = ann->quickprop_decay;	/*-0.0001;*/
-    	const float mu = ann->quickprop_mu;	/*1.75; */
-    	const float shrink_factor = (float) (mu / (1.0 + mu));
+		fann_parallel_reduce_slopes(trainer, num_chunks);
 
-		omp_set_dynamic(0);
-		omp_set_num_threads(threadnumb);
-		#pragma omp parallel private(w, next_step)
+		//parallel update of the weights, with the serial update of each algorithm
+		#pragma omp for schedule(static)
+		for(i = 0; i < num_chunks; i++)
 		{
-			#pragma omp for schedule(static)
-				for(i=first_weight; i < (int)past_end; i++)
-				{
-					fann_type temp_slopes=0.0;
-					unsigned int k;
-					fann_type *train_slopes;
-					fann_type prev_step, prev_slope;
-
-					w = weights[i];
-					for(k=0;k<threadnumb;++k)
-					{
-						train_slopes=ann_vect[k]->train_slopes;
-						temp_slopes+= train_slopes[i];
-						train_slopes[i]=0.0;
-					}
-					temp_slopes+= decay * w;
-
-					prev_step = prev_steps[i];
-					prev_slope = prev_train_slopes[i];
-
-					next_step = 0.0;
-
-
-					/* The step must always be in direction opposite to the slope. */
-					if(prev_step > 0.001)
-					{
-						/* If last step was positive...  */
-						if(temp_slopes > 0.0) /*  Add in linear term if current slope is still positive. */
-							next_step += epsilon * temp_slopes;
-
-						/*If current slope is close to or larger than prev slope...  */
-						if(temp_slopes > (shrink_factor * prev_slope))
-							next_step += mu * prev_step;	/* Take maximum size negative step. */
-						else
-							next_step += prev_step * temp_slopes / (prev_slope - temp_slopes);	/* Else, use quadratic estimate. */
-					}
-					else if(prev_step < -0.001)
-					{
-						/* If last step was negative...  */
-						if(temp_slopes < 0.0) /*  Add in linear term if current slope is still negative. */
-							next_step += epsilon * temp_slopes;
-
-						/* If current slope is close to or more neg than prev slope... */
-						if(temp_slopes < (shrink_factor * prev_slope))
-							next_step += mu * prev_step;	/* Take maximum size negative step. */
-						else
-							next_step += prev_step * temp_slopes / (prev_slope - temp_slopes);	/* Else, use quadratic estimate. */
-					}
-					else /* Last step was zero, so use only linear term. */
-						next_step += epsilon * temp_slopes;
-
-					/* update global data arrays */
-					prev_steps[i] = next_step;
-					prev_train_slopes[i] = temp_slopes;
-
-					w += next_step;
-
-					if(w > 1500)
-						weights[i] = 1500;
-					else if(w < -1500)
-						weights[i] = -1500;
-					else
-						weights[i] = w;
-				}
+			const unsigned int first_weight = (unsigned int)i * FANN_PARALLEL_CHUNK;
+			const unsigned int past_end = fann_min(first_weight + FANN_PARALLEL_CHUNK, ann->total_connections);
+
+			switch(algorithm)
+			{
+			case FANN_TRAIN_BATCH:
+				fann_update_weights_batch(ann, data->num_data, first_weight, past_end);
+				break;
+			case FANN_TRAIN_RPROP:
+				fann_update_weights_irpropm(ann, first_weight, past_end);
+				break;
+			case FANN_TRAIN_QUICKPROP:
+				fann_update_weights_quickprop(ann, data->num_data, first_weight, past_end);
+				break;
+			case FANN_TRAIN_SARPROP:
+				fann_update_weights_sarprop(ann, ann->sarprop_epoch, first_weight, past_end);
+				break;
+			default:
+				break;
+			}
 		}
 	}
-	//merge of MSEs
-	for(i=0;i<(int)threadnumb;++i)
+
+	if(algorithm == FANN_TRAIN_SARPROP)
 	{
-		ann->MSE_value+= ann_vect[i]->MSE_value;
-		ann->num_MSE+=ann_vect[i]->num_MSE;
-		fann_destroy(ann_vect[i]);
+		++(ann->sarprop_epoch);
 	}
-	free(ann_vect);
+
 	return fann_get_MSE(ann);
 }
 
+/* the epoch functions below keep no state, every call builds and drops its replicas */
+static float fann_parallel_train_epoch_once(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb, enum fann_train_enum algorithm, fann_type *outputs)
+{
+	float MSE;
+	struct fann_parallel_trainer *trainer = fann_create_parallel_trainer(ann, threadnumb);
+	if(trainer == NULL)
+	{
+		return fann_get_MSE(ann);
+	}
 
-FANN_EXTERNAL float FANN_API fann_train_epoch_sarprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+	MSE = fann_parallel_train_epoch(trainer, data, algorithm, outputs);
+	fann_destroy_parallel_trainer(trainer);
+	return MSE;
+}
+
+FANN_EXTERNAL struct fann_parallel_trainer * FANN_API fann_create_parallel_trainer(struct fann *ann, unsigned int threadnumb)
 {
-	struct fann** ann_vect= (struct fann**) malloc(threadnumb * sizeof(struct fann*));
-	int i=0,j=0;
+	struct fann_parallel_trainer *trainer = (struct fann_parallel_trainer *) malloc(sizeof(struct fann_parallel_trainer));
+	if(trainer == NULL)
+	{
+		fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+		return NULL;
+	}
 
-	if(ann->prev_train_slopes == NULL)
+	trainer->ann = ann;
+	trainer->threadnumb = threadnumb > 0 ? threadnumb : (unsigned int) omp_get_max_threads();
+	trainer->replicas = (struct fann **) calloc(trainer->threadnumb, sizeof(struct fann *));
+	trainer->slopes_memory = NULL;
+	trainer->slopes_stride = 0;
+	if(trainer->replicas == NULL || fann_parallel_create_replicas(trainer) != 0)
 	{
-		fann_clear_train_arrays(ann);
+		fann_error((struct fann_error *) ann, FANN_E_CANT_ALLOCATE_MEM);
+		free(trainer->replicas);
+		free(trainer);
+		return NULL;
 	}
+	return trainer;
+}
 
-	//#define THREADNUM 1
-	fann_reset_MSE(ann);
+FANN_EXTERNAL void FANN_API fann_destroy_parallel_trainer(struct fann_parallel_trainer *trainer)
+{
+	if(trainer == NULL)
+		return;
 
-	/*vector<struct fann *> ann_vect(threadnumb);*/
+	fann_parallel_destroy_replicas(trainer);
+	free(trainer->replicas);
+	free(trainer);
+}
 
-	//generate copies of the ann
-	omp_set_dynamic(0);
-	omp_set_num_threads(threadnumb);
-	#pragma omp parallel private(j)
-	{
+FANN_EXTERNAL float FANN_API fann_train_epoch_parallel(struct fann_parallel_trainer *trainer, struct fann_train_data *data)
+{
+	return fann_parallel_train_epoch(trainer, data, trainer->ann->training_algorithm, NULL);
+}
 
-		#pragma omp for schedule(static)
-		for(i=0; i<(int)threadnumb; i++)
-		{
-			ann_vect[i]=fann_copy(ann);
-		}
+FANN_EXTERNAL unsigned int FANN_API fann_get_parallel_trainer_threads(struct fann_parallel_trainer *trainer)
+{
+	return trainer->threadnumb;
+}
 
-    //parallel computing of the updates
+FANN_EXTERNAL float FANN_API fann_train_epoch_batch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+{
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, FANN_TRAIN_BATCH, NULL);
+}
 
-        #pragma omp for schedule(static)
-		for(i = 0; i < (int)data->num_data; i++)
-		{
-			j=omp_get_thread_num();
-			fann_run(ann_vect[j], data->input[i]);
-			fann_compute_MSE(ann_vect[j], data->output[i]);
-			fann_backpropagate_MSE(ann_vect[j]);
-			fann_update_slopes_batch(ann_vect[j], ann_vect[j]->first_layer + 1, ann_vect[j]->last_layer - 1);
-		}
-	}
+FANN_EXTERNAL float FANN_API fann_train_epoch_irpropm_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+{
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, FANN_TRAIN_RPROP, NULL);
+}
 
-    {
-    	fann_type *weights = ann->weights;
-    	fann_type *prev_steps = ann->prev_steps;
-    	fann_type *prev_train_slopes = ann->prev_train_slopes;
-		const unsigned int first_weight=0;
-		const unsigned int past_end=ann->total_connections;
-		const unsigned int epoch=ann->sarprop_epoch;
-
-    	fann_type next_step;
-
-    	/* These should be set from variables */
-    	const float increase_factor = ann->rprop_increase_factor;	/*1.2; */
-    	const float decrease_factor = ann->rprop_decrease_factor;	/*0.5; */
-    	/* TODO: why is delta_min 0.0 in iRprop? SARPROP uses 1x10^-6 (Braun and Riedmiller, 1993) */
-    	const float delta_min = 0.000001f;
-    	const float delta_max = ann->rprop_delta_max;	/*50.0; */
-    	const float weight_decay_shift = ann->sarprop_weight_decay_shift; /* ld 0.01 = -6.644 */
-    	const float step_error_threshold_factor = ann->sarprop_step_error_threshold_factor; /* 0.1 */
-    	const float step_error_shift = ann->sarprop_step_error_shift; /* ld 3 = 1.585 */
-    	const float T = ann->sarprop_temperature;
-		float MSE, RMSE;
-
-
-    	//merge of MSEs
-    	for(i=0;i<(int)threadnumb;++i)
-    	{
-    		ann->MSE_value+= ann_vect[i]->MSE_value;
-    		ann->num_MSE+=ann_vect[i]->num_MSE;
-    	}
-
-    	MSE = fann_get_MSE(ann);
-    	RMSE = sqrtf(MSE);
-
-    	/* for all weights; TODO: are biases included? */
-		omp_set_dynamic(0);
-		omp_set_num_threads(threadnumb);
-		#pragma omp parallel private(next_step)
-		{
-			#pragma omp for schedule(static)
-				for(i=first_weight; i < (int)past_end; i++)
-				{
-					/* TODO: confirm whether 1x10^-6 == delta_min is really better */
-					const fann_type prev_step  = fann_max(prev_steps[i], (fann_type) 0.000001);	/* prev_step may not be zero because then the training will stop */
-
-					/* calculate SARPROP slope; TODO: better as new error function? (see SARPROP paper)*/
-					fann_type prev_slope, same_sign;
-					fann_type temp_slopes=0.0;
-					unsigned int k;
-					fann_type *train_slopes;
-					for(k=0;k<threadnumb;++k)
-					{
-						train_slopes=ann_vect[k]->train_slopes;
-						temp_slopes+= train_slopes[i];
-						train_slopes[i]=0.0;
-					}
-					temp_slopes= -temp_slopes - weights[i] * (fann_type)fann_exp2(-T * epoch + weight_decay_shift);
-
-					next_step=0.0;
-
-					/* TODO: is prev_train_slopes[i] 0.0 in the beginning? */
-					prev_slope = prev_train_slopes[i];
-
-					same_sign = prev_slope * temp_slopes;
-
-					if(same_sign > 0.0)
-					{
-						next_step = fann_min(prev_step * increase_factor, delta_max);
-						/* TODO: are the signs inverted? see differences between SARPROP paper and iRprop */
-						if (temp_slopes < 0.0)
-							weights[i] += next_step;
-						else
-							weights[i] -= next_step;
-					}
-					else if(same_sign < 0.0)
-					{
-						#ifndef RAND_MAX
-						#define	RAND_MAX	0x7fffffff
-						#endif
-						if(prev_step < step_error_threshold_factor * MSE)
-							next_step = prev_step * decrease_factor + (float)rand() / RAND_MAX * RMSE * (fann_type)fann_exp2(-T * epoch + step_error_shift);
-						else
-							next_step = fann_max(prev_step * decrease_factor, delta_min);
-
-						temp_slopes = 0.0;
-					}
-					else
-					{
-						if(temp_slopes < 0.0)
-							weights[i] += prev_step;
-						else
-							weights[i] -= prev_step;
-					}
-
-					/* update global data arrays */
-					prev_steps[i] = next_step;
-					prev_train_slopes[i] = temp_slopes;
+FANN_EXTERNAL float FANN_API fann_train_epoch_quickprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+{
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, FANN_TRAIN_QUICKPROP, NULL);
+}
 
-				}
-		}
-    }
+FANN_EXTERNAL float FANN_API fann_train_epoch_sarprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+{
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, FANN_TRAIN_SARPROP, NULL);
+}
 
-	++(ann->sarprop_epoch);
+FANN_EXTERNAL float FANN_API fann_train_epoch_minibatch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb)
+{
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, FANN_TRAIN_MINIBATCH, NULL);
+}
 
-	//already computed before
-	/*//merge of MSEs
-	for(i=0;i<threadnumb;++i)
-	{
-		ann->MSE_value+= ann_vect[i]->MSE_value;
-		ann->num_MSE+=ann_vect[i]->num_MSE;
-	}*/
-	//destroy the copies of the ann
-	for(i=0; i<(int)threadnumb; i++)
+FANN_EXTERNAL float FANN_API fann_train_epoch_outputs_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb, enum fann_train_enum algorithm, fann_type *outputs)
+{
+	if(algorithm == FANN_TRAIN_INCREMENTAL || algorithm == FANN_TRAIN_MINIBATCH)
 	{
-		fann_destroy(ann_vect[i]);
+		fann_error((struct fann_error *) ann, FANN_E_CANT_USE_TRAIN_ALG);
+		return fann_get_MSE(ann);
 	}
-	free(ann_vect);
-	return fann_get_MSE(ann);
+	return fann_parallel_train_epoch_once(ann, data, threadnumb, algorithm, outputs);
 }
 
 FANN_EXTERNAL float FANN_API fann_train_epoch_incremental_mod(struct fann *ann, struct fann_train_data *data)
@@ -9,6 +9,8 @@
 
 #include "fann.h"
 
+struct fann_parallel_trainer;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -27,9 +29,27 @@ FANN_EXTERNAL float FANN_API fann_train_epoch_quickprop_parallel(struct fann *an
 
 FANN_EXTERNAL float FANN_API fann_train_epoch_sarprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb);
 
+FANN_EXTERNAL float FANN_API fann_train_epoch_minibatch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb);
+
 FANN_EXTERNAL float FANN_API fann_train_epoch_incremental_mod(struct fann *ann, struct fann_train_data *data);
 
+/* one epoch of a batch algorithm (batch, irpropm, quickprop or sarprop) that also stores the output of every
+   pattern before the update in outputs, num_data * num_output values. slower than the epochs above, the
+   patterns are evaluated one at a time */
+FANN_EXTERNAL float FANN_API fann_train_epoch_outputs_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb, enum fann_train_enum algorithm, fann_type *outputs);
+
 FANN_EXTERNAL float FANN_API fann_test_data_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb);
+
+/* keeps one replica of ann per thread alive between epochs, threadnumb 0 uses every omp thread.
+   ann must outlive the trainer */
+FANN_EXTERNAL struct fann_parallel_trainer * FANN_API fann_create_parallel_trainer(struct fann *ann, unsigned int threadnumb);
+
+/* one epoch with the training algorithm of ann, only the weights are copied to the replicas */
+FANN_EXTERNAL float FANN_API fann_train_epoch_parallel(struct fann_parallel_trainer *trainer, struct fann_train_data *data);
+
+FANN_EXTERNAL unsigned int FANN_API fann_get_parallel_trainer_threads(struct fann_parallel_trainer *trainer);
+
+FANN_EXTERNAL void FANN_API fann_destroy_parallel_trainer(struct fann_parallel_trainer *trainer);
 #endif /* FIXEDFANN */
 
 #ifdef __cplusplus
@@ -19,6 +19,8 @@ float train_epoch_quickprop_parallel(struct fann *ann, struct fann_train_data *d
 
 float train_epoch_sarprop_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb);
 
+float train_epoch_minibatch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb);
+
 float train_epoch_incremental_mod(struct fann *ann, struct fann_train_data *data);
 
 float train_epoch_batch_parallel(struct fann *ann, struct fann_train_data *data, const unsigned int threadnumb,std::vector< std::vector<fann_type> >& predicted_outputs);